@@ -1,4 +1,5 @@
 #include "BatteryControl.h"
+#include "ScaleControl.h"
 #include <Arduino.h>
 
 // EMA-сглаженное значение ADC батареи (0..1023)
@@ -17,6 +18,7 @@ static unsigned long lastBatRead = 0;
 // До этого момента Battery_IsCritical() всегда возвращает false (защита от ложного срабатывания при старте)
 static unsigned long graceUntil = 0;
 
+#if BAT_PROFILE_LIPO
 // Перевод напряжения LiPo в проценты по кусочно-линейной кривой разряда
 static int lipoPercent(float voltage) {
   if (voltage >= 4.15f) return 100;
@@ -28,7 +30,9 @@ static int lipoPercent(float voltage) {
   if (voltage >= 3.20f) return (int)((voltage - 3.20f) / (3.40f - 3.20f) * 5 + 0.5f);
   return 0;
 }
+#endif
 
+#if !BAT_PROFILE_LIPO
 // Линейный перевод напряжения в проценты (запасной вариант, если BAT_PROFILE_LIPO=0)
 static int linearPercent(float voltage) {
   if (voltage <= BAT_LINEAR_EMPTY_V) return 0;
@@ -36,6 +40,7 @@ static int linearPercent(float voltage) {
   return (int)(((voltage - BAT_LINEAR_EMPTY_V) * 100.0f) /
                (BAT_LINEAR_FULL_V - BAT_LINEAR_EMPTY_V) + 0.5f);
 }
+#endif
 
 // Выбор профиля разряда в зависимости от дефайна BAT_PROFILE_LIPO
 static int voltageToPercent(float voltage) {
@@ -52,14 +57,14 @@ void Battery_Init() {
   smoothed_bat_raw = analogRead(BATTERY_PIN);
   bat_voltage = (smoothed_bat_raw / BAT_ADC_MAX) * BAT_VOLTAGE_REF / BAT_DIVIDER_RATIO;
   bat_percent = constrain(voltageToPercent(bat_voltage), 0, 100);
-  lastBatRead = millis();
-  graceUntil = millis() + BAT_GRACE_MS;
+  lastBatRead = Scale_Millis();
+  graceUntil = Scale_Millis() + BAT_GRACE_MS;
 }
 
 // Обновление состояния батареи — вызывается каждый loop().
 // Мигание обновляется всегда; ADC считывается не чаще BAT_READ_INTERVAL_MS.
 void Battery_Update() {
-  unsigned long now = millis();
+  unsigned long now = Scale_Millis();
 
   if (bat_percent < BAT_LOW_PERCENT) {
     if (now - lastBlinkToggle >= BLINK_INTERVAL_MS) {
@@ -85,7 +90,7 @@ int Battery_GetPercent() { return bat_percent; }
 bool Battery_IsLow() { return bat_percent < BAT_LOW_PERCENT; }
 
 bool Battery_IsCritical() {
-  if ((long)(millis() - graceUntil) < 0) return false; // корректная проверка с учётом переполнения millis()
+  if ((long)(Scale_Millis() - graceUntil) < 0) return false; // корректная проверка с учётом переполнения millis()
   if (smoothed_bat_raw < BAT_MIN_ADC_CONNECTED) return false;
   return (bat_percent <= BAT_CRITICAL_PERCENT);
 }
@@ -0,0 +1,41 @@
+#include "BootTrace.h"
+
+#if BOOT_TRACE_ENABLED
+
+#include <Arduino.h>
+
+struct BootStage {
+  const char* name;
+  uint32_t us;      // micros() в момент отметки
+};
+
+static BootStage stages[BOOT_TRACE_MAX];
+static uint8_t stageCount = 0;
+static bool finished = false;
+
+void BootTrace_Mark(const char* stage) {
+  if (finished || stageCount >= BOOT_TRACE_MAX) return;
+  stages[stageCount].name = stage;
+  stages[stageCount].us = micros();
+  stageCount++;
+}
+
+void BootTrace_Finish(const char* stage) {
+  if (finished) return;
+  BootTrace_Mark(stage);
+  finished = true;
+  DEBUG_PRINTF("[BOOT] %s at %lu ms\n", stage, (unsigned long)(micros() / 1000UL));
+}
+
+void BootTrace_Dump() {
+  Serial.printf("[BOOT] %-14s %8s %8s\n", "stage", "t, ms", "dt, ms");
+  uint32_t prev = 0;
+  for (uint8_t i = 0; i < stageCount; i++) {
+    Serial.printf("[BOOT] %-14s %8.1f %8.1f\n", stages[i].name,
+                  stages[i].us / 1000.0f, (stages[i].us - prev) / 1000.0f);
+    prev = stages[i].us;
+  }
+  if (!finished) Serial.println(F("[BOOT] (not finished)"));
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+#include "Config.h"
+
+// Отметки времени этапов загрузки: от сброса до первого кадра с живым весом.
+// Метки — строковые литералы (хранится только указатель).
+
+#if BOOT_TRACE_ENABLED
+
+void BootTrace_Mark(const char* stage);    // Отметить завершение этапа
+void BootTrace_Finish(const char* stage);  // Последняя отметка; дальше отметки игнорируются
+void BootTrace_Dump();                     // Таблица этапов в Serial
+
+#else
+
+inline void BootTrace_Mark(const char*) {}
+inline void BootTrace_Finish(const char*) {}
+inline void BootTrace_Dump() {}
+
+#endif
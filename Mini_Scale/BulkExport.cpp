@@ -0,0 +1,162 @@
+#include "BulkExport.h"
+#include "Crc16.h"
+#include <string.h>
+
+static_assert(BULK_FRAME_MAX <= 254, "frames fit in a single COBS run");
+
+// ===== Кадры =====
+
+size_t Bulk_EncodeFrame(uint8_t type, const void* body, size_t len, uint8_t* out) {
+  uint8_t raw[BULK_FRAME_MAX];
+  if (len + 3 > sizeof(raw)) return 0;
+  raw[0] = type;
+  memcpy(raw + 1, body, len);
+  uint16_t crc = Crc16_Update(CRC16_INIT, raw, len + 1);
+  raw[len + 1] = (uint8_t)crc;
+  raw[len + 2] = (uint8_t)(crc >> 8);
+  len += 3;
+
+  // COBS: каждый ноль заменяется расстоянием до следующего
+  size_t o = 1, code = 0;
+  uint8_t run = 1;
+  for (size_t i = 0; i < len; i++) {
+    if (raw[i] == 0) {
+      out[code] = run;
+      code = o++;
+      run = 1;
+    } else {
+      out[o++] = raw[i];
+      run++;
+    }
+  }
+  out[code] = run;
+  out[o++] = 0;
+  return o;
+}
+
+void Bulk_InitDecoder(BulkFrameDecoder* d) {
+  d->len = 0;
+  d->overflow = false;
+  d->error = false;
+}
+
+// Декодирование COBS на месте; false — нарушена структура
+static bool cobsDecode(uint8_t* buf, size_t len, size_t* outLen) {
+  size_t i = 0, o = 0;
+  while (i < len) {
+    uint8_t code = buf[i++];
+    if (code == 0 || i + code - 1 > len) return false;
+    for (uint8_t k = 1; k < code; k++) buf[o++] = buf[i++];
+    if (code < 0xFF && i < len) buf[o++] = 0;
+  }
+  *outLen = o;
+  return true;
+}
+
+bool Bulk_FeedByte(BulkFrameDecoder* d, uint8_t b, uint8_t* type, const uint8_t** body, size_t* len) {
+  if (b != 0) {
+    if (d->len < sizeof(d->buf)) d->buf[d->len++] = b;
+    else d->overflow = true;
+    return false;
+  }
+  size_t n = 0;
+  bool ok = !d->overflow && d->len > 0 && cobsDecode(d->buf, d->len, &n) && n >= 3;
+  if (ok) {
+    uint16_t crc = d->buf[n - 2] | ((uint16_t)d->buf[n - 1] << 8);
+    ok = crc == Crc16_Update(CRC16_INIT, d->buf, n - 2);
+  }
+  d->error = !ok && (d->len > 0 || d->overflow);
+  d->len = 0;
+  d->overflow = false;
+  if (!ok) return false;
+  *type = d->buf[0];
+  *body = d->buf + 1;
+  *len = n - 3;
+  return true;
+}
+
+// ===== Устройство =====
+
+static BulkFrameDecoder rx;
+static_assert(sizeof(rx) <= RAM_BULK_RX_BYTES, "bulk receive frame is over its RAM budget line");
+static bool rxReady = false;
+
+// Ведущий ноль закрывает всё, что было в линии до кадра (отладочный текст)
+static void sendFrame(Print& out, uint8_t type, const void* body, size_t len) {
+  uint8_t wire[BULK_WIRE_MAX + 1];
+  wire[0] = 0;
+  out.write(wire, Bulk_EncodeFrame(type, body, len, wire + 1) + 1);
+}
+
+void BulkExport_Hello(Print& out) {
+  BulkHello h;
+  h.version = BULK_PROTOCOL_VERSION;
+  h.blockSize = HISTORY_BLOCK_SIZE;
+  h.baud = BULK_EXPORT_BAUD;
+  h.first = History_FirstPosition();
+  h.end = History_EndPosition();
+  sendFrame(out, BULK_HELLO, &h, sizeof(h));
+}
+
+// Блоки читаются из flash по одному прямо в кадр — весь архив в RAM не нужен
+static void serveRead(Print& out, const BulkRead& req) {
+  HistoryCursor c;
+  uint8_t body[4 + HISTORY_BLOCK_SIZE];
+  uint32_t position, next = req.from;
+  uint16_t sent = 0;
+  if (History_OpenBlocks(&c, req.from)) {
+    while (sent < req.maxBlocks && History_NextBlock(&c, &position)) {
+      memcpy(body, &position, 4);
+      memcpy(body + 4, c.block, HISTORY_BLOCK_SIZE);
+      sendFrame(out, BULK_DATA, body, sizeof(body));
+      next = position + 1;
+      sent++;
+      ESP.wdtFeed();
+    }
+  }
+  if (sent < req.maxBlocks) next = History_EndPosition();   // дочитано до конца
+  sendFrame(out, BULK_END, &next, sizeof(next));
+}
+
+int BulkExport_Process(Stream& io) {
+  if (!rxReady) {
+    Bulk_InitDecoder(&rx);
+    rxReady = true;
+  }
+  while (io.available() > 0) {
+    uint8_t type;
+    const uint8_t* body;
+    size_t len;
+    if (!Bulk_FeedByte(&rx, (uint8_t)io.read(), &type, &body, &len)) continue;
+    if (type == BULK_BYE) return -1;
+    if (type == BULK_READ && len == sizeof(BulkRead)) {
+      BulkRead req;
+      memcpy(&req, body, sizeof(req));
+      serveRead(io, req);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Последний обслуженный запрос сеанса x: тишина дольше BULK_EXPORT_IDLE_MS — конец
+static unsigned long lastRequestAt = 0;
+
+void BulkExport_Begin() {
+  RtcLog_Load();
+  RtcLog_Flush();   // выгрузка должна видеть и ещё не сброшенные измерения
+  BulkExport_Hello(Serial);
+  Serial.flush();
+  Serial.updateBaudRate(BULK_EXPORT_BAUD);
+  rxReady = false;
+  lastRequestAt = millis();
+}
+
+bool BulkExport_Step() {
+  int r = BulkExport_Process(Serial);
+  if (r > 0) lastRequestAt = millis();
+  if (r >= 0 && millis() - lastRequestAt < BULK_EXPORT_IDLE_MS) return true;
+  Serial.flush();
+  Serial.updateBaudRate(SERIAL_BAUD);
+  return false;
+}
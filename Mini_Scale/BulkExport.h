@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <Arduino.h>
+#include "Config.h"
+#include "HistoryStore.h"
+
+// Двоичная выгрузка архива по Serial. Кадр: COBS(тип, тело, CRC16) и 0x00
+// как разделитель — после сбоя приёмник синхронизируется на следующем нуле.
+// Блоки архива уходят как есть, сжатыми (SampleCodec), без printf на запись.
+//
+// Сеанс: команда x консоли на SERIAL_BAUD -> HELLO на той же скорости, затем обе
+// стороны переходят на BULK_EXPORT_BAUD. Хост шлёт READ с позиции; ответ —
+// DATA на каждый блок и END с позицией продолжения. Позиции блоков не
+// меняются при переходе кольца по кругу: оборванную выгрузку хост продолжает
+// с последней принятой. BYE или тишина BULK_EXPORT_IDLE_MS — конец сеанса.
+// Сеанс ведёт консоль из loop() (BulkExport_Step), взвешивание не останавливается.
+
+#define BULK_PROTOCOL_VERSION 1
+
+enum BulkFrameType : uint8_t {
+  BULK_HELLO = 1,   // устройство: BulkHello
+  BULK_READ  = 2,   // хост: BulkRead
+  BULK_DATA  = 3,   // устройство: позиция (u32) + блок HISTORY_BLOCK_SIZE
+  BULK_END   = 4,   // устройство: позиция продолжения (u32)
+  BULK_BYE   = 5    // хост: конец сеанса
+};
+
+struct BulkHello {
+  uint16_t version;
+  uint16_t blockSize;
+  uint32_t baud;        // Скорость после HELLO
+  uint32_t first;       // Позиция самого старого блока
+  uint32_t end;         // Позиция следующего записываемого
+};
+
+struct BulkRead {
+  uint32_t from;
+  uint16_t maxBlocks;
+  uint16_t reserved;
+};
+
+// Самый длинный кадр — DATA: тип + позиция + блок + CRC; в COBS + байт на 254 и ноль
+#define BULK_FRAME_MAX  (1 + 4 + HISTORY_BLOCK_SIZE + 2)
+#define BULK_WIRE_MAX   (BULK_FRAME_MAX + BULK_FRAME_MAX / 254 + 2)
+
+struct BulkFrameDecoder {
+  uint8_t buf[BULK_WIRE_MAX];
+  size_t  len;
+  bool    overflow;      // Кадр длиннее буфера — ждать следующего нуля
+  bool    error;         // Последний кадр отброшен (COBS, CRC, переполнение)
+};
+
+size_t Bulk_EncodeFrame(uint8_t type, const void* body, size_t len, uint8_t* out); // out >= BULK_WIRE_MAX
+void Bulk_InitDecoder(BulkFrameDecoder* d);
+// Принять байт; true — кадр с верным CRC: тип и тело (указатель в буфер декодера)
+bool Bulk_FeedByte(BulkFrameDecoder* d, uint8_t b, uint8_t* type, const uint8_t** body, size_t* len);
+
+void BulkExport_Hello(Print& out);    // Кадр HELLO
+int BulkExport_Process(Stream& io);   // Разобрать принятое: 1 — запрос обслужен, 0 — нет, -1 — BYE
+void BulkExport_Begin();              // Сеанс по команде x: HELLO и смена скорости
+bool BulkExport_Step();               // Обслужить принятое без ожидания; false — сеанс окончен, скорость возвращена
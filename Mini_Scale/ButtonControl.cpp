@@ -1,6 +1,7 @@
 #include "ButtonControl.h"
 #include <Arduino.h>
 #include "CoreLogic.h"
+#include "Log.h"
 
 static ButtonState btnState = BTN_IDLE;
 
@@ -11,6 +12,10 @@ static unsigned long menuPromptTime  = 0;  // момент когда показ
 // Флаг: "Press again" уже показано, ждём второго нажатия
 static bool menuPromptActive = false;
 
+// Режим щелчков: порог удержания (0 — выключен) и флаг "удержание уже выдано"
+static unsigned long clickLongMs = 0;
+static bool longPressSent = false;
+
 // ===== Инициализация кнопки =====
 void Button_Init() {
   pinMode(BUTTON_PIN, INPUT_PULLUP);
@@ -30,7 +35,7 @@ ButtonAction Button_Update() {
         if (CoreLogic::TimeoutElapsed(now, menuPromptTime, MENU_CONFIRM_WINDOW_MS)) {
           // Время вышло — отмена
           menuPromptActive = false;
-          DEBUG_PRINTLN(F("[BTN] menu confirm window expired"));
+          LOG(BTN_CONFIRM_EXPIRED);
           return BTN_MENU_CANCEL;
         }
       }
@@ -52,13 +57,14 @@ ButtonAction Button_Update() {
           menuPromptActive = false;
           btnState = BTN_IDLE;
           lastActivityTime = now;
-          DEBUG_PRINTLN(F("[BTN] MENU ENTER"));
+          LOG(BTN_MENU_ENTER);
           return BTN_MENU_ENTER;
         }
         btnPressTime = now;
         btnState = BTN_HOLDING;
         lastActivityTime = now;
-        DEBUG_PRINTLN(F("[BTN] press confirmed, holding..."));
+        longPressSent = false;
+        LOG(BTN_HOLDING);
         return BTN_SHOW_HINT;
       } else {
         // Дребезг — назад
@@ -71,11 +77,20 @@ ButtonAction Button_Update() {
       if (pressed) {
         unsigned long held = now - btnPressTime;
 
+        // Режим щелчков: удержание срабатывает сразу по порогу, не дожидаясь отпускания
+        if (clickLongMs > 0) {
+          if (!longPressSent && held >= clickLongMs) {
+            longPressSent = true;
+            return BTN_LONG_PRESS;
+          }
+          return BTN_SHOW_HINT;
+        }
+
         // Достигли порога входа в меню — показываем "Press again"
         if (!menuPromptActive && held >= MENU_HOLD_MS && held < BUTTON_TARE_MS) {
           menuPromptActive = true;
           menuPromptTime = now;
-          DEBUG_PRINTLN(F("[BTN] menu prompt shown"));
+          LOG(BTN_MENU_PROMPT);
           return BTN_MENU_PROMPT;
         }
 
@@ -105,7 +120,11 @@ ButtonAction Button_Update() {
         lastActivityTime = now;
         btnState = BTN_IDLE;
 
-        DEBUG_PRINTF("[BTN] released, elapsed=%lums\n", elapsed);
+        LOG(BTN_RELEASED, elapsed);
+
+        if (clickLongMs > 0) {
+          return longPressSent ? BTN_NONE : BTN_CLICK;
+        }
 
         CoreLogic::HoldAction holdAction = CoreLogic::ClassifyHoldDuration(elapsed, MENU_HOLD_MS, BUTTON_TARE_MS, BUTTON_UNDO_MS);
         if (holdAction == CoreLogic::HOLD_UNDO) {
@@ -133,6 +152,23 @@ bool Button_IsHolding() {
   return (btnState == BTN_HOLDING);
 }
 
+// Проверка: автомат в покое (кнопка не нажата, антидребезг не идёт)?
+// Только в этом состоянии можно усыплять CPU до нажатия — пробуждение по уровню LOW.
+bool Button_IsIdle() {
+  return (btnState == BTN_IDLE);
+}
+
+void Button_SetClickMode(unsigned long longPressMs) {
+  clickLongMs = longPressMs;
+  menuPromptActive = false;
+}
+
+void Button_Reset() {
+  btnState = BTN_IDLE;
+  longPressSent = false;
+  menuPromptActive = false;
+}
+
 // Время удержания кнопки в миллисекундах.
 unsigned long Button_HoldElapsed() {
   if (btnState == BTN_HOLDING) {
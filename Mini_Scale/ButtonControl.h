@@ -9,7 +9,9 @@ enum ButtonAction {
   BTN_MENU_ENTER,     // Второе нажатие после "Press again" — войти в меню
   BTN_MENU_CANCEL,    // Окно ожидания истекло — отмена входа в меню
   BTN_TARE,           // Тарирование (удержание 10 секунд)
-  BTN_UNDO            // Отмена тарирования (удержание 15 секунд)
+  BTN_UNDO,           // Отмена тарирования (удержание 15 секунд)
+  BTN_CLICK,          // Режим щелчков: отпущена раньше порога удержания
+  BTN_LONG_PRESS      // Режим щелчков: порог удержания достигнут (один раз, кнопка ещё нажата)
 };
 
 // Внутренние состояния конечного автомата кнопки
@@ -26,4 +28,11 @@ extern unsigned long lastActivityTime;
 void Button_Init();                  // Инициализация пина кнопки
 ButtonAction Button_Update();        // Опрос кнопки — возвращает текущее действие
 bool Button_IsHolding();             // Кнопка сейчас удерживается?
+bool Button_IsIdle();                // Автомат в состоянии покоя (BTN_IDLE)?
 unsigned long Button_HoldElapsed();  // Время удержания кнопки (мс)
+// Режим щелчков (калибровка): вместо меню/тары — BTN_CLICK и BTN_LONG_PRESS
+// с порогом longPressMs; 0 — обычный режим главного экрана
+void Button_SetClickMode(unsigned long longPressMs);
+// Автомат в покой: нажатие, замеченное до этого (например, чтением HX711 в
+// Scale_Init), действием не станет
+void Button_Reset();
@@ -0,0 +1,145 @@
+#include "CalFit.h"
+#include <math.h>
+
+// Решение системы n×n (n <= CAL_FIT_DEGREE) методом Гаусса с выбором
+// главного элемента; false — вырожденная (массы совпадают)
+static bool solveLinear(double a[CAL_FIT_DEGREE][CAL_FIT_DEGREE + 1], uint8_t n, double* x) {
+  for (uint8_t col = 0; col < n; col++) {
+    uint8_t pivot = col;
+    for (uint8_t r = col + 1; r < n; r++) {
+      if (fabs(a[r][col]) > fabs(a[pivot][col])) pivot = r;
+    }
+    if (fabs(a[pivot][col]) < 1e-12) return false;
+    if (pivot != col) {
+      for (uint8_t c = 0; c <= n; c++) {
+        double t = a[col][c];
+        a[col][c] = a[pivot][c];
+        a[pivot][c] = t;
+      }
+    }
+    for (uint8_t r = col + 1; r < n; r++) {
+      double f = a[r][col] / a[col][col];
+      for (uint8_t c = col; c <= n; c++) a[r][c] -= f * a[col][c];
+    }
+  }
+  for (int r = n - 1; r >= 0; r--) {
+    double s = a[r][n];
+    for (uint8_t c = r + 1; c < n; c++) s -= a[r][c] * x[c];
+    x[r] = s / a[r][r];
+  }
+  return true;
+}
+
+static double poly(const double* coef, uint8_t degree, double u) {
+  double y = 0.0;
+  for (int d = degree - 1; d >= 0; d--) y = (y + coef[d]) * u;
+  return y;
+}
+
+// Наименьшие квадраты для m = a1·u + … + aD·u^D: нормальные уравнения
+static bool fitPoly(const CalPoint* pts, uint8_t n, float calFactor, uint8_t degree, double* coef) {
+  double a[CAL_FIT_DEGREE][CAL_FIT_DEGREE + 1] = {};
+  for (uint8_t i = 0; i < n; i++) {
+    double u = pts[i].counts / calFactor;
+    double pw[2 * CAL_FIT_DEGREE + 1];
+    pw[0] = 1.0;
+    for (uint8_t k = 1; k <= 2 * degree; k++) pw[k] = pw[k - 1] * u;
+    for (uint8_t p = 0; p < degree; p++) {
+      for (uint8_t q = 0; q < degree; q++) a[p][q] += pw[p + q + 2];
+      a[p][degree] += pts[i].kg * pw[p + 1];
+    }
+  }
+  return solveLinear(a, degree, coef);
+}
+
+float CalFit_Apply(const float* knots, float invStep, float u) {
+  float pos = u * invStep;
+  int seg = (int)pos;
+  if (pos < 0.0f) seg = 0;
+  if (seg > CAL_LIN_SEGMENTS - 1) seg = CAL_LIN_SEGMENTS - 1;
+  return knots[seg] + (pos - seg) * (knots[seg + 1] - knots[seg]);
+}
+
+bool CalFit_Solve(const CalPoint* pts, uint8_t n, CalFitResult* out) {
+  if (n == 0) return false;
+  double cm = 0.0, mm = 0.0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (!(pts[i].kg > 0.0f) || isnan(pts[i].counts) || isinf(pts[i].counts)) return false;
+    cm += (double)pts[i].counts * pts[i].kg;
+    mm += (double)pts[i].kg * pts[i].kg;
+  }
+  float factor = (float)(cm / mm);
+  if (!(factor >= CAL_FACTOR_MIN && factor <= CAL_FACTOR_MAX)) return false;
+
+  float span = 0.0f;
+  float linErr = 0.0f;
+  for (uint8_t i = 0; i < n; i++) {
+    float u = pts[i].counts / factor;
+    if (u > span) span = u;
+    if (fabsf(u - pts[i].kg) > linErr) linErr = fabsf(u - pts[i].kg);
+  }
+  if (!(span > 0.0f)) return false;
+
+  // Высокая степень по немногим точкам может дать немонотонную кривую —
+  // тогда степень понижается; степень 1 монотонна всегда
+  uint8_t degree = n < CAL_FIT_DEGREE ? n : CAL_FIT_DEGREE;
+  for (; degree >= 1; degree--) {
+    double coef[CAL_FIT_DEGREE];
+    if (!fitPoly(pts, n, factor, degree, coef)) continue;
+    bool monotonic = true;
+    for (uint8_t k = 0; k <= CAL_LIN_SEGMENTS; k++) {
+      out->knots[k] = (float)poly(coef, degree, (double)span * k / CAL_LIN_SEGMENTS);
+      if (k > 0 && !(out->knots[k] > out->knots[k - 1])) monotonic = false;
+    }
+    if (monotonic) break;
+  }
+  if (degree == 0) return false;
+
+  out->calFactor = factor;
+  out->span = span;
+  out->degree = degree;
+  out->linearErrorKg = linErr;
+  out->maxErrorKg = 0.0f;
+  float invStep = CAL_LIN_SEGMENTS / span;
+  for (uint8_t i = 0; i < n; i++) {
+    float e = fabsf(CalFit_Apply(out->knots, invStep, pts[i].counts / factor) - pts[i].kg);
+    if (e > out->maxErrorKg) out->maxErrorKg = e;
+  }
+  return true;
+}
+
+// ===== Накопление отсчётов =====
+
+void CalSettle_Reset(CalSettle* s) {
+  s->n = 0;
+  s->total = 0;
+  s->mean = 0.0;
+  s->m2 = 0.0;
+}
+
+void CalSettle_Add(CalSettle* s, long counts) {
+  s->n++;
+  double delta = counts - s->mean;
+  s->mean += delta / s->n;
+  s->m2 += delta * (counts - s->mean);
+}
+
+float CalSettle_StdDev(const CalSettle* s) {
+  return s->n >= 2 ? (float)sqrt(s->m2 / (s->n - 1)) : 0.0f;
+}
+
+float CalSettle_StdErr(const CalSettle* s) {
+  return s->n >= 2 ? CalSettle_StdDev(s) / sqrtf((float)s->n) : 0.0f;
+}
+
+CalSettleStatus CalSettle_Feed(CalSettle* s, long counts, float jump, float target) {
+  if (s->n > 0 && fabs(counts - s->mean) > jump) {
+    s->n = 0;
+    s->mean = 0.0;
+    s->m2 = 0.0;
+  }
+  CalSettle_Add(s, counts);
+  s->total++;
+  if (s->n >= CAL_AUTO_MIN_SAMPLES && CalSettle_StdErr(s) <= target) return SETTLE_DONE;
+  return s->total >= CAL_AUTO_MAX_SAMPLES ? SETTLE_FAILED : SETTLE_BUSY;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Калибровка по эталонным массам: подбор методом наименьших квадратов
+// (многоточечная) и накопление отсчётов с оценкой разброса (автокалибровка).
+//
+//   1. cal_factor — наклон прямой через ноль (отсчёты на кг) по всем точкам.
+//   2. Поправка нелинейности: полином m = a1·u + … + aD·u^D без свободного
+//      члена (ноль задан тарой) по u = отсчёты / cal_factor, D = min(n, CAL_FIT_DEGREE).
+//   3. Полином сводится в таблицу из CAL_LIN_SEGMENTS отрезков на [0, span],
+//      span — наибольшая масса в единицах u. На каждое измерение — индекс
+//      отрезка и одна интерполяция; за пределами таблицы — продолжение
+//      крайнего отрезка.
+
+struct CalPoint {
+  float counts;   // Среднее отсчётов HX711 минус offset тары
+  float kg;       // Эталонная масса
+};
+
+struct CalFitResult {
+  float   calFactor;
+  float   span;                          // Граница таблицы, u
+  float   knots[CAL_LIN_SEGMENTS + 1];   // Вес в узлах u = span·k / CAL_LIN_SEGMENTS
+  uint8_t degree;                        // Степень полинома (1 — только cal_factor)
+  float   linearErrorKg;                 // Наибольшее отклонение по точкам без поправки
+  float   maxErrorKg;                    // То же с поправкой
+};
+
+// false — точек нет, масса не положительна, коэффициент вне
+// CAL_FACTOR_MIN..MAX или отсчёты не растут с массой
+bool CalFit_Solve(const CalPoint* pts, uint8_t n, CalFitResult* out);
+
+// Вес по u; invStep = CAL_LIN_SEGMENTS / span
+float CalFit_Apply(const float* knots, float invStep, float u);
+
+// ===== Накопление отсчётов (Welford) =====
+// Среднее и дисперсия за один проход без хранения отсчётов и без потери
+// точности на больших значениях (сотни тысяч отсчётов HX711).
+struct CalSettle {
+  uint16_t n;
+  uint16_t total;  // Отсчётов с начала замера, включая сброшенные скачком
+  double   mean;
+  double   m2;     // Сумма квадратов отклонений от среднего
+};
+
+void CalSettle_Reset(CalSettle* s);
+void CalSettle_Add(CalSettle* s, long counts);
+float CalSettle_StdDev(const CalSettle* s);   // СКО отсчёта (n >= 2, иначе 0)
+float CalSettle_StdErr(const CalSettle* s);   // СКО среднего = StdDev / sqrt(n)
+
+enum CalSettleStatus : uint8_t {
+  SETTLE_BUSY,     // Нужны ещё отсчёты
+  SETTLE_DONE,     // n >= CAL_AUTO_MIN_SAMPLES и СКО среднего <= target
+  SETTLE_FAILED,   // Не сошлось за CAL_AUTO_MAX_SAMPLES отсчётов
+};
+
+// Один отсчёт замера до сходимости; пороги в отсчётах. Отклонение от
+// среднего больше jump (груз положили или сняли) — накопление заново.
+CalSettleStatus CalSettle_Feed(CalSettle* s, long counts, float jump, float target);
@@ -2,176 +2,405 @@
 #include "Config.h"
 #include "MemoryControl.h"
 #include "ScaleControl.h"
+#include "CalFit.h"
 #include "DisplayControl.h"
 #include "BatteryControl.h"
+#include "ButtonControl.h"
 #include "CoreLogic.h"
 #include "UiText.h"
+#include "HiveMode.h"
+#include "Rrd.h"
 #include <Arduino.h>
 #include <math.h>
 
 // -------------------------------------------------------
-// RunCalibrationMode
-// -------------------------------------------------------
-// Блокирующий режим ручной калибровки коэффициента HX711.
+// Режим калибровки коэффициента HX711 — конечный автомат внутри loop().
 //
-// Управление одной кнопкой:
-//   Короткое нажатие — изменить cal_factor на шаг текущего режима
-//   Длинное нажатие  — перейти к следующему режиму (wrap-around)
+// Управление одной кнопкой (ButtonControl в режиме щелчков):
+//   Короткое нажатие — действие текущего режима (срабатывает по отпусканию)
+//   Длинное нажатие  — следующий режим (по порогу CAL_LONG_PRESS_MS, не дожидаясь отпускания)
 //
-// 7 режимов (menu_mode 0..6):
+// 8 режимов меню (menuMode 0..7):
 //   0: +10    1: -10
 //   2: +1     3: -1
 //   4: +0.1   5: -0.1
 //   6: SAVE — сохраняет cal_factor в EEPROM и перезагружает устройство
+//   7: AUTO — автокалибровка по одной эталонной массе
+//
+// Вес на экране — скользящее среднее HX711_SAMPLES_CAL конверсий, обновляется
+// с каждой готовой конверсией (Scale_PollCounts, без ожидания DOUT). Экран
+// перерисовывается только по новой конверсии или событию кнопки.
+//
+// AUTO: ноль на пустой платформе, выбор эталонной массы, замер с массой.
+// Каждый замер — накопление до сходимости СКО среднего (CalSettle_Feed),
+// cal_factor = (груз - ноль) / масса; на экране — СКО результата в граммах.
 //
-// Функция никогда не возвращает управление:
-//   - при сохранении (SAVE) → ESP.restart()
-//   - при таймауте бездействия (CAL_IDLE_TIMEOUT_MS) → ESP.restart()
-//   - при критическом заряде батареи → ESP.deepSleep(0)
+// Выход только перезагрузкой: SAVE, таймаут бездействия CAL_IDLE_TIMEOUT_MS
+// (без сохранения) или deep sleep при критическом заряде батареи.
 // -------------------------------------------------------
-void RunCalibrationMode() {
-  // ===== Приветственный экран — ждём отпускания кнопки =====
+
+enum CalState : uint8_t {
+  CAL_OFF,
+  CAL_RELEASE,      // Ждём отпускания кнопки, которой вошли в режим
+  CAL_MENU,         // Ручная подстройка коэффициента
+  CAL_AUTO_EMPTY,   // "Empty platform": нажатие — замер нуля
+  CAL_AUTO_ZERO,    // Замер нуля
+  CAL_AUTO_REF,     // Выбор эталонной массы
+  CAL_AUTO_PLACE,   // "Place X kg": нажатие — замер с массой
+  CAL_AUTO_LOAD,    // Замер с массой
+  CAL_AUTO_RESULT,  // Коэффициент и погрешность: нажатие — SAVE
+  CAL_NOTICE,       // Сообщение об ошибке AUTO до нажатия
+  CAL_EXIT          // Итоговое сообщение, затем перезагрузка
+};
+
+static const uint8_t MENU_COUNT = 8; // режимы: +10, -10, +1, -1, +0.1, -0.1, SAVE, AUTO
+
+// Эталонные массы на выбор в AUTO, кг
+static const float refMassValues[CAL_REF_MASS_COUNT] = { 0.1f, 0.2f, 0.5f, 1.0f, 2.0f, 5.0f };
+
+static CalState state = CAL_OFF;
+static uint8_t menuMode = 0;
+static float workFactor = DEFAULT_CALIBRATION;  // рабочая копия — в EEPROM не пишем до SAVE
+static unsigned long lastActionTime = 0;
+static unsigned long stateTime = 0;             // вход в текущее состояние
+static bool dirty = true;                       // экран нужно перерисовать
+
+// Скользящее среднее последних конверсий для веса на экране
+static long recent[HX711_SAMPLES_CAL];
+static uint8_t recentIdx = 0;
+static uint8_t recentCount = 0;
+static unsigned long lastSampleTime = 0;
+
+// AUTO
+static CalSettle zero, load;
+static uint8_t refIdx = CAL_REF_MASS_DEFAULT;
+static float autoFactor = 0.0f;
+static float autoErrG = 0.0f;
+static unsigned long autoStarted = 0;
+static PGM_P noticeText = nullptr;          // строка во flash
+
+static void enter(CalState s) {
+  state = s;
+  stateTime = millis();
+  dirty = true;
+}
+
+// Экран из двух-трёх строк мелким шрифтом; подсказка внизу — из flash
+static void showLines(const char* l1, const char* l2, const __FlashStringHelper* hint) {
   display.clearDisplay();
   display.setTextSize(1);
-  display.setCursor(0, 20);
-  display.print("CALIBRATION MODE");
-  display.setCursor(0, 32);
-  display.print("Release button...");
-  display.display();
+  display.setCursor(0, 8);
+  display.print(l1);
+  display.setCursor(0, 24);
+  display.print(l2);
+  display.setCursor(0, 45);
+  display.print(hint);
+  Display_Flush();
+}
 
-  while (digitalRead(BUTTON_PIN) == LOW) { ESP.wdtFeed(); delay(10); }
-  delay(DEBOUNCE_MS);
+static void drawMenu() {
+  display.clearDisplay();
 
-  // ===== Инициализация =====
-  int menu_mode = 0;
-  const int MENU_COUNT = 7; // режимы: +10, -10, +1, -1, +0.1, -0.1, SAVE
+  // Вес крупным шрифтом (или ERR если HX711 не отвечает)
+  display.setTextSize(2);
+  display.setCursor(0, 0);
+  bool hx711_ok = recentCount > 0 && millis() - lastSampleTime < HX711_TIMEOUT_MS;
+  if (hx711_ok) {
+    long sum = 0;
+    for (uint8_t i = 0; i < recentCount; i++) sum += recent[i];
+    float w = ((float)sum / recentCount - (float)Scale_GetOffset()) / workFactor;
+    display.print(w, 2);
+    display.print(F(" kg"));
+  } else {
+    display.print(F("ERR"));
+  }
 
-  float current_factor = savedData.cal_factor; // рабочая копия — в EEPROM не пишем до SAVE
-  scale.set_offset(savedData.tare_offset);      // применяем сохранённый offset (не меняем в калибровке)
-  bool hx711_ok = true;
+  // Текущий коэффициент и номер режима
+  display.setTextSize(1);
+  display.setCursor(0, 25);
+  display.print(F("F:"));
+  display.print(workFactor, 1);
+  display.print(F(" ["));
+  display.print(menuMode + 1);
+  display.print('/');
+  display.print(MENU_COUNT);
+  display.print(']');
+
+  // Подсказка по текущему режиму
+  display.setCursor(0, 45);
+  if      (menuMode == 0) { display.print(F("Hold=Next Click=+10")); }
+  else if (menuMode == 1) { display.print(F("Hold=Next Click=-10")); }
+  else if (menuMode == 2) { display.print(F("Hold=Next Click=+1")); }
+  else if (menuMode == 3) { display.print(F("Hold=Next Click=-1")); }
+  else if (menuMode == 4) { display.print(F("Hold=Next Click=+0.1")); }
+  else if (menuMode == 5) { display.print(F("Hold=Next Click=-0.1")); }
+  else if (menuMode == 6) { display.print(F("Hold=Next Click=SAVE")); }
+  else if (menuMode == 7) { display.print(F("Hold=Next Click=AUTO")); }
 
-  unsigned long lastActionTime = millis();
+  Display_Flush();
+}
 
-  // ===== Главный цикл калибровки =====
-  while (true) {
-    ESP.wdtFeed();
+static void drawMeasure(const char* what, const CalSettle& s) {
+  char line[24];
+  snprintf(line, sizeof(line), "n=%u +-%.1f g", s.n, CalSettle_StdErr(&s) / workFactor * 1000.0f);
+  showLines(what, line, F("Click=Cancel"));
+}
 
-    // -- Таймаут бездействия: выход без сохранения --
-    if (CoreLogic::TimeoutElapsed(millis(), lastActionTime, CAL_IDLE_TIMEOUT_MS)) {
+static void draw() {
+  char line[24], line2[32];
+  switch (state) {
+    case CAL_RELEASE:
+      showLines("CALIBRATION MODE", "Release button...", F(""));
+      break;
+    case CAL_MENU:
+      drawMenu();
+      break;
+    case CAL_AUTO_EMPTY:
+      showLines("AUTO CAL", "Empty platform", F("Click=Go Hold=Back"));
+      break;
+    case CAL_AUTO_ZERO:
+      drawMeasure("Zero", zero);
+      break;
+    case CAL_AUTO_REF:
+      snprintf(line, sizeof(line), "Ref: %.3f kg", refMassValues[refIdx]);
+      showLines("AUTO CAL", line, F("Click=Next Hold=OK"));
+      break;
+    case CAL_AUTO_PLACE:
+      snprintf(line, sizeof(line), "Place %.3f kg", refMassValues[refIdx]);
+      showLines("AUTO CAL", line, F("Click=Go Hold=Back"));
+      break;
+    case CAL_AUTO_LOAD:
+      snprintf(line, sizeof(line), "Load %.3f kg", refMassValues[refIdx]);
+      drawMeasure(line, load);
+      break;
+    case CAL_AUTO_RESULT:
+      snprintf(line, sizeof(line), "F:%.1f", autoFactor);
+      snprintf(line2, sizeof(line2), "+-%.1f g %lus", autoErrG, (stateTime - autoStarted) / 1000UL);
+      showLines(line, line2, F("Click=SAVE Hold=Back"));
+      break;
+    case CAL_NOTICE:
+      strncpy_P(line, noticeText, sizeof(line) - 1);
+      line[sizeof(line) - 1] = '\0';
+      showLines("AUTO CAL", line, F("Click=Back"));
+      break;
+    case CAL_EXIT:
       display.clearDisplay();
       display.setCursor(0, 20);
-      display.setTextSize(1);
-      display.print("CAL TIMEOUT");
-      display.setCursor(0, 32);
-      display.print("Not saved.");
-      display.display();
-      delay(CAL_SAVED_MSG_MS);
-      Display_Off();
-      ESP.restart();
-    }
+      if (noticeText == UiText::kSaved) {
+        display.setTextSize(2);
+        display.print(FPSTR(UiText::kSaved));
+      } else {
+        display.setTextSize(1);
+        display.print(F("CAL TIMEOUT"));
+        display.setCursor(0, 32);
+        display.print(F("Not saved."));
+      }
+      Display_Flush();
+      break;
+    case CAL_OFF:
+      break;
+  }
+}
 
-    // -- Критический заряд батареи: сохранить текущие данные и выключиться --
-    Battery_Update();
-    if (Battery_IsCritical()) {
-      Memory_ForceSave();
-      Display_Off();
-      ESP.deepSleep(0);
-    }
+// Сохранить в EEPROM и перезагрузиться после сообщения.
+// Новый коэффициент отменяет поправку линейности многоточечной калибровки.
+static void save(float factor) {
+  savedData.cal_factor = factor;
+  savedData.lin_span = 0.0f;
+  Memory_ForceSave();
+  noticeText = UiText::kSaved;
+  enter(CAL_EXIT);
+}
 
-    // -- Считывание веса с текущим рабочим коэффициентом --
-    scale.set_scale(current_factor);
-    float w = 0.0f;
-    hx711_ok = false;
-    if (scale.wait_ready_timeout(HX711_TIMEOUT_MS)) {
-      float raw = scale.get_units(HX711_SAMPLES_CAL);
-      if (!isnan(raw) && !isinf(raw)) {
-        w = raw;
-        hx711_ok = true;
-      }
-    }
+static void applyMenuClick() {
+  if      (menuMode == 0) workFactor += 10.0f;
+  else if (menuMode == 1) workFactor -= 10.0f;
+  else if (menuMode == 2) workFactor += 1.0f;
+  else if (menuMode == 3) workFactor -= 1.0f;
+  else if (menuMode == 4) workFactor = roundf((workFactor + 0.1f) * 10.0f) / 10.0f;
+  else if (menuMode == 5) workFactor = roundf((workFactor - 0.1f) * 10.0f) / 10.0f;
+  else if (menuMode == 6) { save(workFactor); return; }
+  else if (menuMode == 7) { enter(CAL_AUTO_EMPTY); return; }
 
-    // ===== Отрисовка экрана калибровки =====
+  // Защита от выхода за допустимые пределы коэффициента
+  if (workFactor < CAL_FACTOR_MIN) workFactor = CAL_FACTOR_MIN;
+  if (workFactor > CAL_FACTOR_MAX) workFactor = CAL_FACTOR_MAX;
+}
 
-    display.clearDisplay();
+static void notice(PGM_P text) {
+  noticeText = text;
+  enter(CAL_NOTICE);
+}
 
-    // Вес крупным шрифтом (или ERR если HX711 не отвечает)
-    display.setTextSize(2);
-    display.setCursor(0, 0);
-    if (hx711_ok) {
-      display.print(w, 2);
-      display.print(" kg");
-    } else {
-      display.print("ERR");
-    }
+// Оба замера готовы: коэффициент и СКО результата в граммах при эталонной массе
+static void finishAuto() {
+  float mass = refMassValues[refIdx];
+  autoFactor = (float)((load.mean - zero.mean) / mass);
+  if (!(autoFactor >= CAL_FACTOR_MIN && autoFactor <= CAL_FACTOR_MAX)) {
+    notice(PSTR("Bad factor"));
+    return;
+  }
+  float ez = CalSettle_StdErr(&zero), el = CalSettle_StdErr(&load);
+  autoErrG = sqrtf(ez * ez + el * el) / autoFactor * 1000.0f;
+  enter(CAL_AUTO_RESULT);
+}
 
-    // Текущий коэффициент и номер режима
-    display.setTextSize(1);
-    display.setCursor(0, 25);
-    display.print("F:");
-    display.print(current_factor, 1);
-    display.print(" [");
-    display.print(menu_mode + 1);
-    display.print("/");
-    display.print(MENU_COUNT);
-    display.print("]");
-
-    // Подсказка по текущему режиму
-    display.setCursor(0, 45);
-    if      (menu_mode == 0) { display.print("Hold=Next Click=+10"); }
-    else if (menu_mode == 1) { display.print("Hold=Next Click=-10"); }
-    else if (menu_mode == 2) { display.print("Hold=Next Click=+1"); }
-    else if (menu_mode == 3) { display.print("Hold=Next Click=-1"); }
-    else if (menu_mode == 4) { display.print("Hold=Next Click=+0.1"); }
-    else if (menu_mode == 5) { display.print("Hold=Next Click=-0.1"); }
-    else if (menu_mode == 6) { display.print("Hold=Next Click=SAVE"); }
-
-    display.display();
-
-    // ===== Обработка нажатия кнопки =====
-    if (digitalRead(BUTTON_PIN) == LOW) {
-      delay(DEBOUNCE_MS);
-      if (digitalRead(BUTTON_PIN) != LOW) continue; // дребезг — игнорируем
+// Конверсия для замера AUTO; пороги — по рабочему коэффициенту (достаточно грубого)
+static void feedMeasure(long counts) {
+  CalSettle* s = (state == CAL_AUTO_ZERO) ? &zero : &load;
+  CalSettleStatus st = CalSettle_Feed(s, counts, CAL_AUTO_JUMP_KG * workFactor,
+                                      CAL_AUTO_TARGET_KG * workFactor);
+  dirty = true;
+  if (st == SETTLE_FAILED) {
+    notice(PSTR("Not settled"));
+  } else if (st == SETTLE_DONE) {
+    if (state == CAL_AUTO_ZERO) enter(CAL_AUTO_REF);
+    else finishAuto();
+  }
+}
 
-      unsigned long pressTime = millis();
-      while (digitalRead(BUTTON_PIN) == LOW) {
-        ESP.wdtFeed();
-        delay(10);
-      }
-      delay(DEBOUNCE_MS);
-      // Сбрасываем таймер ПОСЛЕ отпускания — иначе время удержания засчитывается как простой
-      lastActionTime = millis();
-      unsigned long duration = millis() - pressTime;
+static void handleButton(ButtonAction a) {
+  if (a != BTN_CLICK && a != BTN_LONG_PRESS) return;
+  lastActionTime = millis();
+  dirty = true;
+  bool click = (a == BTN_CLICK);
 
-      if (duration > CAL_LONG_PRESS_MS) {
-        // Длинное нажатие — переход к следующему режиму (с wrap-around на 0)
-        menu_mode = (int)CoreLogic::WrapNext((uint8_t)menu_mode, MENU_COUNT);
+  switch (state) {
+    case CAL_MENU:
+      if (click) applyMenuClick();
+      else menuMode = CoreLogic::WrapNext(menuMode, MENU_COUNT);
+      break;
+    case CAL_AUTO_EMPTY:
+      if (click) {
+        autoStarted = millis();
+        CalSettle_Reset(&zero);
+        enter(CAL_AUTO_ZERO);
       } else {
-        // Короткое нажатие — применить изменение коэффициента
-        if      (menu_mode == 0) current_factor += 10.0f;
-        else if (menu_mode == 1) current_factor -= 10.0f;
-        else if (menu_mode == 2) current_factor += 1.0f;
-        else if (menu_mode == 3) current_factor -= 1.0f;
-        else if (menu_mode == 4) current_factor = roundf((current_factor + 0.1f) * 10.0f) / 10.0f;
-        else if (menu_mode == 5) current_factor = roundf((current_factor - 0.1f) * 10.0f) / 10.0f;
-        else if (menu_mode == 6) {
-          // Режим SAVE: записываем cal_factor в EEPROM и перезагружаемся
-          savedData.cal_factor = current_factor;
-          Memory_ForceSave();
-
-          display.clearDisplay();
-          display.setCursor(0, 20);
-          display.setTextSize(2);
-          display.print(UiText::kSaved);
-          display.display();
-          delay(CAL_SAVED_MSG_MS);
-          Display_Off();
-          ESP.restart();
-        }
-
-        // Защита от выхода за допустимые пределы коэффициента
-        if (current_factor < CAL_FACTOR_MIN) current_factor = CAL_FACTOR_MIN;
-        if (current_factor > CAL_FACTOR_MAX) current_factor = CAL_FACTOR_MAX;
+        enter(CAL_MENU);
       }
+      break;
+    case CAL_AUTO_ZERO:
+    case CAL_AUTO_LOAD:
+      if (click) enter(CAL_MENU);  // отмена замера
+      break;
+    case CAL_AUTO_REF:
+      if (click) refIdx = CoreLogic::WrapNext(refIdx, CAL_REF_MASS_COUNT);
+      else enter(CAL_AUTO_PLACE);
+      break;
+    case CAL_AUTO_PLACE:
+      if (click) {
+        CalSettle_Reset(&load);
+        enter(CAL_AUTO_LOAD);
+      } else {
+        enter(CAL_MENU);
+      }
+      break;
+    case CAL_AUTO_RESULT:
+      if (click) {
+        // Ноль замера — новый offset тары, поправка линейности сбрасывается в save()
+        savedData.tare_offset = lround(zero.mean);
+        save(autoFactor);
+      } else {
+        enter(CAL_MENU);
+      }
+      break;
+    case CAL_NOTICE:
+      if (click) enter(CAL_MENU);
+      break;
+    default:
+      break;
+  }
+}
+
+// -------------------------------------------------------
+// Calibration_Begin
+// -------------------------------------------------------
+void Calibration_Begin() {
+  Display_Wake();
+  Button_SetClickMode(CAL_LONG_PRESS_MS);
+  Button_Reset();   // кнопку входа автомат мог заметить ещё в Scale_Init
+  Scale_ApplyCalibration(); // сохранённый offset (в калибровке не меняется)
+  workFactor = savedData.cal_factor;
+  menuMode = 0;
+  recentCount = 0;
+  recentIdx = 0;
+  lastSampleTime = millis();
+  lastActionTime = millis();
+  enter(CAL_RELEASE);
+  draw();
+  dirty = false;
+}
+
+bool Calibration_IsActive() {
+  return state != CAL_OFF;
+}
+
+// -------------------------------------------------------
+// Calibration_Update
+// -------------------------------------------------------
+// Один шаг без ожидания: кнопка, готовая конверсия HX711, перерисовка по
+// изменению. Вызывается каждый loop() с шагом CAL_LOOP_DELAY_MS.
+// -------------------------------------------------------
+void Calibration_Update() {
+  if (state == CAL_OFF) return;
+
+  // -- Итоговое сообщение показано: перезагрузка --
+  if (state == CAL_EXIT) {
+    if (CoreLogic::TimeoutElapsed(millis(), stateTime, CAL_SAVED_MSG_MS)) {
+      Display_Off();
+      Rrd_Save();   // минутное кольцо — во flash, час/сутки переживут рестарт в RTC
+      ESP.restart();
+    }
+    return;
+  }
+
+  // -- Таймаут бездействия: выход без сохранения --
+  if (state != CAL_AUTO_ZERO && state != CAL_AUTO_LOAD &&
+      CoreLogic::TimeoutElapsed(millis(), lastActionTime, CAL_IDLE_TIMEOUT_MS)) {
+    noticeText = nullptr;
+    enter(CAL_EXIT);
+    draw();
+    return;
+  }
+
+  // -- Критический заряд батареи: сохранить текущие данные и выключиться --
+  // тем же путём, что и главный экран (RRD, сессия, RTC-журнал)
+  Battery_Update();
+  if (Battery_IsCritical()) {
+    Memory_ForceSave();
+    Display_Off();
+    Hive_Shutdown();
+  }
+
+  // -- Кнопка входа: до отпускания автомат кнопки не опрашиваем --
+  if (state == CAL_RELEASE) {
+    if (digitalRead(BUTTON_PIN) == LOW) {
+      stateTime = millis();
+    } else if (millis() - stateTime >= DEBOUNCE_MS) {
+      lastActionTime = millis();
+      enter(CAL_MENU);
     }
+  } else {
+    handleButton(Button_Update());
+  }
+
+  // -- Готовая конверсия --
+  long counts;
+  if (Scale_PollCounts(&counts)) {
+    lastSampleTime = millis();
+    recent[recentIdx] = counts;
+    recentIdx = (recentIdx + 1) % HX711_SAMPLES_CAL;
+    if (recentCount < HX711_SAMPLES_CAL) recentCount++;
+    if (state == CAL_MENU) dirty = true;
+    if (state == CAL_AUTO_ZERO || state == CAL_AUTO_LOAD) feedMeasure(counts);
+  } else if (state == CAL_MENU && recentCount > 0 &&
+             millis() - lastSampleTime >= HX711_TIMEOUT_MS) {
+    recentCount = 0;  // HX711 не отвечает — ERR на экране
+    dirty = true;
+  }
+
+  if (dirty) {
+    dirty = false;
+    draw();
   }
 }
@@ -1,5 +1,7 @@
 #pragma once
 
-// Запуск режима калибровки весов.
-// Блокирующая функция — управление не возвращается до перезагрузки.
-void RunCalibrationMode();
+// Режим калибровки весов — конечный автомат внутри loop(), без блокирующих
+// ожиданий. Выход только перезагрузкой (SAVE или таймаут бездействия).
+void Calibration_Begin();      // Войти в режим (кнопка входа ещё может быть нажата)
+bool Calibration_IsActive();   // Режим активен — loop() вызывает только Calibration_Update
+void Calibration_Update();     // Один шаг: кнопка, готовая конверсия HX711, перерисовка
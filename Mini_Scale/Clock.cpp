@@ -0,0 +1,53 @@
+#include "Clock.h"
+#include <Arduino.h>
+extern "C" {
+  #include "user_interface.h"
+}
+
+// Запись часов в RTC-памяти
+struct ClockRtc {
+  uint32_t magic;
+  uint32_t sec;      // время на момент старта (millis() = 0)
+  uint32_t check;    // ~(magic ^ sec)
+};
+
+static uint32_t baseSec = 0;
+static uint32_t sleptMs = 0;
+static bool exact = false;
+
+void Clock_Init() {
+  ClockRtc rtc;
+  ESP.rtcUserMemoryRead(CLOCK_RTC_OFFSET, (uint32_t*)&rtc, sizeof(rtc));
+  if (rtc.magic == CLOCK_RTC_MAGIC && rtc.check == ~(rtc.magic ^ rtc.sec)) {
+    baseSec = rtc.sec;
+    exact = ESP.getResetInfoPtr()->reason == REASON_DEEP_SLEEP_AWAKE;
+  } else {
+    baseSec = 0;
+    exact = false;
+  }
+  sleptMs = 0;
+}
+
+uint64_t Clock_NowMs() {
+  return (uint64_t)baseSec * 1000ULL + millis() + sleptMs;
+}
+
+uint32_t Clock_Now() {
+  return (uint32_t)(Clock_NowMs() / 1000ULL);
+}
+
+bool Clock_IsExact() {
+  return exact;
+}
+
+void Clock_AddSleptMs(unsigned long ms) {
+  sleptMs += ms;
+}
+
+void Clock_PrepareSleep(uint64_t sleepUs) {
+  ClockRtc rtc;
+  rtc.magic = CLOCK_RTC_MAGIC;
+  rtc.sec = (uint32_t)((Clock_NowMs() + sleepUs / 1000ULL) / 1000ULL);
+  rtc.check = ~(rtc.magic ^ rtc.sec);
+  ESP.rtcUserMemoryWrite(CLOCK_RTC_OFFSET, (uint32_t*)&rtc, sizeof(rtc));
+}
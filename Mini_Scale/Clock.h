@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+#include "Config.h"
+
+// Часы устройства: секунды от первого запуска (реального времени нет).
+// Ход часов переносится через deep sleep: перед сном в RTC-память пишется
+// ожидаемое время пробуждения. После RST/включения питания прошедшее время
+// неизвестно — часы продолжают с момента выключения, Clock_IsExact() = false.
+
+void Clock_Init();                       // Восстановить из RTC-памяти (в начале setup)
+uint32_t Clock_Now();                    // Текущее время, с
+uint64_t Clock_NowMs();                  // Текущее время, мс
+bool Clock_IsExact();                    // Ход не прерывался с последней синхронизации?
+void Clock_AddSleptMs(unsigned long ms); // Учесть forced light sleep (millis() стоит)
+void Clock_PrepareSleep(uint64_t sleepUs); // Перед deep sleep: сохранить время пробуждения (0 — без таймера)
@@ -6,6 +6,12 @@
   #define DEBUG_ENABLED
 #endif
 
+// ===================== Profile =====================
+// Профиль применения (Profiles.h): -DMINI_SCALE_PROFILE=PROFILE_KITCHEN или
+// PROFILE_LAB; без флага — PROFILE_HIVE. Значения ниже с пометкой «профиль»
+// берутся из него.
+#include "Profiles.h"
+
 #ifdef DEBUG_ENABLED
   #define DEBUG_PRINT(x)    Serial.print(x)
   #define DEBUG_PRINTLN(x)  Serial.println(x)
@@ -40,8 +46,8 @@
 #define BRIGHTNESS_HIGH       0xCF
 
 // ===================== Version =====================
-#define FIRMWARE_VERSION          4
-#define PREVIOUS_FIRMWARE_VERSION 3
+#define FIRMWARE_VERSION          6
+#define PREVIOUS_FIRMWARE_VERSION 5
 #define FW_VERSION_STR            "v1.6.0"
 
 // ===================== Defaults =====================
@@ -49,7 +55,7 @@
 
 // ===================== Timers =====================
 #define DEBOUNCE_MS             30
-#define LOOP_DELAY_MS           30
+#define LOOP_DELAY_MS           ScaleProfile::loopDelayMs        // профиль
 #define LOOP_DELAY_IDLE_MS      250
 #define AUTO_OFF_MS             180000UL
 #define AUTO_DIM_MS             60000UL
@@ -57,24 +63,120 @@
 #define CAL_ENTRY_WINDOW_MS     1000UL
 #define CAL_LONG_PRESS_MS       800
 #define CAL_SAVED_MSG_MS        2000
+#define CAL_LOOP_DELAY_MS       10       // шаг loop() в калибровке: опрос кнопки и DOUT
+#define BUTTON_POLL_MS          10       // опрос кнопки в ожидании конверсии HX711
 #define BUTTON_TARE_MS          10000UL
 #define BUTTON_UNDO_MS          15000UL
 #define SUCCESS_MSG_MS          2000
 #define HX711_INIT_DELAY_MS     500
 #define HX711_TIMEOUT_MS        500
 
+// ===================== Power =====================
+// 1 = forced light sleep (wifi_fpm_do_sleep): CPU остановлен до готовности HX711
+// (DOUT=LOW), нажатия кнопки или истечения таймера.
+// 0 = прежний режим: delay() + автоматический modem sleep, CPU тактируется.
+#define POWER_FORCED_LIGHT_SLEEP  1
+#define LIGHT_SLEEP_MIN_MS        10     // короче не засыпаем — вход/выход стоит ~3 мс
+
+// ===================== Adaptive Acquisition =====================
+// При стабильном весе HX711 выключается между короткими сериями измерений
+// (одна серия = HX711_SAMPLES_READ конверсий), интервал растёт по ступеням
+// 1 с -> 5 с -> 30 с. Изменение веса или нажатие кнопки — снова непрерывный опрос.
+// 0 = прежний режим: сон LOOP_DELAY_IDLE_MS между каждыми чтениями.
+#define ACQ_ADAPTIVE_ENABLED      1
+#define ACQ_INTERVAL_1_MS         1000UL
+#define ACQ_INTERVAL_2_MS         5000UL
+#define ACQ_INTERVAL_3_MS         30000UL
+#define ACQ_BURSTS_PER_STEP       5      // стабильных серий до перехода на следующую ступень
+#define ACQ_WAKE_DELTA_KG         0.03f  // отклонение серии от фильтра = вес изменился
+#define SNAPSHOT_SAMPLES          1      // конверсий при сверке со снимком фильтров после deep sleep
+
+// ===================== Power Stats =====================
+// Учёт времени по фазам loop() (ESP.getCycleCount) и оценка расхода в мА·ч.
+// Дамп по запросу: команда p консоли (Console.h). В release-сборке не компилируется.
+#if defined(DEBUG_ENABLED)
+  #define POWER_STATS_ENABLED 1
+#else
+  #define POWER_STATS_ENABLED 0
+#endif
+#define POWER_STATS_DEPTH       4        // максимальная вложенность фаз
+
+// Ток всей платы в каждой фазе, мА (OLED включён, HX711 питается кроме сна)
+#define POWER_MA_OTHER          20.0f
+#define POWER_MA_HX711_WAIT     21.0f
+#define POWER_MA_HX711_READ     21.0f
+#define POWER_MA_FILTER         20.0f
+#define POWER_MA_RENDER         20.0f
+#define POWER_MA_I2C_FLUSH      22.0f
+#define POWER_MA_EEPROM         35.0f
+#define POWER_MA_LIGHT_SLEEP    5.0f
+#define POWER_MA_IDLE_DELAY     19.0f
+#define POWER_MA_BOOST_EXTRA    7.0f     // добавка к току фазы на 160 МГц
+#define BAT_CAPACITY_MAH        1000
+
+// ===================== Loop Stats =====================
+// Блокирующее время итераций loop() — без idle-паузы, light sleep и ожидания HX711:
+// гистограмма, худшие итерации с фазой-виновником, счётчик итераций дольше
+// бюджета. Таблица — команда l консоли, сброс — r (вместе с PowerStats).
+#define LOOP_STATS_ENABLED      POWER_STATS_ENABLED
+#define LOOP_BUDGET_MS          DEBOUNCE_MS  // итерация дольше — перерасход
+#define LOOP_STATS_BUCKETS      16           // корзины по степеням двойки, первая — до 64 мкс
+#define LOOP_STATS_WORST        4            // худших итераций в таблице
+
+// ===================== Telemetry =====================
+// Двоичная телеметрия фильтра веса: запись 24 байта на каждую серию HX711
+// (сырые отсчёты, медиана, EMA, флаги). Вкл/выкл — команда t консоли.
+// Если в TX FIFO UART нет места, запись отбрасывается и считается — loop не ждёт.
+// В release-сборке не компилируется.
+#if defined(DEBUG_ENABLED)
+  #define TELEMETRY_ENABLED   1
+#else
+  #define TELEMETRY_ENABLED   0
+#endif
+
+// ===================== Log =====================
+// Отложенный лог (Log.h): запись — номер сообщения и числа, текст
+// формируется в простое loop. Порог по модулю отсекает вызовы при компиляции.
+// В release-сборке не компилируется.
+#if defined(DEBUG_ENABLED)
+  #define LOG_ENABLED         1
+#else
+  #define LOG_ENABLED         0
+#endif
+#define LOG_LEVEL_NONE          0
+#define LOG_LEVEL_ERROR         1
+#define LOG_LEVEL_WARN          2
+#define LOG_LEVEL_INFO          3
+#define LOG_LEVEL_DEBUG         4
+#define LOG_SCALE_LEVEL         LOG_LEVEL_DEBUG
+#define LOG_BUTTON_LEVEL        LOG_LEVEL_DEBUG
+#define LOG_MEMORY_LEVEL        LOG_LEVEL_DEBUG
+#define LOG_RING_SIZE           32       // записей по 20 байт
+#define LOG_MAX_ARGS            3
+#define LOG_LINE_MAX            96       // строка вывода, включая метку времени
+
+// ===================== CPU Governor =====================
+// 1 = отрисовка кадра и фильтры веса на 160 МГц, всё остальное на 80 МГц.
+// Базовая частота обязана совпадать с частотой сборки (Tools → CPU Frequency).
+#define CPU_GOVERNOR_ENABLED    1
+#define CPU_FREQ_BASE_MHZ       80
+#define CPU_FREQ_BOOST_MHZ      160
+
 #define MENU_HOLD_MS            2000UL
 #define MENU_CONFIRM_WINDOW_MS  3000UL
 
 #define SETTINGS_IDLE_TIMEOUT_MS  30000UL
+#define SETTINGS_TIMEOUT_MSG_MS   1000UL
 #define CAL_IDLE_TIMEOUT_MS       60000UL
 
 // ===================== HX711 =====================
-#define HX711_SAMPLES_STARTUP   10
-#define HX711_SAMPLES_READ      3
+#define HX711_SAMPLES_STARTUP   5
+#define HX711_SAMPLES_READ      ScaleProfile::samplesPerRead     // профиль
+#define HX711_SAMPLES_READ_MAX  16       // предел для команды консоли
 #define HX711_SAMPLES_TARE      10
 #define HX711_SAMPLES_UNDO      5
-#define HX711_SAMPLES_CAL       3
+#define HX711_SAMPLES_CAL       3        // скользящее среднее веса на экране калибровки
+#define HX711_SAMPLES_CAL_POINT 20       // эталонная масса при многоточечной калибровке
 
 // ===================== Battery =====================
 #define BAT_EMA_OLD             0.9f
@@ -97,28 +199,47 @@
 #define WEIGHT_ERROR_THRESHOLD  (-99.0f)
 #define WEIGHT_CHANGE_THRESHOLD 0.05f
 #define WEIGHT_SANE_MAX         500.0f
-#define WEIGHT_EMA_ALPHA        0.3f
-#define WEIGHT_FREEZE_THRESHOLD 0.02f
+#define WEIGHT_EMA_ALPHA        ScaleProfile::emaAlpha           // профиль
+#define WEIGHT_FREEZE_THRESHOLD ScaleProfile::freezeThreshold    // профиль
 #define HX711_ERROR_COUNT_MAX   3
 
-#define MEDIAN_WINDOW           3
+#define MEDIAN_WINDOW           ScaleProfile::medianWindow       // профиль
 
 #define AUTOZERO_THRESHOLD      0.05f
 #define AUTOZERO_STEP           1
 #define AUTOZERO_INTERVAL_MS    3000UL
 #define AUTOZERO_MIN_STABLE_CYCLES 5
 
-#define WEIGHT_OVERLOAD_KG      5.0f
-#define TREND_THRESHOLD         0.03f
+#define WEIGHT_OVERLOAD_KG      ScaleProfile::overloadKg         // профиль
+#define TREND_THRESHOLD         ScaleProfile::trendThreshold     // профиль
+
+// Многоточечная калибровка (команда консоли cal): cal_factor — наклон по
+// эталонным массам, нелинейность датчика — таблица поправки в EEPROM
+#define CAL_POINTS_MAX          8        // эталонных масс за сеанс
+#define CAL_FIT_DEGREE          3        // степень полинома поправки (не выше числа масс)
+#define CAL_LIN_SEGMENTS        16       // отрезков таблицы от 0 до наибольшей массы
+
+// Автокалибровка по одной эталонной массе: отсчёты усредняются, пока СКО
+// среднего не сойдётся (CalSettle); скачок — груз ещё ставят, накопление заново
+#define CAL_AUTO_TARGET_KG      0.0002f  // СКО среднего, при котором замер готов
+#define CAL_AUTO_JUMP_KG        0.02f
+#define CAL_AUTO_MIN_SAMPLES    16
+#define CAL_AUTO_MAX_SAMPLES    300      // ~30 с при 10 SPS — не сошлось, ошибка
+#define CAL_REF_MASS_COUNT      6        // эталонные массы на выбор кнопкой (CalibrationMode.cpp)
+#define CAL_REF_MASS_DEFAULT    3        // 1 кг
 
 // ===================== EEPROM =====================
 #define EEPROM_SLOTS            4
 #define MAGIC_NUMBER            0x2A2B3CUL
 #define CAL_FACTOR_MIN          1.0f
 #define CAL_FACTOR_MAX          100000.0f
-#define STABILITY_WINDOW        8
-#define STABILITY_THRESHOLD     0.03f
+#define STABILITY_WINDOW        ScaleProfile::stabilityWindow    // профиль
+#define STABILITY_THRESHOLD     ScaleProfile::stabilityThreshold // профиль
 #define SERIAL_BAUD             115200
+#define BULK_EXPORT_BAUD        921600   // двоичная выгрузка архива (команда 'x')
+#define BULK_EXPORT_IDLE_MS     3000     // конец сеанса выгрузки без запросов
+#define CONSOLE_LINE_MAX        48       // строка команды консоли, байт
+#define CONSOLE_CSV_RECORDS     8        // строк CSV (h) за один Console_Poll: ~250 байт, ~20 мс на 115200
 #define EEPROM_MIN_INTERVAL_MS  300000UL
 
 // ===================== UI Defaults =====================
@@ -128,9 +249,123 @@
 #define DEFAULT_AUTO_ZERO_ON      1
 #define DEFAULT_UNITS_MODE        0
 #define DEFAULT_TARA_LOCK_ON      0
+#define DEFAULT_HIVE_INTERVAL_MODE 0
 
+#define BRIGHTNESS_VALUES_COUNT   3
 #define AUTO_OFF_VALUES_COUNT     4
 #define AUTO_DIM_VALUES_COUNT     3
+#define HIVE_INTERVAL_VALUES_COUNT 4
+
+// ===================== Hive Mode =====================
+// Автономный режим под ульем: после auto-off устройство просыпается по RTC-таймеру
+// через интервал из настроек, измеряет вес без дисплея и снова засыпает.
+#define HIVE_SAMPLES              3      // конверсий на измерение (медиана), нечётное
+#define HIVE_SETTLE_MS            400    // установление HX711 после power_up (10 SPS)
+
+// ===================== RTC Log =====================
+// Кольцо измерений режима улья в RTC user memory (переживает deep sleep, не RST
+// с отключением питания). Сбрасывается во flash пачкой — когда заполнено или
+// батарея разряжена, а не на каждом пробуждении.
+// Блоки 0..31 RTC user memory заняты OTA ядра Arduino.
+#define RTCLOG_RTC_OFFSET         32     // первый блок кольца (блок = 4 байта)
+#define RTCLOG_CAPACITY           28     // записей по 8 байт
+#define RTCLOG_MAGIC              0x524C4F47UL  // "RLOG"
+#define RTCLOG_VERSION            3      // версия формата записи/заголовка
+#define RRD_RTC_OFFSET            91     // открытые часовой и суточный интервалы (Rrd), 9 блоков
+#define SCALE_RTC_OFFSET          100    // снимок фильтров веса (ScaleControl), 20 блоков
+#define SCALE_RTC_MAGIC           0x464C5432UL  // "FLT2"
+#define UPLINK_RTC_OFFSET         120    // состояние выгрузки по WiFi (Uplink), 5 блоков
+#define UPLINK_RTC_MAGIC          0x55   // "U", версия 1
+#define CLOCK_RTC_OFFSET          125    // 3 блока часов (последние в RTC user memory)
+#define CLOCK_RTC_MAGIC           0x434C4B31UL  // "CLK1"
+
+// ===================== History =====================
+// Архив измерений во flash: кольцо сегментов (сектор 4 КБ = заголовок + 51 блок
+// по 80 байт) в области FS (LittleFS не используется). Блок — сжатая пачка
+// записей (SampleCodec), ровный ряд занимает ~2 байта на запись. Размер выводится
+// из срока хранения поминутного ряда при заниженной оценке записей в блоке
+// плюс сегмент, который стирается при переходе по кругу.
+#define HISTORY_RETENTION_DAYS    90
+#define HISTORY_RECORDS_PER_DAY   1440
+#define HISTORY_BLOCK_SIZE        80     // байт, кратно 4, делит 4080 без остатка
+#define HISTORY_BLOCK_RECORDS_EST 24     // записей в блоке для расчёта размера
+#define HISTORY_MAGIC             0x48495354UL  // "HIST"
+#define HISTORY_VERSION           2
+
+// ===================== Uplink =====================
+// Пакетная выгрузка архива по WiFi в режиме улья: замеры копятся как обычно,
+// радио включается раз в окно UPLINK_WINDOW_SEC и отправляет всё новое одним
+// HTTP POST (сжатые блоки SampleCodec), затем выключается. Неудача — повтор
+// через UPLINK_RETRY_MIN_SEC с удвоением до окна, неотправленное не теряется.
+// 0 — радио не включается никогда (как раньше).
+#define UPLINK_ENABLED            0
+#define UPLINK_SSID               ""
+#define UPLINK_PASS               ""
+#define UPLINK_HOST               "192.168.1.10"
+#define UPLINK_PORT               8080
+#define UPLINK_PATH               "/hive"
+#define UPLINK_WINDOW_SEC         3600UL
+#define UPLINK_RETRY_MIN_SEC      300UL
+#define UPLINK_CONNECT_MS         8000   // ассоциация с точкой доступа + DHCP
+#define UPLINK_RESPONSE_MS        5000   // ответ сервера после отправки
+#define UPLINK_MAX_BLOCKS         64     // блоков архива в одном POST (~5 КБ)
+#define UPLINK_POLL_MS            5      // пауза Uplink_Run между шагами в ожидании сети
+
+// ===================== RRD =====================
+// Агрегаты веса (min/max/mean/count) по минутам, часам и суткам — каждый
+// уровень в своём кольце во flash сразу за архивом. Закрытый интервал
+// пишется один раз (16 байт), открытые часовой и суточный живут в RTC.
+#define RRD_MINUTE_KEEP_HOURS     24
+#define RRD_HOUR_KEEP_DAYS        90
+#define RRD_DAY_KEEP_DAYS         730
+#define RRD_VERSION               1
+#define RRD_MINUTE_MAGIC          0x5252444DUL  // "RRDM"
+#define RRD_HOUR_MAGIC            0x52524448UL  // "RRDH"
+#define RRD_DAY_MAGIC             0x52524444UL  // "RRDD"
+#define RRD_REPORT_DAYS           30     // суток в отчёте по команде 'd'
 
 // ===================== Smart Start =====================
 #define SMART_START_MIN_DELTA     0.05f   // минимальная разница для показа (кг)
+
+// ===================== Boot =====================
+// Заставка и Smart Start показываются баннером поверх живого экрана веса,
+// setup() их не ждёт.
+#define SPLASH_BANNER_MS          1500UL  // версия прошивки после старта
+#define SMART_START_BANNER_MS     3000UL  // дельта веса с прошлого выключения
+
+// Таблица времени этапов загрузки (micros() от сброса). Дамп по команде b консоли.
+#if defined(DEBUG_ENABLED)
+  #define BOOT_TRACE_ENABLED  1
+#else
+  #define BOOT_TRACE_ENABLED  0
+#endif
+#define BOOT_TRACE_MAX            12     // максимум отметок
+
+// ===================== RAM =====================
+// Долгоживущие буферы — только статические: после setup() прошивка кучу не
+// трогает, она остаётся WiFi и lwIP выгрузки. Строки и таблицы — во flash
+// (PROGMEM). Каждая строка бюджета проверяется static_assert по sizeof в своём
+// модуле, сумма с запасом под архив и телеметрию — ниже. Размеры — для
+// выпускной сборки, BootTrace и PowerStats (DEBUG) сверх бюджета.
+// Минимумы свободной кучи и стека за работу — команда mem консоли (RamStats.h).
+#define RAM_FRAME_BYTES       (SCREEN_WIDTH * ((SCREEN_HEIGHT + 7) / 8))  // кадр SSD1306
+#define RAM_LOG_BYTES         (LOG_RING_SIZE * (8 + 4 * LOG_MAX_ARGS))    // кольцо Log
+#define RAM_RTCLOG_BYTES      (RTCLOG_CAPACITY * 8)                       // копия журнала RTC
+#define RAM_SETTINGS_BYTES    288    // savedData и снимок последнего сохранения
+#define RAM_BULK_RX_BYTES     128    // приёмный кадр BulkExport
+#define RAM_CONSOLE_BYTES     (CONSOLE_LINE_MAX + 1 + CAL_POINTS_MAX * 8 + 24 + \
+                               HISTORY_BLOCK_SIZE + 64) // строка, точки и замер калибровки, курсор CSV
+#define RAM_UPLINK_BYTES      80     // сеанс выгрузки по WiFi: пачка, строка статуса
+#define RAM_PIPELINE_BYTES    160    // цепочка фильтров веса (больше всех — профиль lab)
+#define RAM_RRD_BYTES         160    // кольца и открытые интервалы RRD
+#define RAM_BUFFERS_BYTES     (RAM_FRAME_BYTES + RAM_LOG_BYTES + RAM_RTCLOG_BYTES + \
+                               RAM_SETTINGS_BYTES + RAM_BULK_RX_BYTES + RAM_CONSOLE_BYTES + \
+                               RAM_PIPELINE_BYTES + RAM_RRD_BYTES + RAM_UPLINK_BYTES)
+#define RAM_RESERVE_HISTORY   (4 * HISTORY_BLOCK_SIZE)  // кэш блоков архива
+#define RAM_RESERVE_TELEMETRY (32 * 24)                 // кольцо записей телеметрии
+#define RAM_STATIC_BUDGET     4096
+#define RAM_HEAP_LOW_BYTES    16384  // меньше свободной кучи — WiFi-выгрузка под угрозой
+#define RAM_STACK_LOW_BYTES   1024   // меньше свободного стека loop() (4 КБ) — на грани
+
+static_assert(RAM_BUFFERS_BYTES + RAM_RESERVE_HISTORY + RAM_RESERVE_TELEMETRY <= RAM_STATIC_BUDGET,
+              "static buffers and reserves exceed RAM_STATIC_BUDGET");
@@ -0,0 +1,580 @@
+#include "Console.h"
+#include "MemoryControl.h"
+#include "ScaleControl.h"
+#include "BatteryControl.h"
+#include "SettingsMode.h"
+#include "RtcLog.h"
+#include "HistoryStore.h"
+#include "BulkExport.h"
+#include "Rrd.h"
+#include "Clock.h"
+#include "BootTrace.h"
+#include "Telemetry.h"
+#include "PowerStats.h"
+#include "Uplink.h"
+#include "CalFit.h"
+#include "RamStats.h"
+#include "LoopStats.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ===== Буфер строки =====
+static char    line[CONSOLE_LINE_MAX + 1];
+static uint8_t lineLen      = 0;
+static bool    lineOverflow = false;   // Строка длиннее буфера — отбросить до конца строки
+static bool    settingsChanged = false;
+
+// ===== Эталонные массы сеанса многоточечной калибровки =====
+static CalPoint calPoints[CAL_POINTS_MAX];
+static uint8_t  calCount = 0;
+static long     calZero = 0;   // offset тары на первой точке — ноль таблицы поправки
+
+// ===== Долгие команды в loop() =====
+// Ни одна команда не держит loop(): cal add и cal auto отдают конверсии замеру
+// (Console_Measure), h, x и uplink идут по шагу за Console_Poll. Ответ — по
+// завершении; пока задача идёт, остальные команды — ERR busy.
+enum ConsoleJob : uint8_t { JOB_NONE, JOB_CAL_ADD, JOB_CAL_AUTO, JOB_CSV, JOB_BULK, JOB_UPLINK };
+static ConsoleJob    job = JOB_NONE;
+static CalSettle     calSettle;
+static float         calJobKg = 0.0f;
+static unsigned long calJobSampleAt = 0;   // последняя конверсия: HX711 молчит — ошибка
+static HistoryCursor csvCursor;            // h: следующая запись архива
+static uint32_t      csvCount = 0;
+static_assert(sizeof(line) + sizeof(calPoints) + sizeof(calSettle) + sizeof(csvCursor)
+                  <= RAM_CONSOLE_BYTES,
+              "console buffers are over their RAM budget line");
+
+// ===== Таблица полей EEPROM_Data =====
+// Целиком во flash: имя, тип, смещение в структуре и допустимый диапазон.
+enum FieldType : uint8_t { FT_U8, FT_U16, FT_U32, FT_LONG, FT_FLOAT };
+
+// Что применить после set
+enum FieldApply : uint8_t {
+  FA_READONLY,   // Служебное поле — только чтение
+  FA_NONE,       // Действует при следующем использовании
+  FA_SETTINGS,   // ApplySettings() + таймеры и единицы в loop()
+  FA_OFFSET,     // Scale_ApplyCalibration
+  FA_SCALE,      // Scale_ApplyCalibration, поправка линейности сбрасывается
+};
+
+struct ConsoleField {
+  const char* name;
+  uint8_t type;
+  uint8_t offset;
+  uint8_t apply;
+  float minValue;
+  float maxValue;
+};
+
+#define CF_NAME(field) static const char cfName_##field[] PROGMEM = #field;
+#define CF_ENTRY(field, type, apply, lo, hi) \
+  { cfName_##field, type, (uint8_t)offsetof(EEPROM_Data, field), apply, lo, hi },
+
+#define CONSOLE_FIELDS(X) \
+  X(magic_key,          FT_U32,   FA_READONLY, 0, 0) \
+  X(version,            FT_U8,    FA_READONLY, 0, 0) \
+  X(slot_seq,           FT_U8,    FA_READONLY, 0, 0) \
+  X(tare_offset,        FT_LONG,  FA_OFFSET,   -8388608.0f, 8388607.0f) \
+  X(backup_offset,      FT_LONG,  FA_NONE,     -8388608.0f, 8388607.0f) \
+  X(last_weight,        FT_FLOAT, FA_NONE,     -WEIGHT_SANE_MAX, WEIGHT_SANE_MAX) \
+  X(cal_factor,         FT_FLOAT, FA_SCALE,    CAL_FACTOR_MIN, CAL_FACTOR_MAX) \
+  X(backup_last_weight, FT_FLOAT, FA_NONE,     -WEIGHT_SANE_MAX, WEIGHT_SANE_MAX) \
+  X(brightness_level,   FT_U8,    FA_SETTINGS, 0, BRIGHTNESS_VALUES_COUNT - 1) \
+  X(auto_off_mode,      FT_U8,    FA_SETTINGS, 0, AUTO_OFF_VALUES_COUNT - 1) \
+  X(auto_dim_mode,      FT_U8,    FA_SETTINGS, 0, AUTO_DIM_VALUES_COUNT - 1) \
+  X(auto_zero_on,       FT_U8,    FA_SETTINGS, 0, 1) \
+  X(units_mode,         FT_U8,    FA_SETTINGS, 0, 1) \
+  X(tara_lock_on,       FT_U8,    FA_SETTINGS, 0, 1) \
+  X(hive_interval_mode, FT_U8,    FA_SETTINGS, 0, HIVE_INTERVAL_VALUES_COUNT - 1) \
+  X(lin_zero,           FT_LONG,  FA_READONLY, 0, 0) \
+  X(lin_span,           FT_FLOAT, FA_READONLY, 0, 0) \
+  X(crc16,              FT_U16,   FA_READONLY, 0, 0)
+
+#define CF_NAME_X(field, type, apply, lo, hi) CF_NAME(field)
+CONSOLE_FIELDS(CF_NAME_X)
+
+static const ConsoleField fields[] PROGMEM = {
+  CONSOLE_FIELDS(CF_ENTRY)
+};
+static const uint8_t FIELD_COUNT = sizeof(fields) / sizeof(fields[0]);
+
+// Параметры фильтра: не в EEPROM, обрабатываются отдельно
+enum RuntimeParam : uint8_t { RP_EMA, RP_SAMPLES, RP_RATE, RP_COUNT };
+static const char runtimeNames[RP_COUNT][8] PROGMEM = { "ema", "samples", "rate" };
+
+static int findField(const char* name) {
+  for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+    if (strcmp_P(name, (const char*)pgm_read_ptr(&fields[i].name)) == 0) return i;
+  }
+  return -1;
+}
+
+static int findRuntime(const char* name) {
+  for (uint8_t i = 0; i < RP_COUNT; i++) {
+    if (strcmp_P(name, runtimeNames[i]) == 0) return i;
+  }
+  return -1;
+}
+
+// ===== Вывод значений =====
+
+static void printField(Print& out, uint8_t idx) {
+  char name[24];
+  strncpy_P(name, (const char*)pgm_read_ptr(&fields[idx].name), sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+  const uint8_t* p = (const uint8_t*)&savedData + pgm_read_byte(&fields[idx].offset);
+  switch (pgm_read_byte(&fields[idx].type)) {
+    case FT_U8:  out.printf("%s=%u\n", name, *p); break;
+    case FT_U16: { uint16_t v; memcpy(&v, p, sizeof(v)); out.printf("%s=%u\n", name, v); break; }
+    case FT_U32: { uint32_t v; memcpy(&v, p, sizeof(v)); out.printf("%s=0x%06lX\n", name, (unsigned long)v); break; }
+    case FT_LONG: { long v; memcpy(&v, p, sizeof(v)); out.printf("%s=%ld\n", name, v); break; }
+    default: { float v; memcpy(&v, p, sizeof(v)); out.printf("%s=%.4f\n", name, v); break; }
+  }
+}
+
+static void printRuntime(Print& out, uint8_t idx) {
+  switch (idx) {
+    case RP_EMA:     out.printf("ema=%.3f\n", Scale_GetEmaAlpha()); break;
+    case RP_SAMPLES: out.printf("samples=%u\n", Scale_GetSamplesPerRead()); break;
+    default:
+      if (Scale_GetAdaptiveAcquisition()) out.print(F("rate=auto\n"));
+      else out.printf("rate=%lu\n", Scale_GetFixedIntervalMs());
+      break;
+  }
+}
+
+// ===== Разбор чисел =====
+
+static bool parseLong(const char* s, long* v) {
+  char* end;
+  *v = strtol(s, &end, 0);
+  return end != s && *end == '\0';
+}
+
+static bool parseFloat(const char* s, float* v) {
+  char* end;
+  *v = (float)strtod(s, &end);
+  return end != s && *end == '\0' && !isnan(*v) && !isinf(*v);
+}
+
+// ===== Команды =====
+
+static void cmdGet(Print& out, const char* name) {
+  if (name == nullptr) {
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) printField(out, i);
+    for (uint8_t i = 0; i < RP_COUNT; i++) printRuntime(out, i);
+    return;
+  }
+  int f = findField(name);
+  if (f >= 0) {
+    printField(out, (uint8_t)f);
+    return;
+  }
+  int r = findRuntime(name);
+  if (r >= 0) printRuntime(out, (uint8_t)r);
+  else out.print(F("ERR unknown field\n"));
+}
+
+static bool setRuntime(uint8_t idx, const char* value) {
+  float f;
+  long n;
+  switch (idx) {
+    case RP_EMA:
+      if (!parseFloat(value, &f) || f <= 0.0f || f > 1.0f) return false;
+      Scale_SetEmaAlpha(f);
+      return true;
+    case RP_SAMPLES:
+      if (!parseLong(value, &n) || n < 1 || n > HX711_SAMPLES_READ_MAX) return false;
+      Scale_SetSamplesPerRead((uint8_t)n);
+      return true;
+    default:
+      if (strcmp(value, "auto") == 0) {
+        Scale_SetAdaptiveAcquisition(true);
+        return true;
+      }
+      if (!parseLong(value, &n) || n < LOOP_DELAY_IDLE_MS || n > (long)ACQ_INTERVAL_3_MS) return false;
+      Scale_SetFixedIntervalMs((unsigned long)n);
+      Scale_SetAdaptiveAcquisition(false);
+      return true;
+  }
+}
+
+static bool setField(uint8_t idx, const char* value) {
+  uint8_t type = pgm_read_byte(&fields[idx].type);
+  float lo = pgm_read_float(&fields[idx].minValue);
+  float hi = pgm_read_float(&fields[idx].maxValue);
+  uint8_t* p = (uint8_t*)&savedData + pgm_read_byte(&fields[idx].offset);
+  if (type == FT_FLOAT) {
+    float v;
+    if (!parseFloat(value, &v) || v < lo || v > hi) return false;
+    memcpy(p, &v, sizeof(v));
+  } else {
+    long v;
+    if (!parseLong(value, &v) || v < (long)lo || v > (long)hi) return false;
+    if (type == FT_U8) *p = (uint8_t)v;
+    else memcpy(p, &v, sizeof(v));   // FT_LONG: прочие целые поля только для чтения
+  }
+
+  switch (pgm_read_byte(&fields[idx].apply)) {
+    case FA_SETTINGS:
+      ApplySettings();
+      settingsChanged = true;
+      break;
+    case FA_OFFSET:
+      Scale_ApplyCalibration();
+      break;
+    case FA_SCALE:
+      savedData.lin_span = 0.0f;
+      Scale_ApplyCalibration();
+      break;
+  }
+  Memory_MarkDirty();
+  return true;
+}
+
+static void cmdSet(Print& out, const char* name, const char* value) {
+  if (name == nullptr || value == nullptr) {
+    out.print(F("ERR usage: set <field> <value>\n"));
+    return;
+  }
+  int f = findField(name);
+  int r = f < 0 ? findRuntime(name) : -1;
+  if (f < 0 && r < 0) {
+    out.print(F("ERR unknown field\n"));
+    return;
+  }
+  if (f >= 0 && pgm_read_byte(&fields[f].apply) == FA_READONLY) {
+    out.print(F("ERR read-only\n"));
+    return;
+  }
+  bool ok = f >= 0 ? setField((uint8_t)f, value) : setRuntime((uint8_t)r, value);
+  if (!ok) {
+    out.print(F("ERR bad value\n"));
+    return;
+  }
+  out.print(F("OK "));
+  if (f >= 0) printField(out, (uint8_t)f);
+  else printRuntime(out, (uint8_t)r);
+}
+
+static void cmdStats(Print& out) {
+  out.printf("weight=%.3f display=%.3f stable=%d overload=%d trend=%d\n",
+             Scale_GetWeight(), Scale_GetDisplayWeight(), Scale_IsStable(), Scale_IsOverloaded(),
+             Scale_GetTrend());
+  out.printf("hx711 interval=%lu ms adaptive=%d ema=%.3f samples=%u\n",
+             Scale_GetIdleIntervalMs(), Scale_GetAdaptiveAcquisition(),
+             Scale_GetEmaAlpha(), Scale_GetSamplesPerRead());
+  out.printf("battery=%.2f V %d%%\n", Battery_GetVoltage(), Battery_GetPercent());
+  out.printf("uptime=%lu ms light_sleep=%lu ms clock=%lu\n",
+             millis(), Scale_GetSleepMs(), (unsigned long)Clock_Now());
+  UplinkStats up;
+  Uplink_GetStats(&up);
+  out.printf("uplink enabled=%d sent=%lu radio=%lu ms next=%lu failures=%u\n",
+             Uplink_Enabled(), (unsigned long)up.samples, (unsigned long)up.radioMs,
+             (unsigned long)up.nextTs, up.failures);
+}
+
+// Итог cal add: среднее HX711_SAMPLES_CAL_POINT конверсий — точка таблицы
+static void finishAdd(Print& out) {
+  float counts = (float)calSettle.mean;
+  if (calCount == 0) calZero = Scale_GetOffset();
+  calPoints[calCount].counts = counts - (float)calZero;
+  calPoints[calCount].kg = calJobKg;
+  calCount++;
+  out.printf("OK cal %u: %.3f kg counts=%.1f\n", calCount, calJobKg, counts - (float)calZero);
+}
+
+// Итог cal auto: ноль — текущая тара, масса — calJobKg
+static void finishAuto(Print& out, CalSettleStatus st) {
+  if (st != SETTLE_DONE) {
+    out.print(F("ERR not settled\n"));
+    return;
+  }
+  float factor = (float)((calSettle.mean - (double)Scale_GetOffset()) / calJobKg);
+  if (!(factor >= CAL_FACTOR_MIN && factor <= CAL_FACTOR_MAX)) {
+    out.print(F("ERR factor\n"));
+    return;
+  }
+  savedData.cal_factor = factor;
+  savedData.lin_span = 0.0f;
+  Scale_ApplyCalibration();
+  Memory_ForceSave();
+  out.printf("OK cal_factor=%.4f +-%.1f g n=%u\n", factor,
+             CalSettle_StdErr(&calSettle) / factor * 1000.0f, calSettle.n);
+}
+
+// Многоточечная калибровка: тара на пустой платформе, затем cal add <кг>
+// для каждой эталонной массы и cal fit; cal auto <кг> — по одной массе
+static void cmdCal(Print& out, const char* sub, const char* value) {
+  if (sub == nullptr) {
+    out.printf("cal zero=%ld points=%u lin_span=%.4f\n", calZero, calCount, savedData.lin_span);
+    for (uint8_t i = 0; i < calCount; i++) {
+      out.printf("cal %u: %.3f kg counts=%.1f\n", i + 1, calPoints[i].kg, calPoints[i].counts);
+    }
+    return;
+  }
+  if (strcmp(sub, "add") == 0) {
+    float kg;
+    if (value == nullptr || !parseFloat(value, &kg) || kg <= 0.0f || kg > WEIGHT_SANE_MAX) {
+      out.print(F("ERR usage: cal add <kg>\n"));
+      return;
+    }
+    if (calCount >= CAL_POINTS_MAX) {
+      out.print(F("ERR cal full\n"));
+      return;
+    }
+    CalSettle_Reset(&calSettle);
+    calJobKg = kg;
+    calJobSampleAt = millis();
+    job = JOB_CAL_ADD;
+  } else if (strcmp(sub, "fit") == 0) {
+    CalFitResult fit;
+    if (!CalFit_Solve(calPoints, calCount, &fit)) {
+      out.print(F("ERR fit\n"));
+      return;
+    }
+    savedData.cal_factor = fit.calFactor;
+    savedData.lin_zero = calZero;
+    savedData.lin_span = fit.span;
+    memcpy(savedData.lin_knots, fit.knots, sizeof(savedData.lin_knots));
+    Scale_ApplyCalibration();
+    Memory_ForceSave();
+    out.printf("OK cal_factor=%.4f degree=%u error=%.1f g linear=%.1f g\n", fit.calFactor,
+               fit.degree, fit.maxErrorKg * 1000.0f, fit.linearErrorKg * 1000.0f);
+  } else if (strcmp(sub, "auto") == 0) {
+    // Одна эталонная масса: усреднение до сходимости, ноль — текущая тара
+    float kg;
+    if (value == nullptr || !parseFloat(value, &kg) || kg <= 0.0f || kg > WEIGHT_SANE_MAX) {
+      out.print(F("ERR usage: cal auto <kg>\n"));
+      return;
+    }
+    CalSettle_Reset(&calSettle);
+    calJobKg = kg;
+    calJobSampleAt = millis();
+    job = JOB_CAL_AUTO;
+  } else if (strcmp(sub, "clear") == 0) {
+    calCount = 0;
+    out.print(F("OK\n"));
+  } else if (strcmp(sub, "off") == 0) {
+    savedData.lin_span = 0.0f;
+    Scale_ApplyCalibration();
+    Memory_ForceSave();
+    out.print(F("OK\n"));
+  } else {
+    out.print(F("ERR usage: cal [add <kg>|fit|clear|off|auto <kg>]\n"));
+  }
+}
+
+// Итог выгрузки по WiFi
+static void printUplink(Print& out, UplinkResult r) {
+  UplinkStats up;
+  Uplink_GetStats(&up);
+  if (r == UPLINK_OK) {
+    out.printf("OK sent=%lu radio=%lu ms\n", (unsigned long)up.samples, (unsigned long)up.radioMs);
+  } else {
+    out.printf("ERR uplink %u, retry at %lu\n", r, (unsigned long)up.nextTs);
+  }
+}
+
+// Выгрузка по WiFi сейчас, вне расписания окна: сеанс дальше ведёт Console_Poll
+static void cmdUplink(Print& out) {
+  UplinkResult r;
+  if (Uplink_Begin(Uplink_WifiTransport(), Clock_Now(), true, &r)) {
+    job = JOB_UPLINK;
+  } else {
+    printUplink(out, r);
+  }
+}
+
+static void cmdHelp(Print& out) {
+  out.print(F("get [field] | set <field> <value> | save | tare | undo | stats | mem | uplink\n"));
+  out.print(F("cal [add <kg>|fit|clear|off]: multi-point calibration, tare empty first\n"));
+  out.print(F("cal auto <kg>: one reference mass, averaged until settled\n"));
+  out.print(F("fields: EEPROM_Data names; runtime: ema, samples, rate (ms|auto)\n"));
+  out.print(F("h csv | x bulk | d daily | p/r power | l loop latency | b boot | t telemetry\n"));
+}
+
+// Односимвольные команды прежнего интерфейса
+static bool runLetter(Stream& io, char c) {
+  switch (c) {
+    case 'h':
+      RtcLog_Load();
+      RtcLog_Flush();   // выгрузка должна видеть и ещё не сброшенные измерения
+      History_CsvBegin(io, &csvCursor);
+      csvCount = 0;
+      job = JOB_CSV;
+      return true;
+    case 'x':
+      BulkExport_Begin();
+      job = JOB_BULK;
+      return true;
+    case 'd': {
+      uint32_t now = Clock_Now();
+      uint32_t span = RRD_REPORT_DAYS * Rrd_Period(RRD_DAY);
+      Rrd_ExportCsv(io, RRD_DAY, now > span ? now - span : 0);
+      return true;
+    }
+#if BOOT_TRACE_ENABLED
+    case 'b':
+      BootTrace_Dump();
+      return true;
+#endif
+#if TELEMETRY_ENABLED
+    case 't':
+      Telemetry_Toggle();
+      return true;
+#endif
+#if POWER_STATS_ENABLED
+    case 'p':
+      PowerStats_Dump();
+      io.printf("[PWR] light sleep total %lu ms\n", Scale_GetSleepMs());
+      return true;
+    case 'r':
+      PowerStats_Init();
+      LoopStats_Init();
+      return true;
+#endif
+#if LOOP_STATS_ENABLED
+    case 'l':
+      LoopStats_Dump(io);
+      return true;
+#endif
+  }
+  return false;
+}
+
+static void execute(Stream& io) {
+  char* save = nullptr;
+  char* cmd = strtok_r(line, " \t", &save);
+  if (cmd == nullptr) return;
+  char* arg1 = strtok_r(nullptr, " \t", &save);
+  char* arg2 = strtok_r(nullptr, " \t", &save);
+
+  if (job != JOB_NONE) {
+    io.print(F("ERR busy\n"));
+    return;
+  }
+  if (cmd[1] == '\0' && arg1 == nullptr && runLetter(io, cmd[0])) return;
+
+  if (strcmp(cmd, "get") == 0) {
+    cmdGet(io, arg1);
+  } else if (strcmp(cmd, "set") == 0) {
+    cmdSet(io, arg1, arg2);
+  } else if (strcmp(cmd, "save") == 0) {
+    Memory_ForceSave();
+    io.print(F("OK\n"));
+  } else if (strcmp(cmd, "tare") == 0) {
+    io.print(Scale_Tare() ? F("OK\n") : F("ERR tare failed\n"));
+  } else if (strcmp(cmd, "undo") == 0) {
+    io.print(Scale_UndoTare() ? F("OK\n") : F("ERR no undo\n"));
+  } else if (strcmp(cmd, "stats") == 0) {
+    cmdStats(io);
+  } else if (strcmp(cmd, "mem") == 0) {
+    RamStats_Report(io);
+  } else if (strcmp(cmd, "cal") == 0) {
+    cmdCal(io, arg1, arg2);
+  } else if (strcmp(cmd, "uplink") == 0) {
+    cmdUplink(io);
+  } else if (strcmp(cmd, "help") == 0) {
+    cmdHelp(io);
+  } else {
+    io.print(F("ERR unknown command\n"));
+  }
+}
+
+// Шаг выгрузки h / uplink
+static void stepJob(Print& out) {
+  if (job == JOB_CSV) {
+    uint8_t n = History_CsvStep(out, &csvCursor, CONSOLE_CSV_RECORDS);
+    csvCount += n;
+    if (n > 0) return;
+    job = JOB_NONE;
+    out.printf("# %lu records\n", (unsigned long)csvCount);
+  } else if (job == JOB_UPLINK) {
+    UplinkResult r;
+    if (Uplink_Step(Uplink_WifiTransport(), &r) != UPLINK_STEP_DONE) return;
+    job = JOB_NONE;
+    printUplink(out, r);
+  }
+}
+
+// Только то, что уже в приёмном буфере: без ожидания конца строки
+void Console_Poll(Stream& io) {
+  // Двоичный сеанс x: входные байты — запросы протокола, не команды
+  if (job == JOB_BULK) {
+    if (!BulkExport_Step()) job = JOB_NONE;
+    return;
+  }
+  while (io.available() > 0) {
+    int c = io.read();
+    if (c < 0) break;
+    if (c == '\r' || c == '\n') {
+      if (lineOverflow) {
+        io.print(F("ERR line too long\n"));
+      } else if (lineLen > 0) {
+        line[lineLen] = '\0';
+        execute(io);
+      }
+      lineLen = 0;
+      lineOverflow = false;
+    } else if (c == '\b' || c == 0x7F) {
+      if (lineLen > 0) lineLen--;
+    } else if (lineLen < CONSOLE_LINE_MAX) {
+      line[lineLen++] = (char)c;
+    } else {
+      lineOverflow = true;
+    }
+  }
+  stepJob(io);
+}
+
+bool Console_IsMeasuring() {
+  return job == JOB_CAL_ADD || job == JOB_CAL_AUTO;
+}
+
+bool Console_IsBusy() {
+  return job != JOB_NONE;
+}
+
+// cal add — среднее HX711_SAMPLES_CAL_POINT конверсий. cal auto — отсчёты до
+// сходимости: СКО среднего <= CAL_AUTO_TARGET_KG или не больше CAL_AUTO_MAX_SAMPLES
+// конверсий; пересчёт порогов в отсчёты — по текущему cal_factor, для порогов
+// достаточно и грубого коэффициента. Нажатие кнопки — отмена.
+void Console_Measure(Print& out) {
+  if (!Console_IsMeasuring()) return;
+  if (digitalRead(BUTTON_PIN) == LOW) {
+    job = JOB_NONE;
+    out.print(F("ERR cancelled\n"));
+    return;
+  }
+  long counts;
+  if (!Scale_PollCounts(&counts)) {
+    if (millis() - calJobSampleAt >= HX711_TIMEOUT_MS) {
+      job = JOB_NONE;
+      out.print(F("ERR hx711\n"));
+    }
+    return;
+  }
+  calJobSampleAt = millis();
+  if (job == JOB_CAL_ADD) {
+    CalSettle_Add(&calSettle, counts);
+    if (calSettle.n < HX711_SAMPLES_CAL_POINT) return;
+    job = JOB_NONE;
+    finishAdd(out);
+    return;
+  }
+  float factor = Scale_GetCalFactor();
+  CalSettleStatus st = CalSettle_Feed(&calSettle, counts, CAL_AUTO_JUMP_KG * factor,
+                                      CAL_AUTO_TARGET_KG * factor);
+  if (st == SETTLE_BUSY) return;
+  job = JOB_NONE;
+  finishAuto(out, st);
+}
+
+bool Console_TakeSettingsChanged() {
+  bool changed = settingsChanged;
+  settingsChanged = false;
+  return changed;
+}
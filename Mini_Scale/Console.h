@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Строковая консоль в Serial: байты копятся в буфере строки каждый loop без
+// ожидания, команда выполняется по '\r' или '\n'.
+//
+//   help                  — список команд
+//   get [поле]            — поля EEPROM_Data и параметры фильтра (все или одно)
+//   set <поле> <значение> — изменить; сохранение в EEPROM отложенное (Memory_Save)
+//   save                  — сохранить в EEPROM сейчас
+//   tare / undo           — тарирование и отмена
+//   stats                 — вес, стабильность, опрос HX711, батарея, сон, выгрузка
+//   mem                   — бюджет RAM, минимумы свободной кучи и стека (RamStats.h)
+//   uplink                — выгрузить архив по WiFi сейчас (Uplink.h)
+//   cal [add <кг>|fit|clear|off] — многоточечная калибровка (CalFit.h): тара на
+//                           пустой платформе, add для каждой эталонной массы, fit —
+//                           cal_factor и поправка линейности в EEPROM; off — без поправки
+//   cal auto <кг>         — по одной эталонной массе на таре: усреднение до сходимости
+//                           (CalSettle), cal_factor и СКО результата в граммах
+// Замер cal add / cal auto идёт в loop() (Console_Measure), ответ — по его окончании;
+// до него другие команды — "ERR busy", кнопка — отмена. Выгрузки h, x и uplink так
+// же не держат loop(): шаг за Console_Poll (h — CONSOLE_CSV_RECORDS строк), до
+// конца выгрузки — "ERR busy"; в сеансе x входные байты — протокол BulkExport.
+//
+// Параметры фильтра (не сохраняются): ema — коэффициент EMA, samples —
+// конверсий на чтение, rate — период опроса в мс или auto (адаптивный).
+//
+// Односимвольные команды — строкой из одного символа:
+//   h — архив измерений в CSV, в конце "# N records"
+//   x — двоичная выгрузка архива (BulkExport, хост: host/build/bulk_reader)
+//   d — суточные агрегаты за RRD_REPORT_DAYS суток: min/max/среднее и прирост
+//   p — таблица времени и расхода по фазам, r — сброс счётчиков (debug)
+//   l — гистограмма времени итераций loop(), худшие с фазой-виновником,
+//       перерасход LOOP_BUDGET_MS (LoopStats.h, debug; сброс — r)
+//   b — время этапов загрузки (debug)
+//   t — двоичная телеметрия фильтра веса вкл/выкл (debug, host/build/telemetry_decode)
+//
+// Ответ: "name=value" на get, "OK ..." или "ERR <причина>".
+
+void Console_Poll(Stream& io);        // Разобрать всё, что есть во входном буфере, шаг выгрузки
+bool Console_TakeSettingsChanged();   // Настройки loop() изменены командой set (со сбросом)
+bool Console_IsMeasuring();           // Идёт замер калибровки — конверсии HX711 его
+bool Console_IsBusy();                // Идёт долгая команда (замер или выгрузка) — без light sleep
+void Console_Measure(Print& out);     // Шаг замера: готовая конверсия без ожидания, ответ по окончании
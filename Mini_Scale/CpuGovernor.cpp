@@ -0,0 +1,62 @@
+#include "CpuGovernor.h"
+
+#if CPU_GOVERNOR_ENABLED
+
+#include <Arduino.h>
+#include "PowerStats.h"
+extern "C" {
+  #include "user_interface.h"
+}
+
+// Тайминги Wire и HX711 рассчитаны на частоту сборки — она и есть базовая
+#if F_CPU != (CPU_FREQ_BASE_MHZ * 1000000L)
+  #error "CPU_FREQ_BASE_MHZ должна совпадать с частотой сборки (F_CPU)"
+#endif
+
+// Глубина вложенных участков ускорения и удержания базовой частоты
+static uint8_t boostDepth = 0;
+static uint8_t baseDepth  = 0;
+// Частота, установленная последней
+static uint8_t currentMHz = CPU_FREQ_BASE_MHZ;
+
+// Привести частоту к требуемой: 160 МГц только если есть ускорение и нет удержания
+static void apply() {
+  uint8_t want = (boostDepth > 0 && baseDepth == 0) ? CPU_FREQ_BOOST_MHZ : CPU_FREQ_BASE_MHZ;
+  if (want == currentMHz) return;
+  PowerStats_OnCpuFreqChange(); // начислить такты по старой частоте
+  system_update_cpu_freq(want);
+  currentMHz = want;
+}
+
+void CpuGov_Init() {
+  boostDepth = 0;
+  baseDepth  = 0;
+  currentMHz = system_get_cpu_freq();
+  apply();
+}
+
+void CpuGov_BoostBegin() {
+  boostDepth++;
+  apply();
+}
+
+void CpuGov_BoostEnd() {
+  if (boostDepth > 0) boostDepth--;
+  apply();
+}
+
+void CpuGov_HoldBaseBegin() {
+  baseDepth++;
+  apply();
+}
+
+void CpuGov_HoldBaseEnd() {
+  if (baseDepth > 0) baseDepth--;
+  apply();
+}
+
+uint8_t CpuGov_GetMHz() {
+  return currentMHz;
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include "Config.h"
+
+// Регулятор частоты CPU. Базовая частота — 80 МГц (частота сборки); короткие
+// вычислительные участки (отрисовка кадра, фильтры веса) выполняются на 160 МГц
+// и быстрее возвращают CPU в сон.
+//
+// Участки с программным вводом-выводом удерживают базовую частоту, даже если
+// внешний участок ускорен: I2C (Wire) на ESP8266 формирует такты задержками,
+// рассчитанными по F_CPU, а опрос HX711 — ожидание, которое ускорять незачем.
+// UART тактируется от APB (80 МГц) и от частоты CPU не зависит.
+
+#if CPU_GOVERNOR_ENABLED
+
+void CpuGov_Init();            // Установить базовую частоту
+void CpuGov_BoostBegin();      // Вход в вычислительный участок
+void CpuGov_BoostEnd();
+void CpuGov_HoldBaseBegin();   // Вход в участок, требующий базовой частоты
+void CpuGov_HoldBaseEnd();
+uint8_t CpuGov_GetMHz();       // Текущая частота CPU
+
+// Ускорение на время жизни блока: { CPU_BOOST_SCOPE(); ... }
+class CpuBoostScope {
+public:
+  CpuBoostScope() { CpuGov_BoostBegin(); }
+  ~CpuBoostScope() { CpuGov_BoostEnd(); }
+};
+
+// Базовая частота на время жизни блока: { CPU_BASE_SCOPE(); ... }
+class CpuBaseScope {
+public:
+  CpuBaseScope() { CpuGov_HoldBaseBegin(); }
+  ~CpuBaseScope() { CpuGov_HoldBaseEnd(); }
+};
+
+#define CPU_BOOST_SCOPE() CpuBoostScope _cpuBoost
+#define CPU_BASE_SCOPE()  CpuBaseScope _cpuBase
+
+#else
+
+inline void CpuGov_Init() {}
+#define CPU_BOOST_SCOPE()
+#define CPU_BASE_SCOPE()
+
+#endif
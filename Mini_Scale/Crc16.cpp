@@ -0,0 +1,16 @@
+#include "Crc16.h"
+
+uint16_t Crc16_Update(uint16_t crc, const void* data, size_t len) {
+  const uint8_t* ptr = (const uint8_t*)data;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= ((uint16_t)ptr[i]) << 8;
+    for (uint8_t b = 0; b < 8; b++) {
+      if (crc & 0x8000) {
+        crc = (crc << 1) ^ 0x1021;
+      } else {
+        crc = crc << 1;
+      }
+    }
+  }
+  return crc;
+}
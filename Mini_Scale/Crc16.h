@@ -0,0 +1,12 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC16 (CRC-CCITT, полином 0x1021, старший бит первым) — общая для всех
+// форматов прошивки: слоты EEPROM, блоки архива и RTC, кадры BulkExport.
+// Начальное значение — CRC16_INIT; crc с прошлого вызова продолжает расчёт
+// по нескольким областям памяти.
+
+#define CRC16_INIT 0xFFFF
+
+uint16_t Crc16_Update(uint16_t crc, const void* data, size_t len);
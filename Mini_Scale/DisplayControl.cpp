@@ -1,7 +1,9 @@
 #include "DisplayControl.h"
+#include "PowerStats.h"
+#include "CpuGovernor.h"
 
 // Глобальный объект дисплея SSD1306, используется во всех модулях
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET_PIN);
+StaticSsd1306 display(&Wire, OLED_RESET_PIN);
 
 // ===== Конечный автомат неблокирующего затухания =====
 enum FadeState {
@@ -21,6 +23,31 @@ static unsigned long lastFadeStepTime = 0;
 static bool overloadBlinkState = false;
 static unsigned long lastOverloadBlink = 0;
 
+// Баннер поверх строки дельты (версия после старта, Smart Start)
+static char bannerText[22] = "";
+static unsigned long bannerStart = 0;
+static unsigned long bannerDuration = 0;
+
+// Знаков после запятой — по шагу показания профиля (displayScale = 1/шаг, кг):
+// улей 10 г — 2 в кг и 0 в г, кухня 1 г — 3 и 0, лаборатория 0,1 г — 4 и 1
+static constexpr uint8_t decimalsOf(float scale) {
+  return scale >= 10.0f ? 1 + decimalsOf(scale / 10.0f) : 0;
+}
+static constexpr uint8_t KG_DECIMALS = decimalsOf(ScaleProfile::displayScale);
+static constexpr uint8_t G_DECIMALS  = KG_DECIMALS > 3 ? KG_DECIMALS - 3 : 0;
+
+// Передать буфер кадра на SSD1306 (учитывается отдельной фазой I2C).
+// Тайминги Wire рассчитаны на частоту сборки — ускорение на время передачи снимается.
+static void flushFrame() {
+  POWER_SCOPE(PH_I2C_FLUSH);
+  CPU_BASE_SCOPE();
+  display.display();
+}
+
+void Display_Flush() {
+  flushFrame();
+}
+
 // ===== Инициализация дисплея =====
 void Display_Init() {
   if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_I2C_ADDR)) {
@@ -56,7 +83,7 @@ static void drawBatteryIcon(int x, int y, int percent, bool blink) {
   display.setTextSize(1);
   display.setCursor(x + w + 5, y + 1);
   display.print(percent);
-  display.print("%");
+  display.print('%');
 }
 
 // ===== Прогресс-бар удержания кнопки =====
@@ -105,6 +132,8 @@ void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
                       bool batLowBlink, bool frozen,
                       bool overloaded, int8_t trend,
                       bool useGrams) {
+  POWER_SCOPE(PH_RENDER);
+  CPU_BOOST_SCOPE();
   display.clearDisplay();
 
   // --- Перегрузка: мигающий текст вместо веса ---
@@ -118,7 +147,7 @@ void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
     display.setTextSize(2);
     if (overloadBlinkState) {
       display.setCursor(4, 0);
-      display.print("OVERLOAD!");
+      display.print(F("OVERLOAD!"));
     }
     // Пропускаем отображение веса, но показываем батарею
     drawBatteryIcon(0, 50, bat_percent, batLowBlink);
@@ -133,7 +162,7 @@ void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
       display.setCursor(SCREEN_WIDTH - tw - 1, 51);
       display.print(vBuf);
     }
-    display.display();
+    flushFrame();
     return;
   }
 
@@ -153,11 +182,7 @@ void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
 
     char wBuf[16];
     const char* prefix = stable ? "=" : "~";
-    if (useGrams) {
-      dtostrf(displayVal, 1, 1, wBuf);
-    } else {
-      dtostrf(displayVal, 1, 2, wBuf);
-    }
+    dtostrf(displayVal, 1, useGrams ? G_DECIMALS : KG_DECIMALS, wBuf);
 
     char fullBuf[24];
     snprintf(fullBuf, sizeof(fullBuf), "%s%s %s", prefix, wBuf, unit);
@@ -183,7 +208,7 @@ void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
   if (frozen && trend == 0) {
     display.setTextSize(1);
     display.setCursor(SCREEN_WIDTH - 6, 0);
-    display.print("*");
+    display.print('*');
   }
 
   // --- Средняя часть: подсказки при удержании кнопки или дельта сессии ---
@@ -198,19 +223,31 @@ void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
       display.println("Holding...");
     }
     drawHoldBar(34, btnElapsed);
+  } else if (Display_BannerMsLeft() > 0) {
+    // Баннер инверсной строкой по центру
+    display.setTextSize(1);
+    int16_t x1, y1;
+    uint16_t tw, th;
+    display.getTextBounds(bannerText, 0, 0, &x1, &y1, &tw, &th);
+    display.fillRect(0, 22, SCREEN_WIDTH, 13, WHITE);
+    display.setTextColor(BLACK);
+    int16_t x = (SCREEN_WIDTH - (int16_t)tw) / 2;
+    display.setCursor(x > 0 ? x : 0, 25);
+    display.print(bannerText);
+    display.setTextColor(WHITE);
   } else {
     display.setTextSize(1);
     display.setCursor(0, 25);
-    display.print("Delta: ");
+    display.print(F("Delta: "));
     if (useGrams) {
       float deltaG = delta * 1000.0f;
-      if (deltaG > 0) display.print("+");
+      if (deltaG > 0) display.print('+');
       display.print(deltaG, 1);
-      display.println(" g");
+      display.println(F(" g"));
     } else {
-      if (delta > 0) display.print("+");
+      if (delta > 0) display.print('+');
       display.print(delta, 2);
-      display.println(" kg");
+      display.println(F(" kg"));
     }
   }
 
@@ -230,28 +267,32 @@ void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
     display.print(vBuf);
   }
 
-  display.display();
+  flushFrame();
 }
 
 // ===== Показать сообщение на весь экран =====
-void Display_ShowMessage(const char* msg) {
+void Display_ShowMessage(PGM_P msg) {
+  char text[sizeof(bannerText)];
+  strncpy_P(text, msg, sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+
   display.clearDisplay();
   display.setTextSize(1);
 
   int16_t x1, y1;
   uint16_t tw, th;
-  display.getTextBounds(msg, 0, 0, &x1, &y1, &tw, &th);
+  display.getTextBounds(text, 0, 0, &x1, &y1, &tw, &th);
   int16_t cx = (SCREEN_WIDTH - (int16_t)tw) / 2;
   int16_t cy = (SCREEN_HEIGHT - (int16_t)th) / 2;
   display.setCursor(cx > 0 ? cx : 0, cy > 0 ? cy : 0);
-  display.print(msg);
-  display.display();
+  display.print(text);
+  flushFrame();
 }
 
 // ===== Выключение дисплея =====
 void Display_Off() {
   display.clearDisplay();
-  display.display();
+  flushFrame();
   display.ssd1306_command(SSD1306_DISPLAYOFF);
 }
 
@@ -268,42 +309,25 @@ void Display_Splash(const char* title) {
 
   display.setCursor(x > 0 ? x : 0, y > 0 ? y : 0);
   display.print(title);
-  display.display();
+  flushFrame();
 }
 
-// ===== Полный экран заставки с версией и батареей =====
-void Display_SplashFull(const char* title, const char* version,
-                        float voltage, int percent) {
-  display.clearDisplay();
-
-  // Заголовок крупным шрифтом (центрирование)
-  display.setTextSize(2);
-  int16_t x1, y1;
-  uint16_t tw, th;
-  display.getTextBounds(title, 0, 0, &x1, &y1, &tw, &th);
-  int16_t x = (SCREEN_WIDTH - (int16_t)tw) / 2;
-  display.setCursor(x > 0 ? x : 0, 4);
-  display.print(title);
-
-  // Версия мелким шрифтом под заголовком
-  display.setTextSize(1);
-  display.getTextBounds(version, 0, 0, &x1, &y1, &tw, &th);
-  x = (SCREEN_WIDTH - (int16_t)tw) / 2;
-  display.setCursor(x > 0 ? x : 0, 26);
-  display.print(version);
+// ===== Баннер поверх главного экрана =====
+// Показывается в Display_ShowMain вместо строки дельты, пока не истечёт durationMs
+void Display_SetBanner(const char* text, unsigned long durationMs) {
+  strncpy(bannerText, text, sizeof(bannerText) - 1);
+  bannerText[sizeof(bannerText) - 1] = '\0';
+  bannerStart = millis();
+  bannerDuration = durationMs;
+}
 
-  // Иконка батареи + напряжение внизу
-  drawBatteryIcon(0, 50, percent, false);
-  {
-    char vBuf[10];
-    dtostrf(voltage, 4, 2, vBuf);
-    strcat(vBuf, "V");
-    display.getTextBounds(vBuf, 0, 0, &x1, &y1, &tw, &th);
-    display.setCursor(SCREEN_WIDTH - tw - 1, 51);
-    display.print(vBuf);
+unsigned long Display_BannerMsLeft() {
+  unsigned long elapsed = millis() - bannerStart;
+  if (bannerDuration == 0 || elapsed >= bannerDuration) {
+    bannerDuration = 0;
+    return 0;
   }
-
-  display.display();
+  return bannerDuration - elapsed;
 }
 
 // ===== Прогресс-бар загрузки =====
@@ -322,7 +346,7 @@ void Display_Progress(int percent) {
   if (innerWidth > 0) {
     display.fillRect(barMargin + 1, barY + 1, innerWidth, barHeight - 2, WHITE);
   }
-  display.display();
+  flushFrame();
 }
 
 // ===== Неблокирующее затухание: запуск =====
@@ -4,7 +4,19 @@
 #include <Adafruit_SSD1306.h>
 #include "Config.h"
 
-extern Adafruit_SSD1306 display;
+// SSD1306 с кадром в статической памяти: begin() библиотеки выделяет кадр
+// в куче, только если буфер не задан до него
+class StaticSsd1306 : public Adafruit_SSD1306 {
+public:
+  StaticSsd1306(TwoWire* twi, int8_t rstPin)
+      : Adafruit_SSD1306(SCREEN_WIDTH, SCREEN_HEIGHT, twi, rstPin) { buffer = frame; }
+  ~StaticSsd1306() { buffer = nullptr; }   // деструктор библиотеки освобождает buffer
+
+private:
+  uint8_t frame[RAM_FRAME_BYTES];
+};
+
+extern StaticSsd1306 display;
 
 void Display_Init();                // Инициализация дисплея
 void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
@@ -12,12 +24,13 @@ void Display_ShowMain(float weight, float delta, float voltage, int bat_percent,
                       bool batLowBlink, bool frozen,
                       bool overloaded, int8_t trend,
                       bool useGrams);  // Отрисовка главного экрана
-void Display_ShowMessage(const char* msg); // Показать сообщение на весь экран (центрирование)
+void Display_ShowMessage(PGM_P msg); // Сообщение из flash (UiText) на весь экран, по центру
 void Display_Off();                 // Выключить дисплей
+void Display_Flush();               // Кадр, нарисованный вызывающим, на SSD1306 (фаза I2C, базовая частота CPU)
 void Display_Splash(const char* title);   // Экран заставки при запуске
-void Display_SplashFull(const char* title, const char* version,
-                        float voltage, int percent); // Полный splash с версией и батареей
 void Display_Progress(int percent); // Прогресс-бар при загрузке
+void Display_SetBanner(const char* text, unsigned long durationMs); // Строка поверх главного экрана
+unsigned long Display_BannerMsLeft(); // Сколько ещё показывается баннер (0 — нет)
 void Display_Dim();                 // Запустить плавное затухание (неблокирующее)
 void Display_SmoothWake();          // Запустить плавное пробуждение (неблокирующее)
 void Display_Wake();                // Мгновенное пробуждение дисплея
@@ -0,0 +1,205 @@
+#include "FlashRing.h"
+#include <Arduino.h>
+
+// Заголовок сегмента; check = ~(magic ^ seq) отличает его от мусора
+struct SegmentHeader {
+  uint32_t magic;
+  uint32_t seq;          // Порядковый номер сегмента, растёт с каждым новым
+  uint16_t version;
+  uint16_t recordSize;
+  uint32_t check;
+};
+
+static_assert(sizeof(SegmentHeader) == FLASH_RING_HEADER_SIZE, "header size is part of the format");
+
+static uint16_t perSegment(const FlashRing* r) {
+  return FLASH_RING_PER_SEGMENT(r->recordSize);
+}
+
+static uint32_t sectorAddr(const FlashRing* r, uint16_t sector) {
+  return r->base + sector * FLASH_RING_SECTOR_SIZE;
+}
+
+static uint32_t recordAddr(const FlashRing* r, uint16_t sector, uint16_t slot) {
+  return sectorAddr(r, sector) + sizeof(SegmentHeader) + slot * r->recordSize;
+}
+
+static bool readHeader(const FlashRing* r, uint16_t sector, SegmentHeader* h) {
+  ESP.flashRead(sectorAddr(r, sector), (uint32_t*)h, sizeof(*h));
+  return h->magic == r->magic && h->check == ~(h->magic ^ h->seq) &&
+         h->version == r->version && h->recordSize == r->recordSize;
+}
+
+// Ключ записи (первое слово); 0xFFFFFFFF — пусто
+static uint32_t readKey(const FlashRing* r, uint16_t sector, uint16_t slot) {
+  uint32_t key;
+  ESP.flashRead(recordAddr(r, sector, slot), &key, sizeof(key));
+  return key;
+}
+
+// Записи в сегменте идут подряд с начала — первая пустая ищется бинарным поиском
+static uint16_t usedSlots(const FlashRing* r, uint16_t sector) {
+  uint16_t lo = 0, hi = perSegment(r);
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (readKey(r, sector, mid) != 0xFFFFFFFFUL) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+void FlashRing_Init(FlashRing* r) {
+  r->initialized = true;
+  r->hasHead = false;
+  r->total = 0;
+
+  SegmentHeader h;
+  for (uint16_t s = 0; s < r->sectors; s++) {
+    if (!readHeader(r, s, &h)) continue;
+    r->total += usedSlots(r, s);
+    if (!r->hasHead || (int32_t)(h.seq - r->headSeq) > 0) {
+      r->hasHead = true;
+      r->headSector = s;
+      r->headSeq = h.seq;
+    }
+  }
+  r->headSlot = r->hasHead ? usedSlots(r, r->headSector) : 0;
+}
+
+// Открыть следующий сегмент: стереть сектор (самый старый) и записать заголовок
+static bool openSegment(FlashRing* r) {
+  uint16_t sector = r->hasHead ? (r->headSector + 1) % r->sectors : 0;
+  SegmentHeader h;
+  if (readHeader(r, sector, &h)) {
+    uint16_t dropped = usedSlots(r, sector);
+    r->total -= (dropped <= r->total) ? dropped : r->total;
+  }
+  if (!ESP.flashEraseSector(sectorAddr(r, sector) / FLASH_RING_SECTOR_SIZE)) return false;
+
+  h.magic = r->magic;
+  h.seq = r->hasHead ? r->headSeq + 1 : 1;
+  h.version = r->version;
+  h.recordSize = r->recordSize;
+  h.check = ~(h.magic ^ h.seq);
+  if (!ESP.flashWrite(sectorAddr(r, sector), (const uint32_t*)&h, sizeof(h))) return false;
+
+  r->hasHead = true;
+  r->headSector = sector;
+  r->headSeq = h.seq;
+  r->headSlot = 0;
+  return true;
+}
+
+bool FlashRing_Append(FlashRing* r, const void* rec) {
+  if (!r->initialized) FlashRing_Init(r);
+  if (!r->hasHead || r->headSlot >= perSegment(r)) {
+    if (!openSegment(r)) return false;
+  }
+  if (!ESP.flashWrite(recordAddr(r, r->headSector, r->headSlot), (const uint32_t*)rec,
+                      r->recordSize)) {
+    return false;
+  }
+  r->headSlot++;
+  r->total++;
+  return true;
+}
+
+uint32_t FlashRing_Count(FlashRing* r) {
+  if (!r->initialized) FlashRing_Init(r);
+  return r->total;
+}
+
+uint32_t FlashRing_Capacity(const FlashRing* r) {
+  return (uint32_t)(r->sectors - 1) * perSegment(r);
+}
+
+// Начать с последнего сегмента, первая запись которого не новее fromKey:
+// более старые сегменты не читаются вовсе
+bool FlashRing_Open(FlashRing* r, FlashRingCursor* c, uint32_t fromKey) {
+  if (!r->initialized) FlashRing_Init(r);
+  c->sector = r->hasHead ? (r->headSector + 1) % r->sectors : 0;
+  c->visited = r->hasHead ? 0 : r->sectors;
+  c->slot = 0;
+  c->maxSeq = r->headSeq;
+  c->fromKey = fromKey;
+  c->seq = 0;
+  if (!r->hasHead || fromKey == 0) return r->hasHead;
+
+  for (uint16_t i = 0; i < r->sectors; i++) {
+    uint16_t s = (r->headSector + 1 + i) % r->sectors;
+    SegmentHeader h;
+    if (!readHeader(r, s, &h)) continue;
+    uint32_t first = readKey(r, s, 0);
+    if (first == 0xFFFFFFFFUL || first > fromKey) break;
+    c->sector = s;
+    c->visited = i;
+  }
+  return true;
+}
+
+bool FlashRing_Next(FlashRing* r, FlashRingCursor* c, void* out) {
+  while (c->visited < r->sectors) {
+    // Заголовок — на входе в сегмент. Пропускаются неразмеченные сегменты
+    // и открытые уже после FlashRing_Open.
+    SegmentHeader h;
+    bool valid = c->slot > 0;
+    if (!valid && readHeader(r, c->sector, &h) && (int32_t)(h.seq - c->maxSeq) <= 0) {
+      valid = true;
+      c->seq = h.seq;
+    }
+    if (valid && c->slot < perSegment(r)) {
+      ESP.flashRead(recordAddr(r, c->sector, c->slot), (uint32_t*)out, r->recordSize);
+      uint32_t key = *(const uint32_t*)out;
+      if (key != 0xFFFFFFFFUL) {
+        c->slot++;
+        if (key >= c->fromKey) return true;
+        continue;
+      }
+    }
+    c->sector = (c->sector + 1) % r->sectors;
+    c->visited++;
+    c->slot = 0;
+  }
+  return false;
+}
+
+// Сегмент с нужным seq ищется по заголовкам; если он уже стёрт — чтение
+// начинается с самого старого (пропуск виден по позициям записей)
+bool FlashRing_OpenAt(FlashRing* r, FlashRingCursor* c, uint32_t position) {
+  if (!FlashRing_Open(r, c, 0)) return false;
+  uint32_t wantSeq = position / perSegment(r);
+  uint16_t wantSlot = position % perSegment(r);
+  if ((int32_t)(wantSeq - r->headSeq) > 0) {
+    c->visited = r->sectors;               // позиция ещё не записана
+    return true;
+  }
+  for (uint16_t i = 0; i < r->sectors; i++) {
+    uint16_t s = (r->headSector + 1 + i) % r->sectors;
+    SegmentHeader h;
+    if (!readHeader(r, s, &h) || (int32_t)(h.seq - wantSeq) < 0) continue;
+    c->sector = s;
+    c->visited = i;
+    if (h.seq == wantSeq) {
+      c->slot = wantSlot;
+      c->seq = h.seq;
+    }
+    break;
+  }
+  return true;
+}
+
+uint32_t FlashRing_Position(const FlashRing* r, const FlashRingCursor* c) {
+  return c->seq * perSegment(r) + c->slot - 1;
+}
+
+uint32_t FlashRing_EndPosition(FlashRing* r) {
+  if (!r->initialized) FlashRing_Init(r);
+  return r->hasHead ? r->headSeq * perSegment(r) + r->headSlot : 0;
+}
+
+void FlashRing_Format(FlashRing* r) {
+  for (uint16_t s = 0; s < r->sectors; s++) {
+    ESP.flashEraseSector(sectorAddr(r, s) / FLASH_RING_SECTOR_SIZE);
+  }
+  FlashRing_Init(r);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Кольцо сегментов во flash для записей фиксированного размера.
+// Сегмент = сектор 4 КБ: заголовок (magic, порядковый номер, размер записи)
+// и записи, дописываемые подряд. Запись только последовательная; при переходе
+// по кругу стирается самый старый сегмент — износ секторов равномерный.
+// Сектор без действительного заголовка считается свободным (прерванное
+// стирание, чужие данные).
+//
+// Первое слово записи — неубывающий ключ (время или номер интервала);
+// 0xFFFFFFFF зарезервирован под стёртый flash.
+//
+// Позиция записи = seq сегмента * записей в сегменте + номер в сегменте —
+// не меняется при переходе по кругу, по ней чтение продолжается с места обрыва.
+
+#define FLASH_RING_SECTOR_SIZE  4096UL
+#define FLASH_RING_HEADER_SIZE  16UL
+
+// Записей в сегменте для записи размера size
+#define FLASH_RING_PER_SEGMENT(size) \
+  ((FLASH_RING_SECTOR_SIZE - FLASH_RING_HEADER_SIZE) / (size))
+
+// Секторов на count записей с гарантией (плюс сегмент, стираемый при переходе)
+#define FLASH_RING_SECTORS(count, size) \
+  (((count) + FLASH_RING_PER_SEGMENT(size) - 1) / FLASH_RING_PER_SEGMENT(size) + 1)
+
+struct FlashRing {
+  // Параметры — задаются при объявлении
+  uint32_t base;         // Адрес первого сектора (кратен 4096)
+  uint16_t sectors;
+  uint16_t recordSize;   // Кратен 4
+  uint16_t version;      // Версия формата записи — другая версия = пустой сектор
+  uint32_t magic;
+  // Состояние — заполняет FlashRing_Init
+  bool     initialized;
+  bool     hasHead;
+  uint16_t headSector;   // Сегмент, в который идёт запись
+  uint16_t headSlot;     // Следующая свободная запись в нём
+  uint32_t headSeq;
+  uint32_t total;        // Записей в кольце
+};
+
+// Потоковое чтение от старых к новым
+struct FlashRingCursor {
+  uint16_t sector;       // Текущий сектор
+  uint16_t visited;      // Пройдено секторов
+  uint16_t slot;         // Следующая запись в секторе
+  uint32_t maxSeq;       // Номер последнего сегмента на момент открытия
+  uint32_t fromKey;      // Пропускать записи с ключом меньше
+  uint32_t seq;          // Номер текущего сегмента
+};
+
+// Объявление кольца:
+//   FlashRing r = FLASH_RING(адрес, секторов, sizeof(запись), версия, magic);
+#define FLASH_RING(base, sectors, size, version, magic) \
+  { (base), (sectors), (size), (version), (magic), false, false, 0, 0, 0, 0 }
+
+void FlashRing_Init(FlashRing* r);                             // Найти голову (скан заголовков)
+bool FlashRing_Append(FlashRing* r, const void* rec);          // Дописать запись
+uint32_t FlashRing_Count(FlashRing* r);                        // Записей в кольце
+uint32_t FlashRing_Capacity(const FlashRing* r);               // Гарантированная вместимость
+bool FlashRing_Open(FlashRing* r, FlashRingCursor* c, uint32_t fromKey);
+bool FlashRing_Next(FlashRing* r, FlashRingCursor* c, void* out);
+bool FlashRing_OpenAt(FlashRing* r, FlashRingCursor* c, uint32_t position); // С позиции или самой старой после неё
+uint32_t FlashRing_Position(const FlashRing* r, const FlashRingCursor* c);  // Позиция последней прочитанной
+uint32_t FlashRing_EndPosition(FlashRing* r);                              // Позиция следующей записи
+void FlashRing_Format(FlashRing* r);                           // Стереть все сектора
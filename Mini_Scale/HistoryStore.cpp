@@ -0,0 +1,130 @@
+#include "HistoryStore.h"
+#include <Arduino.h>
+#include <string.h>
+
+static_assert(HISTORY_BLOCK_SIZE % 4 == 0, "flash writes are word-sized");
+static_assert(HISTORY_BLOCK_SIZE <= CODEC_HEADER_SIZE + 255, "block length is uint8_t");
+static_assert(HISTORY_SECTORS >= 2 && HISTORY_SECTORS <= 1024, "history size out of range");
+
+static FlashRing ring = FLASH_RING(FS_PHYS_ADDR, HISTORY_SECTORS, HISTORY_BLOCK_SIZE,
+                                  HISTORY_VERSION, HISTORY_MAGIC);
+
+static bool regionFits() {
+  return FS_PHYS_SIZE >= HISTORY_SECTORS * FLASH_RING_SECTOR_SIZE;
+}
+
+void History_Init() {
+  ring.initialized = true;
+  ring.hasHead = false;
+  ring.total = 0;
+  if (!regionFits()) return;
+
+  FlashRing_Init(&ring);
+  DEBUG_PRINTF("[HIST] %u sectors, %lu blocks, head %u:%u seq %lu\n",
+               (unsigned)HISTORY_SECTORS, (unsigned long)ring.total,
+               ring.headSector, ring.headSlot, (unsigned long)ring.headSeq);
+}
+
+bool History_Append(const LogRecord* recs, size_t n) {
+  if (!ring.initialized) History_Init();
+  if (!regionFits()) return false;
+
+  // Пачка режется на блоки; хвост блока остаётся стёртым (0xFF)
+  uint32_t block[HISTORY_BLOCK_SIZE / 4];
+  size_t i = 0;
+  while (i < n) {
+    CodecEncoder e;
+    memset(block, 0xFF, sizeof(block));
+    Codec_Begin(&e, (uint8_t*)block, sizeof(block));
+    while (i < n && Codec_Append(&e, recs[i])) i++;
+    if (Codec_Finish(&e) == 0 || !FlashRing_Append(&ring, block)) return false;
+  }
+  return true;
+}
+
+uint32_t History_Count() {
+  if (!ring.initialized) History_Init();
+  FlashRingCursor c;
+  uint32_t block[HISTORY_BLOCK_SIZE / 4];
+  uint32_t n = 0;
+  FlashRing_Open(&ring, &c, 0);
+  while (FlashRing_Next(&ring, &c, block)) n += ((const CodecBlockHeader*)block)->count;
+  return n;
+}
+
+uint32_t History_Capacity() {
+  return FlashRing_Capacity(&ring);
+}
+
+bool History_Open(HistoryCursor* c, uint32_t fromTs) {
+  if (!ring.initialized) History_Init();
+  c->fromTs = fromTs;
+  c->dec.left = 0;
+  bool ok = FlashRing_Open(&ring, &c->ring, fromTs);
+  c->ring.fromKey = 0;   // блок с fromTs может начинаться раньше него
+  return ok;
+}
+
+bool History_Next(HistoryCursor* c, LogRecord* out) {
+  for (;;) {
+    while (Codec_Next(&c->dec, out)) {
+      if (out->ts >= c->fromTs) return true;
+    }
+    // Следующий блок; целиком более старые и повреждённые не декодируются
+    CodecBlockHeader h;
+    do {
+      if (!FlashRing_Next(&ring, &c->ring, c->block)) return false;
+      memcpy(&h, c->block, sizeof(h));
+    } while (h.lastTs < c->fromTs || !Codec_Open(&c->dec, c->block, sizeof(c->block)));
+  }
+}
+
+bool History_OpenBlocks(HistoryCursor* c, uint32_t position) {
+  if (!ring.initialized) History_Init();
+  c->fromTs = 0;
+  c->dec.left = 0;
+  return FlashRing_OpenAt(&ring, &c->ring, position);
+}
+
+bool History_NextBlock(HistoryCursor* c, uint32_t* position) {
+  if (!FlashRing_Next(&ring, &c->ring, c->block)) return false;
+  *position = FlashRing_Position(&ring, &c->ring);
+  return true;
+}
+
+uint32_t History_FirstPosition() {
+  HistoryCursor c;
+  uint32_t position;
+  if (History_OpenBlocks(&c, 0) && History_NextBlock(&c, &position)) return position;
+  return History_EndPosition();
+}
+
+uint32_t History_EndPosition() {
+  if (!ring.initialized) History_Init();
+  return FlashRing_EndPosition(&ring);
+}
+
+void History_CsvBegin(Print& out, HistoryCursor* c) {
+  out.println(F("ts,weight_kg,battery,flags"));
+  History_Open(c, 0);
+}
+
+uint8_t History_CsvStep(Print& out, HistoryCursor* c, uint8_t maxRecords) {
+  LogRecord rec;
+  uint8_t n = 0;
+  while (n < maxRecords && History_Next(c, &rec)) {
+    if (rec.flags & LOG_FLAG_ERROR) {
+      out.printf("%lu,,%u,%u\n", (unsigned long)rec.ts, rec.battery, rec.flags);
+    } else {
+      out.printf("%lu,%.3f,%u,%u\n", (unsigned long)rec.ts, rec.weight_g / 1000.0f,
+                 rec.battery, rec.flags);
+    }
+    n++;
+  }
+  return n;
+}
+
+void History_Format() {
+  if (regionFits()) FlashRing_Format(&ring);
+  else History_Init();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include <Arduino.h>
+#include <flash_hal.h>
+#include "RtcLog.h"
+#include "FlashRing.h"
+#include "SampleCodec.h"
+
+// Архив измерений во flash: сжатые блоки записей LogRecord (SampleCodec)
+// в кольце сегментов (FlashRing) в начале области FS. Каждая пачка
+// History_Append начинает новый блок; ключ блока — время первой записи.
+//
+// Чтение потоковое, от старых к новым, через курсор — в RAM только текущий блок:
+//   HistoryCursor c;
+//   History_Open(&c, fromTs);
+//   while (History_Next(&c, &rec)) { ... }
+
+#define HISTORY_SECTORS \
+  FLASH_RING_SECTORS(HISTORY_RETENTION_DAYS * HISTORY_RECORDS_PER_DAY / HISTORY_BLOCK_RECORDS_EST, \
+                     HISTORY_BLOCK_SIZE)
+#define HISTORY_END_ADDR  (FS_PHYS_ADDR + HISTORY_SECTORS * FLASH_RING_SECTOR_SIZE)
+
+struct HistoryCursor {
+  FlashRingCursor ring;
+  uint32_t     fromTs;   // Пропускать записи старше
+  CodecDecoder dec;      // Текущий блок
+  uint8_t      block[HISTORY_BLOCK_SIZE];
+};
+
+void History_Init();                                  // Найти голову (скан заголовков)
+bool History_Append(const LogRecord* recs, size_t n); // Дописать пачку
+uint32_t History_Count();                             // Записей в архиве (читает заголовки всех блоков)
+uint32_t History_Capacity();                          // Гарантированная вместимость, блоков
+bool History_Open(HistoryCursor* c, uint32_t fromTs); // Курсор на самую старую запись с ts >= fromTs
+bool History_Next(HistoryCursor* c, LogRecord* out);  // Следующая запись; false — конец
+bool History_OpenBlocks(HistoryCursor* c, uint32_t position); // Сжатые блоки с позиции (FlashRing)
+bool History_NextBlock(HistoryCursor* c, uint32_t* position); // Блок в c->block; false — конец
+uint32_t History_FirstPosition();                     // Позиция самого старого блока
+uint32_t History_EndPosition();                       // Позиция следующего блока
+void History_CsvBegin(Print& out, HistoryCursor* c);  // Заголовок CSV (ts,weight_kg,battery,flags), курсор на начало
+uint8_t History_CsvStep(Print& out, HistoryCursor* c, uint8_t maxRecords); // До maxRecords строк; 0 — архив выгружен
+void History_Format();                                // Стереть архив
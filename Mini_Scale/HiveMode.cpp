@@ -0,0 +1,117 @@
+#include "HiveMode.h"
+#include "MemoryControl.h"
+#include "ScaleControl.h"
+#include "BatteryControl.h"
+#include "SettingsMode.h"
+#include "PowerStats.h"
+#include "Clock.h"
+#include "RtcLog.h"
+#include "Rrd.h"
+#include "Log.h"
+#include "Uplink.h"
+extern "C" {
+  #include "user_interface.h"
+}
+
+// Интервал режима улья из настроек, секунды (0 — режим выключен)
+static unsigned long intervalSec() {
+  uint8_t mode = constrain(savedData.hive_interval_mode, 0, HIVE_INTERVAL_VALUES_COUNT - 1);
+  return hiveIntervalValues[mode];
+}
+
+static bool headless = false;   // Идёт измерение по таймеру (без интерфейса)
+
+// Записать измерение в RTC-кольцо; во flash — когда кольцо заполнено или
+// батарея разряжена (ежечасное стирание сектора дороже самого измерения)
+static void recordReading(float weight, int battery) {
+  uint8_t flags = 0;
+  if (weight < WEIGHT_ERROR_THRESHOLD) flags |= LOG_FLAG_ERROR;
+  if (!Clock_IsExact()) flags |= LOG_FLAG_CLOCK_LOST;
+  if (Battery_IsLow()) flags |= LOG_FLAG_LOW_BAT;
+
+  bool full = RtcLog_Append(RtcLog_MakeRecord(Clock_Now(), weight, battery, flags));
+  DEBUG_PRINTF("[HIVE] t=%lu %.3f kg, bat %d%%, %u in RTC, %lu ms\n",
+               (unsigned long)Clock_Now(), weight, battery, RtcLog_Count(), millis());
+  if (full || Battery_IsLow()) RtcLog_Flush();
+}
+
+bool Hive_IsTimerWake() {
+  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  return ESP.getResetInfoPtr()->reason == REASON_DEEP_SLEEP_AWAKE &&
+         digitalRead(BUTTON_PIN) == HIGH;
+}
+
+// Измерение по таймеру: без Serial-паузы, дисплея и заставок.
+// Период держится по RTC: время самого измерения вычитается из интервала сна.
+void Hive_RunHeadless() {
+#ifdef DEBUG_ENABLED
+  Serial.begin(SERIAL_BAUD);
+#endif
+  Memory_Init();
+  if (intervalSec() == 0) return; // режим выключен в настройках — обычный старт
+  headless = true;
+
+  RtcLog_Load();
+  Battery_Init();
+  if (Battery_IsCritical()) {
+    DEBUG_PRINTLN(F("[HIVE] critical battery, off"));
+    Hive_Shutdown();
+  }
+
+  float weight;
+  if (!Scale_MeasureHeadless(HIVE_SAMPLES, &weight)) {
+    if (digitalRead(BUTTON_PIN) == LOW) {  // нажатие — полный интерфейс
+      headless = false;
+      return;
+    }
+    weight = WEIGHT_ERROR_FLAG;
+  }
+  if (digitalRead(BUTTON_PIN) == LOW) {
+    headless = false;
+    return;
+  }
+
+  Clock_AddSleptMs(Scale_TakeMillisLag());
+  recordReading(weight, Battery_GetPercent());
+  Rrd_AddSample(Clock_Now(), weight);
+  Hive_PowerOff();
+}
+
+// Конец сеанса с интерфейсом — последний вес тоже попадает в архив
+static void recordSessionEnd() {
+  if (headless || Scale_GetWeight() < WEIGHT_ERROR_THRESHOLD) return;
+  RtcLog_Load();
+  recordReading(Scale_GetWeight(), Battery_GetPercent());
+}
+
+// Следующее измерение — на границе интервала по часам устройства: время
+// работы не накапливается в сдвиг расписания. Выгрузка по WiFi — только из
+// измерения по таймеру и уже без питания HX711.
+void Hive_PowerOff() {
+  unsigned long sec = intervalSec();
+  if (sec == 0) Hive_Shutdown();
+
+  recordSessionEnd();
+  Rrd_Save();
+  Scale_SaveSnapshot();
+  Scale_Adc().powerDown();
+  if (headless) Uplink_Run(Uplink_WifiTransport(), Clock_Now());
+  uint64_t periodMs = (uint64_t)sec * 1000ULL;
+  uint64_t nowMs = Clock_NowMs();
+  uint64_t sleepMs = (nowMs / periodMs + 1) * periodMs - nowMs;
+  Clock_PrepareSleep(sleepMs * 1000ULL);
+  Log_Flush();
+  ESP.deepSleep(sleepMs * 1000ULL, Uplink_PrepareSleep((uint32_t)((nowMs + sleepMs) / 1000ULL)));
+}
+
+void Hive_Shutdown() {
+  recordSessionEnd();
+  Rrd_Flush();
+  Scale_SaveSnapshot();
+  Scale_Adc().powerDown();
+  RtcLog_Load();
+  RtcLog_Flush();
+  Clock_PrepareSleep(0);
+  Log_Flush();
+  ESP.deepSleep(0);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Режим улья: периодические измерения без дисплея между сеансами работы.
+//
+// После auto-off устройство уходит в deep sleep на интервал из настроек
+// (Hive Mode), а не навсегда. Пробуждение по RTC-таймеру обрабатывается в самом
+// начале setup(): EEPROM, АЦП батареи, HX711 — и снова сон; OLED не
+// инициализируется. Нажатие кнопки во время измерения или RST — обычный старт
+// с полным интерфейсом. (Удерживать D3 в момент пробуждения нельзя: GPIO0 = LOW
+// при сбросе переводит ESP8266 в режим загрузчика.)
+//
+// Измерения копятся в RTC-памяти (RtcLog) и уходят во flash пачкой.
+
+bool Hive_IsTimerWake();              // Пробуждение по таймеру deep sleep?
+void Hive_RunHeadless();              // Измерить и уснуть; возвращается только для полного старта
+void Hive_PowerOff();                 // Выключение: deep sleep до следующего измерения или навсегда
+void Hive_Shutdown();                 // Выключение без таймера (разряд): RTC-кольцо — во flash
@@ -0,0 +1,168 @@
+#include "Log.h"
+#include <Arduino.h>
+#include <stdio.h>
+
+static_assert(sizeof(LogEntry) == 8 + 4 * LOG_MAX_ARGS, "LogEntry без выравнивающих дыр");
+
+// ===== Каталог строк формата (flash) =====
+#define LOG_X_FMT(id, mod, lvl, fmt) static const char logFmt_##id[] PROGMEM = fmt;
+LOG_MESSAGES(LOG_X_FMT)
+#undef LOG_X_FMT
+
+static const char* const logFormats[] PROGMEM = {
+#define LOG_X_PTR(id, mod, lvl, fmt) logFmt_##id,
+  LOG_MESSAGES(LOG_X_PTR)
+#undef LOG_X_PTR
+};
+
+static_assert(sizeof(logFormats) / sizeof(logFormats[0]) == LOG_MESSAGE_COUNT,
+              "каталог LogMessages.h рассинхронизирован");
+
+// ===== Форматирование =====
+
+static bool isFloatConv(char c) {
+  return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G';
+}
+
+static bool isIntConv(char c) {
+  return c == 'd' || c == 'i' || c == 'u' || c == 'x' || c == 'X' || c == 'c';
+}
+
+// Дописать в buf[*pos..size) результат snprintf; *pos не выходит за size - 1
+static void appendSpec(char* buf, size_t size, size_t* pos, const char* spec,
+                       const LogEntry& rec, uint8_t argIdx, bool isLong, char conv) {
+  size_t left = size - *pos;
+  int n;
+  if (argIdx >= rec.argc) {
+    n = snprintf(buf + *pos, left, "?");
+  } else if (isFloatConv(conv)) {
+    float f;
+    memcpy(&f, &rec.args[argIdx], sizeof(f));
+    n = snprintf(buf + *pos, left, spec, (double)f);
+  } else if (isLong) {
+    if (conv == 'd' || conv == 'i') n = snprintf(buf + *pos, left, spec, (long)(int32_t)rec.args[argIdx]);
+    else n = snprintf(buf + *pos, left, spec, (unsigned long)rec.args[argIdx]);
+  } else {
+    if (conv == 'd' || conv == 'i' || conv == 'c') n = snprintf(buf + *pos, left, spec, (int)(int32_t)rec.args[argIdx]);
+    else n = snprintf(buf + *pos, left, spec, (unsigned int)rec.args[argIdx]);
+  }
+  if (n < 0) return;
+  *pos += ((size_t)n < left) ? (size_t)n : left - 1;
+}
+
+size_t Log_Format(const LogEntry& rec, char* buf, size_t size) {
+  if (size == 0) return 0;
+  buf[0] = '\0';
+  if (rec.id >= LOG_MESSAGE_COUNT) {
+    snprintf(buf, size, "LOG #%u", rec.id);
+    return strlen(buf);
+  }
+
+  const char* fmt = (const char*)pgm_read_ptr(&logFormats[rec.id]);
+  size_t pos = 0;
+  uint8_t argIdx = 0;
+  for (;;) {
+    char c = (char)pgm_read_byte(fmt++);
+    if (c == '\0' || pos + 1 >= size) break;
+    if (c != '%') {
+      buf[pos++] = c;
+      continue;
+    }
+
+    // Спецификатор целиком: флаги, ширина, точность, l, преобразование
+    char spec[16];
+    uint8_t len = 0;
+    spec[len++] = '%';
+    bool isLong = false;
+    char conv = '\0';
+    while (len < sizeof(spec) - 1) {
+      char s = (char)pgm_read_byte(fmt);
+      if (s == '\0') break;
+      fmt++;
+      spec[len++] = s;
+      if (s == 'l') isLong = true;
+      if (s == '%' || isFloatConv(s) || isIntConv(s)) {
+        conv = s;
+        break;
+      }
+    }
+    spec[len] = '\0';
+
+    if (conv == '%') {
+      buf[pos++] = '%';
+    } else if (conv != '\0') {
+      appendSpec(buf, size, &pos, spec, rec, argIdx++, isLong, conv);
+    }
+  }
+  buf[pos] = '\0';
+  return pos;
+}
+
+#if LOG_ENABLED
+
+// ===== Кольцо записей =====
+
+static LogEntry ring[LOG_RING_SIZE];
+static_assert(sizeof(ring) <= RAM_LOG_BYTES, "log ring is over its RAM budget line");
+static uint8_t head = 0;       // Следующая запись к выводу
+static uint8_t count = 0;
+static uint16_t dropped = 0;   // Не поместилось в кольцо с последнего вывода
+
+// Кольцо полно — теряется новая запись: начало цепочки событий важнее хвоста
+void Log_Push(uint16_t id, uint8_t argc, const uint32_t* args) {
+  if (count >= LOG_RING_SIZE) {
+    if (dropped < 0xFFFF) dropped++;
+    return;
+  }
+  LogEntry& rec = ring[(head + count) % LOG_RING_SIZE];
+  rec.id = id;
+  rec.argc = argc;
+  rec.reserved = 0;
+  rec.ms = millis();
+  memcpy(rec.args, args, sizeof(uint32_t) * argc);
+  count++;
+}
+
+// Строка "[ms] текст\n" для головной записи; длина
+static size_t formatHead(char* line) {
+  const LogEntry& rec = ring[head];
+  int n = snprintf(line, LOG_LINE_MAX, "[%lu] ", (unsigned long)rec.ms);
+  if (n < 0 || n >= LOG_LINE_MAX - 2) n = 0;
+  size_t len = (size_t)n + Log_Format(rec, line + n, LOG_LINE_MAX - 1 - n);
+  line[len++] = '\n';
+  return len;
+}
+
+static void popHead() {
+  head = (head + 1) % LOG_RING_SIZE;
+  count--;
+}
+
+static void printDropped() {
+  Serial.printf("[LOG] %u dropped\n", dropped);
+  dropped = 0;
+}
+
+// Строка уходит целиком, только если помещается в TX FIFO — loop не ждёт UART
+void Log_Drain() {
+  char line[LOG_LINE_MAX + 1];
+  while (count > 0) {
+    size_t len = formatHead(line);
+    if ((size_t)Serial.availableForWrite() < len) return;
+    Serial.write((const uint8_t*)line, len);
+    popHead();
+  }
+  if (dropped > 0 && Serial.availableForWrite() >= 24) printDropped();
+}
+
+void Log_Flush() {
+  char line[LOG_LINE_MAX + 1];
+  while (count > 0) {
+    Serial.write((const uint8_t*)line, formatHead(line));
+    popHead();
+  }
+  if (dropped > 0) printDropped();
+  Serial.flush();
+}
+
+#endif
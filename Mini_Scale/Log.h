@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Config.h"
+#include "LogMessages.h"
+
+// Отложенный лог: в горячем пути — только номер сообщения, millis() и до
+// LOG_MAX_ARGS числовых аргументов в кольцо в RAM (без форматирования и UART).
+// Текст собирается в Log_Drain() в простое loop, строки формата — во flash.
+//
+//   LOG(ACQ_INTERVAL, acqIntervals[acqLevel]);
+//
+// Сообщения ниже порога модуля (LOG_<модуль>_LEVEL) отсекаются при компиляции.
+// Вызывать только из loop-контекста, не из прерываний.
+
+enum LogMessageId : uint16_t {
+#define LOG_X_ID(id, mod, lvl, fmt) LOG_##id,
+  LOG_MESSAGES(LOG_X_ID)
+#undef LOG_X_ID
+  LOG_MESSAGE_COUNT
+};
+
+struct LogEntry {
+  uint16_t id;                  // LogMessageId
+  uint8_t  argc;
+  uint8_t  reserved;
+  uint32_t ms;                  // millis() в момент записи
+  uint32_t args[LOG_MAX_ARGS];  // float — битовое представление
+};
+
+// Текст записи в buf (с завершающим нулём, без перевода строки); длина текста
+size_t Log_Format(const LogEntry& rec, char* buf, size_t size);
+
+// Аргумент записи: float — битами, целые как есть (разбирает Log_Format)
+inline uint32_t logArg(float v) {
+  uint32_t u;
+  memcpy(&u, &v, sizeof(u));
+  return u;
+}
+inline uint32_t logArg(double v) { return logArg((float)v); }
+template <typename T> inline uint32_t logArg(T v) { return (uint32_t)v; }
+
+#if LOG_ENABLED
+
+// Проходит ли сообщение порог своего модуля — константа времени компиляции
+constexpr bool logPasses[] = {
+#define LOG_X_PASS(id, mod, lvl, fmt) (LOG_LEVEL_##lvl <= LOG_##mod##_LEVEL),
+  LOG_MESSAGES(LOG_X_PASS)
+#undef LOG_X_PASS
+};
+
+void Log_Push(uint16_t id, uint8_t argc, const uint32_t* args);
+
+template <typename... A>
+inline void Log_Write(uint16_t id, A... a) {
+  static_assert(sizeof...(A) <= LOG_MAX_ARGS, "LOG: слишком много аргументов");
+  const uint32_t args[] = { logArg(a)..., 0 };
+  Log_Push(id, (uint8_t)sizeof...(A), args);
+}
+
+#define LOG(id, ...) \
+  do { if (logPasses[LOG_##id]) Log_Write(LOG_##id, ##__VA_ARGS__); } while (0)
+
+void Log_Drain();               // Вывести, сколько помещается в TX FIFO, не ждать
+void Log_Flush();               // Вывести всё и дождаться UART (перед deep sleep)
+
+#else
+
+#define LOG(id, ...) do {} while (0)
+
+inline void Log_Drain() {}
+inline void Log_Flush() {}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+// Каталог сообщений отложенного лога (см. Log.h).
+// X(ID, модуль, уровень, формат): индекс строки — идентификатор в записи,
+// поэтому новые сообщения добавляются только в конец.
+// Формат: %d %i %u %x %X %c (с модификатором l) и %f %e %g; не больше
+// LOG_MAX_ARGS аргументов, строки (%s) не поддерживаются — в записи только числа.
+// Файл без зависимостей: его подключает и хостовый декодер.
+
+#define LOG_MESSAGES(X) \
+  X(HX_NOT_READY,       SCALE,  WARN,  "HX711: не готов при запуске") \
+  X(SNAPSHOT_RESTORED,  SCALE,  INFO,  "Snapshot: restored %.3f kg (first %.3f)") \
+  X(SNAPSHOT_CHANGED,   SCALE,  INFO,  "Snapshot: weight changed %.3f -> %.3f") \
+  X(HX_RECOVERED,       SCALE,  WARN,  "HX711: восстановление из ERROR") \
+  X(ACQ_CONTINUOUS,     SCALE,  DEBUG, "ACQ: вес изменился, непрерывный опрос") \
+  X(ACQ_INTERVAL,       SCALE,  DEBUG, "ACQ: интервал %lu мс") \
+  X(OVERLOAD,           SCALE,  WARN,  "OVERLOAD!") \
+  X(AUTOZERO_DONE,      SCALE,  INFO,  "Auto-zero: corrected") \
+  X(AUTOZERO_REVERTED,  SCALE,  WARN,  "Auto-zero: read failed, reverted") \
+  X(HX_NO_CONVERSION,   SCALE,  WARN,  "HX711: нет конверсии после power_up") \
+  X(BTN_CONFIRM_EXPIRED, BUTTON, DEBUG, "[BTN] menu confirm window expired") \
+  X(BTN_MENU_ENTER,     BUTTON, INFO,  "[BTN] MENU ENTER") \
+  X(BTN_HOLDING,        BUTTON, DEBUG, "[BTN] press confirmed, holding...") \
+  X(BTN_MENU_PROMPT,    BUTTON, DEBUG, "[BTN] menu prompt shown") \
+  X(BTN_RELEASED,       BUTTON, DEBUG, "[BTN] released, elapsed=%lums") \
+  X(EEPROM_LOADED,      MEMORY, INFO,  "EEPROM: loaded slot %u, seq=%u") \
+  X(EEPROM_MIGRATE_V4,  MEMORY, INFO,  "EEPROM: migration v4 -> v6") \
+  X(EEPROM_MIGRATE_V3,  MEMORY, INFO,  "EEPROM: migration v3 -> v6") \
+  X(EEPROM_MIGRATE_V2,  MEMORY, INFO,  "EEPROM: migration v2 -> v6") \
+  X(EEPROM_FACTORY,     MEMORY, WARN,  "EEPROM: factory reset") \
+  X(EEPROM_SAVED,       MEMORY, DEBUG, "EEPROM: saved (rotation)") \
+  X(EEPROM_FORCE_SAVED, MEMORY, DEBUG, "EEPROM: force-saved") \
+  X(EEPROM_MIGRATE_V5,  MEMORY, INFO,  "EEPROM: migration v5 -> v6")
@@ -0,0 +1,129 @@
+#include "LoopStats.h"
+
+#if LOOP_STATS_ENABLED
+
+struct LoopWorst {
+  uint32_t us;        // время итерации
+  uint32_t phaseUs;   // из него — фаза-виновник
+  uint32_t atMs;      // millis() в конце итерации
+  uint8_t  phase;
+};
+
+static uint64_t  prevNs[PH_COUNT];      // снимок фаз PowerStats на прошлой границе
+static bool      started = false;
+static uint32_t  iterations = 0;
+static uint32_t  overruns = 0;
+static uint32_t  maxWaitUs = 0;        // самое долгое ожидание HX711 за итерацию
+static uint32_t  maxWaitAtMs = 0;
+static uint32_t  hist[LOOP_STATS_BUCKETS];
+static LoopWorst worst[LOOP_STATS_WORST];
+
+// 0: < 64 мкс; i: [2^(i+5), 2^(i+6)) мкс; последняя — всё длиннее
+static uint8_t bucketOf(uint32_t us) {
+  if (us < 64) return 0;
+  uint8_t b = (uint8_t)(31 - __builtin_clz(us) - 5);
+  return b < LOOP_STATS_BUCKETS ? b : LOOP_STATS_BUCKETS - 1;
+}
+
+static uint32_t bucketFloorUs(uint8_t b) {
+  return b ? (1UL << (b + 5)) : 0;
+}
+
+void LoopStats_Init() {
+  memset(hist, 0, sizeof(hist));
+  memset(worst, 0, sizeof(worst));
+  iterations = 0;
+  overruns   = 0;
+  maxWaitUs  = 0;
+  maxWaitAtMs = 0;
+  started    = false;
+  PowerStats_Snapshot(prevNs);
+}
+
+void LoopStats_Tick() {
+  uint64_t ns[PH_COUNT];
+  PowerStats_Snapshot(ns);
+
+  // Блокирующее время — все фазы, кроме ожиданий, в которых опрашивается кнопка
+  uint64_t busyNs = 0, topNs = 0;
+  uint8_t top = PH_OTHER;
+  for (uint8_t i = 0; i < PH_COUNT; i++) {
+    uint64_t d = ns[i] - prevNs[i];
+    if (i == PH_IDLE_DELAY || i == PH_LIGHT_SLEEP || i == PH_HX711_WAIT) continue;
+    busyNs += d;
+    if (d > topNs) { topNs = d; top = i; }
+  }
+  uint32_t waitUs = (uint32_t)((ns[PH_HX711_WAIT] - prevNs[PH_HX711_WAIT]) / 1000ULL);
+  memcpy(prevNs, ns, sizeof(prevNs));
+  if (!started) {
+    started = true;
+    return;
+  }
+  if (waitUs > maxWaitUs) {
+    maxWaitUs   = waitUs;
+    maxWaitAtMs = millis();
+  }
+
+  uint32_t us = busyNs / 1000ULL > UINT32_MAX ? UINT32_MAX : (uint32_t)(busyNs / 1000ULL);
+  iterations++;
+  hist[bucketOf(us)]++;
+  if (us > LOOP_BUDGET_MS * 1000UL) overruns++;
+
+  // Вытесняется самая короткая из худших
+  uint8_t slot = 0;
+  for (uint8_t i = 1; i < LOOP_STATS_WORST; i++) {
+    if (worst[i].us < worst[slot].us) slot = i;
+  }
+  if (us > worst[slot].us) {
+    worst[slot].us      = us;
+    worst[slot].phaseUs = (uint32_t)(topNs / 1000ULL);
+    worst[slot].atMs    = millis();
+    worst[slot].phase   = top;
+  }
+}
+
+uint32_t LoopStats_Iterations() {
+  return iterations;
+}
+
+uint32_t LoopStats_Overruns() {
+  return overruns;
+}
+
+uint32_t LoopStats_MaxHx711WaitUs() {
+  return maxWaitUs;
+}
+
+uint32_t LoopStats_Bucket(uint8_t i) {
+  return i < LOOP_STATS_BUCKETS ? hist[i] : 0;
+}
+
+void LoopStats_Dump(Print& out) {
+  out.printf("[LOOP] iterations %lu, over %u ms: %lu\n", (unsigned long)iterations,
+             (unsigned)LOOP_BUDGET_MS, (unsigned long)overruns);
+  out.printf("[LOOP] longest hx_wait %lu us at %lu ms\n", (unsigned long)maxWaitUs,
+             (unsigned long)maxWaitAtMs);
+  out.print(F("[LOOP]    from_us     count\n"));
+  for (uint8_t b = 0; b < LOOP_STATS_BUCKETS; b++) {
+    if (hist[b] == 0) continue;
+    out.printf("[LOOP] %10lu %9lu\n", (unsigned long)bucketFloorUs(b), (unsigned long)hist[b]);
+  }
+
+  // Худшие — по убыванию; таблица маленькая, копия сортируется вставками
+  LoopWorst w[LOOP_STATS_WORST];
+  memcpy(w, worst, sizeof(w));
+  for (uint8_t i = 1; i < LOOP_STATS_WORST; i++) {
+    LoopWorst x = w[i];
+    uint8_t j = i;
+    while (j > 0 && w[j - 1].us < x.us) { w[j] = w[j - 1]; j--; }
+    w[j] = x;
+  }
+  out.print(F("[LOOP] worst_us  phase    phase_us      at_ms\n"));
+  for (uint8_t i = 0; i < LOOP_STATS_WORST && w[i].us > 0; i++) {
+    out.printf("[LOOP] %8lu  %-8s %8lu %10lu\n", (unsigned long)w[i].us,
+               PowerStats_PhaseName((PowerPhase)w[i].phase),
+               (unsigned long)w[i].phaseUs, (unsigned long)w[i].atMs);
+  }
+}
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "PowerStats.h"
+
+// Задержка loop(): блокирующее время каждой итерации — сумма фаз PowerStats,
+// т.е. такты ESP.getCycleCount() по текущей частоте CPU, кроме ожиданий, в
+// которых кнопка опрашивается: idle-пауза, light sleep и готовность HX711.
+//   - гистограмма: корзина 0 — до 64 мкс, дальше по степеням двойки;
+//   - LOOP_STATS_WORST худших итераций: фаза, занявшая в итерации больше
+//     всего времени (render, i2c, eeprom, ...), и момент по millis();
+//   - счётчик итераций дольше LOOP_BUDGET_MS;
+//   - самое долгое ожидание HX711 за итерацию (таймаут АЦП виден здесь).
+// Цикл по дизайну ждёт конверсий HX711 (samplesPerRead по 100 мс) — в
+// бюджет они не входят, иначе перерасход был бы у каждой итерации.
+// Граница итераций — вызов LoopStats_Tick() в начале loop(): меряется
+// предыдущая итерация, первая после Init пропускается (неполная).
+
+#if LOOP_STATS_ENABLED
+
+void LoopStats_Init();                    // Обнулить (после PowerStats_Init)
+void LoopStats_Tick();                    // В начале каждого loop()
+uint32_t LoopStats_Iterations();          // Измерено итераций
+uint32_t LoopStats_Overruns();            // Из них дольше LOOP_BUDGET_MS
+uint32_t LoopStats_MaxHx711WaitUs();      // Самое долгое ожидание HX711 за итерацию, мкс
+uint32_t LoopStats_Bucket(uint8_t i);     // Итераций в корзине i гистограммы
+void LoopStats_Dump(Print& out);          // Гистограмма и худшие итерации
+
+#else
+
+inline void LoopStats_Init() {}
+inline void LoopStats_Tick() {}
+
+#endif
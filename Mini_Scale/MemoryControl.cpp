@@ -1,5 +1,9 @@
 #include <Arduino.h>
 #include "MemoryControl.h"
+#include "PowerStats.h"
+#include "Log.h"
+#include "Crc16.h"
+#include "ScaleControl.h"
 #include <math.h>
 #include <string.h>
 
@@ -9,6 +13,8 @@ EEPROM_Data savedData;  // Рабочая копия данных, загруж
 static unsigned long lastSaveTime = 0;
 // Снимок данных на момент последней записи (для сравнения «изменилось ли»)
 static EEPROM_Data savedSnapshot;
+static_assert(sizeof(savedData) + sizeof(savedSnapshot) <= RAM_SETTINGS_BYTES,
+              "settings copies are over their RAM budget line");
 // Текущий активный слот (0..EEPROM_SLOTS-1) — в него записываем следующий раз
 static uint8_t currentSlot = 0;
 // Монотонный счётчик записей (переполнение допустимо — используется wrap-around сравнение)
@@ -16,22 +22,9 @@ static uint8_t currentSeq = 0;
 // Флаг «данные изменены» — установить через Memory_MarkDirty(), сбрасывается при записи
 static bool isDirty = false;
 
-// Вычисление CRC16 (CRC-CCITT, полином 0x1021) для всех байт структуры кроме поля crc16
+// CRC16 всех байт структуры кроме поля crc16
 static uint16_t calcCRC16(const EEPROM_Data* data) {
-  const uint8_t* ptr = (const uint8_t*)data;
-  size_t len = offsetof(EEPROM_Data, crc16);
-  uint16_t crc = 0xFFFF;
-  for (size_t i = 0; i < len; i++) {
-    crc ^= ((uint16_t)ptr[i]) << 8;
-    for (uint8_t bit = 0; bit < 8; bit++) {
-      if (crc & 0x8000) {
-        crc = (crc << 1) ^ 0x1021;
-      } else {
-        crc = crc << 1;
-      }
-    }
-  }
-  return crc;
+  return Crc16_Update(CRC16_INIT, data, offsetof(EEPROM_Data, crc16));
 }
 
 // Адрес слота в EEPROM (слоты расположены последовательно)
@@ -47,6 +40,7 @@ static void fillDefaultSettings(EEPROM_Data* data) {
   data->auto_zero_on = DEFAULT_AUTO_ZERO_ON;
   data->units_mode = DEFAULT_UNITS_MODE;
   data->tara_lock_on = DEFAULT_TARA_LOCK_ON;
+  data->hive_interval_mode = DEFAULT_HIVE_INTERVAL_MODE;
 }
 
 // Сравнить «полезные» поля двух структур (без magic/version/seq/crc).
@@ -62,7 +56,21 @@ static bool payloadEqual(const EEPROM_Data* a, const EEPROM_Data* b) {
          a->auto_dim_mode == b->auto_dim_mode &&
          a->auto_zero_on == b->auto_zero_on &&
          a->units_mode == b->units_mode &&
-         a->tara_lock_on == b->tara_lock_on;
+         a->tara_lock_on == b->tara_lock_on &&
+         a->hive_interval_mode == b->hive_interval_mode &&
+         a->lin_zero == b->lin_zero &&
+         a->lin_span == b->lin_span &&
+         memcmp(a->lin_knots, b->lin_knots, sizeof(a->lin_knots)) == 0;
+}
+
+// Таблица поправки линейности: выключена (span = 0) или конечные значения
+static bool linearityValid(const EEPROM_Data* data) {
+  if (data->lin_span == 0.0f) return true;
+  if (isnan(data->lin_span) || isinf(data->lin_span) || data->lin_span < 0.0f) return false;
+  for (uint8_t i = 0; i <= CAL_LIN_SEGMENTS; i++) {
+    if (isnan(data->lin_knots[i]) || isinf(data->lin_knots[i])) return false;
+  }
+  return true;
 }
 
 // Проверить валидность слота текущей версии:
@@ -74,6 +82,7 @@ static bool isSlotValid(const EEPROM_Data* data) {
   if (isnan(data->cal_factor) || isinf(data->cal_factor)) return false;
   if (data->cal_factor < CAL_FACTOR_MIN || data->cal_factor > CAL_FACTOR_MAX) return false;
   if (isnan(data->last_weight) || isinf(data->last_weight)) return false;
+  if (!linearityValid(data)) return false;
   return true;
 }
 
@@ -110,21 +119,47 @@ struct EEPROM_Data_V3 {
   uint16_t crc16;
 };
 
+// v5: без поправки линейности (lin_span, lin_knots)
+struct EEPROM_Data_V5 {
+  uint32_t magic_key;
+  uint8_t  version;
+  uint8_t  slot_seq;
+  long tare_offset;
+  long backup_offset;
+  float last_weight;
+  float cal_factor;
+  float backup_last_weight;
+  uint8_t brightness_level;
+  uint8_t auto_off_mode;
+  uint8_t auto_dim_mode;
+  uint8_t auto_zero_on;
+  uint8_t units_mode;
+  uint8_t tara_lock_on;
+  uint8_t hive_interval_mode;
+  uint16_t crc16;
+};
+
+// v4: без hive_interval_mode
+struct EEPROM_Data_V4 {
+  uint32_t magic_key;
+  uint8_t  version;
+  uint8_t  slot_seq;
+  long tare_offset;
+  long backup_offset;
+  float last_weight;
+  float cal_factor;
+  float backup_last_weight;
+  uint8_t brightness_level;
+  uint8_t auto_off_mode;
+  uint8_t auto_dim_mode;
+  uint8_t auto_zero_on;
+  uint8_t units_mode;
+  uint8_t tara_lock_on;
+  uint16_t crc16;
+};
+
 static uint16_t calcCRC16_V2(const EEPROM_Data_V2* data) {
-  const uint8_t* ptr = (const uint8_t*)data;
-  size_t len = offsetof(EEPROM_Data_V2, crc16);
-  uint16_t crc = 0xFFFF;
-  for (size_t i = 0; i < len; i++) {
-    crc ^= ((uint16_t)ptr[i]) << 8;
-    for (uint8_t bit = 0; bit < 8; bit++) {
-      if (crc & 0x8000) {
-        crc = (crc << 1) ^ 0x1021;
-      } else {
-        crc = crc << 1;
-      }
-    }
-  }
-  return crc;
+  return Crc16_Update(CRC16_INIT, data, offsetof(EEPROM_Data_V2, crc16));
 }
 
 static bool isSlotValidV2(const EEPROM_Data_V2* data) {
@@ -138,17 +173,35 @@ static bool isSlotValidV2(const EEPROM_Data_V2* data) {
 }
 
 static uint16_t calcCRC16_V3(const EEPROM_Data_V3* data) {
-  const uint8_t* ptr = (const uint8_t*)data;
-  size_t len = offsetof(EEPROM_Data_V3, crc16);
-  uint16_t crc = 0xFFFF;
-  for (size_t i = 0; i < len; i++) {
-    crc ^= ((uint16_t)ptr[i]) << 8;
-    for (uint8_t bit = 0; bit < 8; bit++) {
-      if (crc & 0x8000) crc = (crc << 1) ^ 0x1021;
-      else              crc = crc << 1;
-    }
-  }
-  return crc;
+  return Crc16_Update(CRC16_INIT, data, offsetof(EEPROM_Data_V3, crc16));
+}
+
+static uint16_t calcCRC16_V4(const EEPROM_Data_V4* data) {
+  return Crc16_Update(CRC16_INIT, data, offsetof(EEPROM_Data_V4, crc16));
+}
+
+static uint16_t calcCRC16_V5(const EEPROM_Data_V5* data) {
+  return Crc16_Update(CRC16_INIT, data, offsetof(EEPROM_Data_V5, crc16));
+}
+
+static bool isSlotValidV5(const EEPROM_Data_V5* data) {
+  if (data->magic_key != MAGIC_NUMBER) return false;
+  if (data->version != 5) return false;
+  if (calcCRC16_V5(data) != data->crc16) return false;
+  if (isnan(data->cal_factor) || isinf(data->cal_factor)) return false;
+  if (data->cal_factor < CAL_FACTOR_MIN || data->cal_factor > CAL_FACTOR_MAX) return false;
+  if (isnan(data->last_weight) || isinf(data->last_weight)) return false;
+  return true;
+}
+
+static bool isSlotValidV4(const EEPROM_Data_V4* data) {
+  if (data->magic_key != MAGIC_NUMBER) return false;
+  if (data->version != 4) return false;
+  if (calcCRC16_V4(data) != data->crc16) return false;
+  if (isnan(data->cal_factor) || isinf(data->cal_factor)) return false;
+  if (data->cal_factor < CAL_FACTOR_MIN || data->cal_factor > CAL_FACTOR_MAX) return false;
+  if (isnan(data->last_weight) || isinf(data->last_weight)) return false;
+  return true;
 }
 
 static bool isSlotValidV3(const EEPROM_Data_V3* data) {
@@ -169,7 +222,10 @@ static void writeSlot(uint8_t slot) {
   savedData.crc16 = calcCRC16(&savedData);
 
   EEPROM.put(slotAddress(slot), savedData);
-  EEPROM.commit();
+  {
+    POWER_SCOPE(PH_EEPROM);
+    EEPROM.commit();
+  }
 
   memcpy(&savedSnapshot, &savedData, sizeof(EEPROM_Data));
   isDirty = false;
@@ -184,7 +240,7 @@ static void writeToNextSlot() {
 
 // Инициализация EEPROM при старте устройства.
 // Алгоритм: перебрать все слоты, найти валидный с максимальным seq.
-// Если не найдено — попробовать мигрировать из v3, v2, или factory reset.
+// Если не найдено — попробовать мигрировать из v5, v4, v3, v2, или factory reset.
 void Memory_Init() {
   EEPROM.begin(EEPROM_SIZE_COMPUTED);
 
@@ -211,12 +267,92 @@ void Memory_Init() {
       savedData.backup_last_weight = 0.0f;
     }
 
-    DEBUG_PRINT(F("EEPROM: loaded slot "));
-    DEBUG_PRINT(currentSlot);
-    DEBUG_PRINT(F(", seq="));
-    DEBUG_PRINTLN(currentSeq);
+    LOG(EEPROM_LOADED, currentSlot, currentSeq);
   } else {
-    // --- Попытка миграции v3 -> v4 ---
+    // Полей, которых нет в старых версиях, — нули: поправка линейности выключена
+    memset(&savedData, 0, sizeof(savedData));
+
+    // --- Попытка миграции v5 -> v6 ---
+    int bestSlotV5 = -1;
+    uint8_t bestSeqV5 = 0;
+    EEPROM_Data_V5 tempV5;
+
+    for (uint8_t i = 0; i < EEPROM_SLOTS; i++) {
+      EEPROM.get(i * (int)sizeof(EEPROM_Data_V5), tempV5);
+      if (isSlotValidV5(&tempV5)) {
+        if (bestSlotV5 < 0 || (uint8_t)(tempV5.slot_seq - bestSeqV5) < 128) {
+          bestSlotV5 = i;
+          bestSeqV5 = tempV5.slot_seq;
+        }
+      }
+    }
+
+    if (bestSlotV5 >= 0) {
+      EEPROM.get(bestSlotV5 * (int)sizeof(EEPROM_Data_V5), tempV5);
+      LOG(EEPROM_MIGRATE_V5);
+
+      savedData.magic_key          = MAGIC_NUMBER;
+      savedData.version            = FIRMWARE_VERSION;
+      savedData.slot_seq           = tempV5.slot_seq;
+      savedData.tare_offset        = tempV5.tare_offset;
+      savedData.backup_offset      = tempV5.backup_offset;
+      savedData.last_weight        = tempV5.last_weight;
+      savedData.cal_factor         = tempV5.cal_factor;
+      savedData.backup_last_weight = tempV5.backup_last_weight;
+      savedData.brightness_level   = tempV5.brightness_level;
+      savedData.auto_off_mode      = tempV5.auto_off_mode;
+      savedData.auto_dim_mode      = tempV5.auto_dim_mode;
+      savedData.auto_zero_on       = tempV5.auto_zero_on;
+      savedData.units_mode         = tempV5.units_mode;
+      savedData.tara_lock_on       = tempV5.tara_lock_on;
+      savedData.hive_interval_mode = tempV5.hive_interval_mode;
+
+      currentSlot = 0;
+      currentSeq  = tempV5.slot_seq;
+      writeSlot(0);
+      lastSaveTime = Scale_Millis();
+    } else {
+    // --- Попытка миграции v4 -> v6 ---
+    int bestSlotV4 = -1;
+    uint8_t bestSeqV4 = 0;
+    EEPROM_Data_V4 tempV4;
+
+    for (uint8_t i = 0; i < EEPROM_SLOTS; i++) {
+      EEPROM.get(i * (int)sizeof(EEPROM_Data_V4), tempV4);
+      if (isSlotValidV4(&tempV4)) {
+        if (bestSlotV4 < 0 || (uint8_t)(tempV4.slot_seq - bestSeqV4) < 128) {
+          bestSlotV4 = i;
+          bestSeqV4 = tempV4.slot_seq;
+        }
+      }
+    }
+
+    if (bestSlotV4 >= 0) {
+      EEPROM.get(bestSlotV4 * (int)sizeof(EEPROM_Data_V4), tempV4);
+      LOG(EEPROM_MIGRATE_V4);
+
+      savedData.magic_key          = MAGIC_NUMBER;
+      savedData.version            = FIRMWARE_VERSION;
+      savedData.slot_seq           = tempV4.slot_seq;
+      savedData.tare_offset        = tempV4.tare_offset;
+      savedData.backup_offset      = tempV4.backup_offset;
+      savedData.last_weight        = tempV4.last_weight;
+      savedData.cal_factor         = tempV4.cal_factor;
+      savedData.backup_last_weight = tempV4.backup_last_weight;
+      savedData.brightness_level   = tempV4.brightness_level;
+      savedData.auto_off_mode      = tempV4.auto_off_mode;
+      savedData.auto_dim_mode      = tempV4.auto_dim_mode;
+      savedData.auto_zero_on       = tempV4.auto_zero_on;
+      savedData.units_mode         = tempV4.units_mode;
+      savedData.tara_lock_on       = tempV4.tara_lock_on;
+      savedData.hive_interval_mode = DEFAULT_HIVE_INTERVAL_MODE;
+
+      currentSlot = 0;
+      currentSeq  = tempV4.slot_seq;
+      writeSlot(0);
+      lastSaveTime = Scale_Millis();
+    } else {
+    // --- Попытка миграции v3 -> v6 ---
     int bestSlotV3 = -1;
     uint8_t bestSeqV3 = 0;
     EEPROM_Data_V3 tempV3;
@@ -233,7 +369,7 @@ void Memory_Init() {
 
     if (bestSlotV3 >= 0) {
       EEPROM.get(bestSlotV3 * (int)sizeof(EEPROM_Data_V3), tempV3);
-      DEBUG_PRINTLN(F("EEPROM: migration v3 -> v4"));
+      LOG(EEPROM_MIGRATE_V3);
 
       savedData.magic_key          = MAGIC_NUMBER;
       savedData.version            = FIRMWARE_VERSION;
@@ -249,13 +385,14 @@ void Memory_Init() {
       savedData.auto_zero_on       = tempV3.auto_zero_on;
       savedData.units_mode         = tempV3.units_mode;
       savedData.tara_lock_on       = DEFAULT_TARA_LOCK_ON;
+      savedData.hive_interval_mode = DEFAULT_HIVE_INTERVAL_MODE;
 
       currentSlot = 0;
       currentSeq  = tempV3.slot_seq;
       writeSlot(0);
-      lastSaveTime = millis();
+      lastSaveTime = Scale_Millis();
     } else {
-    // --- Попытка миграции v2 -> v4 ---
+    // --- Попытка миграции v2 -> v6 ---
     int bestSlotV2 = -1;
     uint8_t bestSeqV2 = 0;
     EEPROM_Data_V2 tempV2;
@@ -272,7 +409,7 @@ void Memory_Init() {
 
     if (bestSlotV2 >= 0) {
       EEPROM.get(bestSlotV2 * (int)sizeof(EEPROM_Data_V2), tempV2);
-      DEBUG_PRINTLN(F("EEPROM: migration v2 -> v4"));
+      LOG(EEPROM_MIGRATE_V2);
 
       savedData.magic_key = MAGIC_NUMBER;
       savedData.version = FIRMWARE_VERSION;
@@ -287,9 +424,9 @@ void Memory_Init() {
       currentSlot = 0;
       currentSeq = tempV2.slot_seq;
       writeSlot(0);
-      lastSaveTime = millis();
+      lastSaveTime = Scale_Millis();
     } else {
-      DEBUG_PRINTLN(F("EEPROM: factory reset"));
+      LOG(EEPROM_FACTORY);
       savedData.magic_key = MAGIC_NUMBER;
       savedData.version = FIRMWARE_VERSION;
       savedData.slot_seq = 0;
@@ -303,9 +440,11 @@ void Memory_Init() {
       currentSlot = 0;
       currentSeq = 0;
       writeSlot(0);
-      lastSaveTime = millis();
+      lastSaveTime = Scale_Millis();
     }
     } // end else (no v3 found)
+    } // end else (no v4 found)
+    } // end else (no v5 found)
   }
 
   memcpy(&savedSnapshot, &savedData, sizeof(EEPROM_Data));
@@ -317,7 +456,7 @@ void Memory_MarkDirty() {
 }
 
 void Memory_Save() {
-  unsigned long now = millis();
+  unsigned long now = Scale_Millis();
   if (now - lastSaveTime < EEPROM_MIN_INTERVAL_MS) {
     return;
   }
@@ -328,7 +467,7 @@ void Memory_Save() {
 
   writeToNextSlot();
   lastSaveTime = now;
-  DEBUG_PRINTLN(F("EEPROM: saved (rotation)"));
+  LOG(EEPROM_SAVED);
 }
 
 void Memory_ForceSave() {
@@ -336,6 +475,6 @@ void Memory_ForceSave() {
     return;
   }
   writeToNextSlot();
-  lastSaveTime = millis();
-  DEBUG_PRINTLN(F("EEPROM: force-saved"));
+  lastSaveTime = Scale_Millis();
+  LOG(EEPROM_FORCE_SAVED);
 }
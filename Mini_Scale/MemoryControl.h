@@ -19,6 +19,10 @@ struct EEPROM_Data {
   uint8_t auto_zero_on;         // Авто-нуль включён? (0=нет, 1=да)
   uint8_t units_mode;           // Единицы измерения (0=кг, 1=г)
   uint8_t tara_lock_on;         // Блокировка тары включена? (0=нет, 1=да)
+  uint8_t hive_interval_mode;   // Режим улья: индекс в таблице hiveIntervalValues (0=выкл)
+  long lin_zero;                // Поправка линейности: отсчёты пустой платформы при калибровке
+  float lin_span;               // Граница таблицы поправки в кг по cal_factor (0=поправка выкл)
+  float lin_knots[CAL_LIN_SEGMENTS + 1]; // Вес в узлах таблицы поправки (CalFit.h)
   uint16_t crc16;               // Контрольная сумма CRC16 всех полей выше
 };
 
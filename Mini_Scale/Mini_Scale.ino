@@ -9,6 +9,19 @@
 #include "BatteryControl.h"
 #include "SettingsMode.h"
 #include "UiText.h"
+#include "PowerStats.h"
+#include "CpuGovernor.h"
+#include "HiveMode.h"
+#include "BootTrace.h"
+#include "Clock.h"
+#include "HistoryStore.h"
+#include "Rrd.h"
+#include "BulkExport.h"
+#include "Telemetry.h"
+#include "Log.h"
+#include "Console.h"
+#include "RamStats.h"
+#include "LoopStats.h"
 
 extern "C" {
   #include "user_interface.h"
@@ -25,7 +38,7 @@ static float prevWeight = 0.0f;
 static bool showingMessage = false;
 static unsigned long messageStartTime = 0;
 static unsigned long messageDuration = SUCCESS_MSG_MS;
-static const char* messageText = nullptr;
+static PGM_P messageText = nullptr;
 
 // Активные значения таймеров — загружаются из EEPROM через loadSettings()
 static unsigned long activeAutoOffMs = AUTO_OFF_MS;
@@ -45,6 +58,19 @@ static unsigned long lowBatteryShutdownAt = 0;
 static bool autoOffPending = false;
 static unsigned long autoOffStartedAt = 0;
 
+// Окно входа в калибровку после старта: открывается в конце setup(),
+// закрывается через CAL_ENTRY_WINDOW_MS. Пока открыто — без light sleep.
+static bool calEntryOpen = false;
+static unsigned long calEntryOpenedAt = 0;
+
+// Состояние интерфейса поверх взвешивания: главный экран или меню настроек.
+// В обоих измерение, батарея и сохранение идут каждый loop().
+enum UiMode : uint8_t {
+  UI_MAIN,
+  UI_SETTINGS
+};
+static UiMode uiMode = UI_MAIN;
+
 // Загрузить настройки из EEPROM в рабочие переменные loop().
 // Вызывается при старте и после выхода из меню настроек.
 static void loadSettings() {
@@ -60,220 +86,327 @@ static void loadSettings() {
                activeAutoOffMs, activeAutoDimMs, useGrams);
 }
 
-// Показать временное сообщение на дисплее.
+// Показать временное сообщение на дисплее (строка из flash, UiText).
 // Сообщение автоматически исчезает через durationMs миллисекунд в основном цикле.
-static void ShowTransientMessage(const char* text, unsigned long durationMs) {
+static void ShowTransientMessage(PGM_P text, unsigned long durationMs) {
   Display_ShowMessage(text);
   showingMessage = true;
   messageDuration = durationMs;
   messageStartTime = millis();
 }
 
+// ===== События кнопки =====
+// Одна точка разбора действий главного экрана — из Button_Update() и пойманных
+// во сне или чтении HX711 (Scale_GetPendingAction).
+// true — действие обработано и кадр занят сообщением или меню.
+static bool handleMainAction(ButtonAction action) {
+  switch (action) {
+    case BTN_MENU_ENTER:
+      showingMessage = false;
+      autoOffPending = false;
+      Display_SmoothWake();
+      Settings_Begin();
+      uiMode = UI_SETTINGS;
+      break;
+    case BTN_MENU_PROMPT:
+      Display_SmoothWake();
+      ShowTransientMessage(UiText::kPressAgain, MENU_CONFIRM_WINDOW_MS);
+      break;
+    case BTN_MENU_CANCEL:
+      ShowTransientMessage(UiText::kCancelled, SUCCESS_MSG_MS);
+      break;
+    case BTN_TARE:
+      messageText = Scale_Tare() ? UiText::kTareOk : UiText::kTareFailed;
+      ShowTransientMessage(messageText, SUCCESS_MSG_MS);
+      break;
+    case BTN_UNDO:
+      messageText = Scale_UndoTare() ? UiText::kUndoOk : UiText::kNoUndo;
+      ShowTransientMessage(messageText, SUCCESS_MSG_MS);
+      break;
+    case BTN_SHOW_HINT:
+      Display_SmoothWake();   // кнопка удерживается — разбудить дисплей
+      return false;
+    default:
+      return false;
+  }
+  lastActivityTime = millis();
+  return true;
+}
+
+// Шаг меню настроек; по выходу — таймеры и единицы заново и сообщение
+static void settingsStep(ButtonAction action) {
+  SettingsExit exit = Settings_Update(action);
+  if (exit == SETTINGS_OPEN) return;
+  uiMode = UI_MAIN;
+  loadSettings();
+  lastActivityTime = millis();
+  if (exit == SETTINGS_SAVED) {
+    ShowTransientMessage(UiText::kSaved, CAL_SAVED_MSG_MS);
+  } else {
+    ShowTransientMessage(UiText::kTimeout, SETTINGS_TIMEOUT_MSG_MS);
+  }
+}
+
+// Действие, пойманное внутри Scale_Update/Scale_PowerSave, иначе — опрос автомата кнопки
+static ButtonAction takeButtonAction() {
+  ButtonAction action = Scale_GetPendingAction();
+  return action != BTN_NONE ? action : Button_Update();
+}
+
+// Пауза в простое (учитывается фазой PH_IDLE_DELAY); заодно вывод отложенного лога
+static void idleDelay(unsigned long ms) {
+  POWER_SCOPE(PH_IDLE_DELAY);
+  Log_Drain();
+  delay(ms);
+}
+
+// Отрисовать главный экран по текущему состоянию весов, батареи и кнопки
+static void drawMainScreen() {
+  Display_ShowMain(Scale_GetDisplayWeight(), session_delta,
+                   Battery_GetVoltage(), Battery_GetPercent(),
+                   Scale_IsStable(), Button_IsHolding(), Button_HoldElapsed(),
+                   Battery_BlinkPhase(), Scale_IsFrozen(),
+                   Scale_IsOverloaded(), Scale_GetTrend(),
+                   useGrams);
+  BootTrace_Finish("first frame");
+}
+
+// Длительность сна в простое: ступень адаптивного опроса HX711, но не дольше,
+// чем до срабатывания auto-dim / auto-off и следующей фазы мигания батареи
+static unsigned long idleSleepMs() {
+  unsigned long ms = Scale_GetIdleIntervalMs();
+  unsigned long idle = millis() - lastActivityTime;
+  if (!Display_IsDimmed() && activeAutoDimMs > idle) {
+    ms = min(ms, activeAutoDimMs - idle + 1);
+  }
+  if (activeAutoOffMs > 0 && activeAutoOffMs > idle) {
+    ms = min(ms, activeAutoOffMs - idle + 1);
+  }
+  if (Battery_GetPercent() < BAT_LOW_PERCENT) {
+    ms = min(ms, (unsigned long)BLINK_INTERVAL_MS);
+  }
+  unsigned long banner = Display_BannerMsLeft();
+  if (banner > 0) {
+    ms = min(ms, banner + 1);
+  }
+  return max(ms, (unsigned long)LOOP_DELAY_IDLE_MS);
+}
+
 // -------------------------------------------------------
 // setup
 // -------------------------------------------------------
-// Порядок инициализации:
-//   1. WiFi off (снижение потребления)
-//   2. Serial, Button, Display
-//   3. Memory_Init — загрузка EEPROM (или factory reset)
-//   4. Battery_Init — первое считывание АЦП батареи
-//   5. Scale_Init — загрузка offset/cal_factor, вычисление session_delta
-//   6. ApplySettings / loadSettings — применить яркость, auto-zero, таймеры
-//   7. Smart Start — показать дельту веса если улей изменился
-//   8. Окно входа в калибровку (CAL_ENTRY_WINDOW_MS после старта)
+// Порядок инициализации (быстрый старт — ничего не ждёт, кроме HX711):
+//   1. WiFi off (снижение потребления), режим улья
+//   2. Scale_Begin — питание HX711, дальше установление идёт параллельно
+//   3. Serial, Button, Display + заставка с прогрессом
+//   4. Memory_Init — загрузка EEPROM (или factory reset)
+//   5. Battery_Init — первое считывание АЦП батареи
+//   6. Scale_Init — остаток установления, offset/cal_factor, session_delta
+//   7. ApplySettings / loadSettings — применить яркость, auto-zero, таймеры
+//   8. Баннер поверх живого экрана: дельта Smart Start или версия прошивки
+//   9. Открыть окно входа в калибровку (обрабатывается в loop)
+// Время этапов — BootTrace, дамп по команде b консоли.
 // -------------------------------------------------------
 void setup() {
-  // Отключаем WiFi — он не используется, но потребляет ток
+  BootTrace_Mark("reset");
+
+  // Отключаем WiFi: потребляет ток, а выгрузка (Uplink) включает радио сама
   WiFi.mode(WIFI_OFF);
   WiFi.forceSleepBegin();
   delay(1);
 
+  Clock_Init();
+  Rrd_Load();
+
+  // Пробуждение по таймеру режима улья: измерить и снова уснуть, без дисплея.
+  // Возврат сюда — режим выключен или нажата кнопка: обычный старт.
+  if (Hive_IsTimerWake()) Hive_RunHeadless();
+
+  Scale_Begin();
+  BootTrace_Mark("hx711 power");
+
   Serial.begin(SERIAL_BAUD);
-  delay(500);
+  PowerStats_Init();
+  LoopStats_Init();
+  CpuGov_Init();
 
   Button_Init();
   Display_Init();
 
   Display_Splash("Mini Scale");
   Display_Progress(20);
+  BootTrace_Mark("display");
 
   Memory_Init();
   Display_Progress(40);
+  BootTrace_Mark("eeprom");
 
   Battery_Init();
   Display_Progress(60);
+  BootTrace_Mark("battery");
 
   // Запоминаем эталонный вес ДО Scale_Init, чтобы сравнить с текущим (Smart Start)
   float smartStartRef = savedData.last_weight;
 
   Scale_Init();
   Display_Progress(100);
+  BootTrace_Mark("scale");
 
   ApplySettings();
   loadSettings();
 
-  Display_SplashFull("Mini Scale", FW_VERSION_STR,
-                     Battery_GetVoltage(), Battery_GetPercent());
-  delay(1500);
-
   // ===== Smart Start =====
   // Если вес улья изменился на >= SMART_START_MIN_DELTA кг с момента последнего выключения,
-  // показываем дельту: положительная = прибавка (мёд), отрицательная = убыль (рой/отбор)
+  // показываем дельту: положительная = прибавка (мёд), отрицательная = убыль (рой/отбор).
+  // Иначе — версия прошивки. Оба баннера поверх живого экрана, setup() не ждёт.
   if (!isnan(smartStartRef) && !isinf(smartStartRef) &&
       fabs(smartStartRef) > 0.001f &&
-      current_weight > WEIGHT_ERROR_THRESHOLD &&
-      fabs(current_weight - smartStartRef) >= SMART_START_MIN_DELTA) {
+      Scale_GetWeight() > WEIGHT_ERROR_THRESHOLD &&
+      fabs(Scale_GetWeight() - smartStartRef) >= SMART_START_MIN_DELTA) {
     char smartBuf[20];
-    snprintf(smartBuf, sizeof(smartBuf), "VES: %+.2f kg", current_weight - smartStartRef);
-    Display_ShowMessage(smartBuf);
-    delay(3000);
+    snprintf(smartBuf, sizeof(smartBuf), "VES: %+.2f kg", Scale_GetWeight() - smartStartRef);
+    Display_SetBanner(smartBuf, SMART_START_BANNER_MS);
+  } else {
+    Display_SetBanner("Mini Scale " FW_VERSION_STR, SPLASH_BANNER_MS);
   }
 
   // ===== Окно входа в режим калибровки =====
-  // Если кнопка нажата в течение CAL_ENTRY_WINDOW_MS после старта — входим в калибровку
-  unsigned long waitStart = millis();
-  bool enterCal = false;
-  while (millis() - waitStart < CAL_ENTRY_WINDOW_MS) {
-    if (digitalRead(BUTTON_PIN) == LOW) {
-      delay(DEBOUNCE_MS);
-      if (digitalRead(BUTTON_PIN) == LOW) {
-        enterCal = true;
-        break;
-      }
-    }
-    delay(10);
-  }
-  if (enterCal) {
-    RunCalibrationMode(); // не возвращается — завершается через ESP.restart()
-  }
+  // Нажатие кнопки в течение CAL_ENTRY_WINDOW_MS после старта — калибровка (см. loop)
+  calEntryOpen = true;
+  calEntryOpenedAt = Scale_Millis();
 
   lastActivityTime = millis();
+  BootTrace_Mark("setup done");
+
+  // Первый кадр — сразу по стартовому измерению, не дожидаясь серии в loop()
+  drawMainScreen();
 }
 
 // -------------------------------------------------------
 // loop
 // -------------------------------------------------------
 // Структура каждой итерации:
-//   1. WDT + fade-анимация дисплея
+//   1. WDT, граница итерации (LoopStats), замер кучи, консоль (с шагом выгрузки h/x/uplink), fade-анимация; в режиме калибровки — только Calibration_Update,
+//      во время замера cal из консоли — только Console_Measure
 //   2. Ожидание завершения отложенного выключения (low battery)
-//   3. Scale_Update — новое значение веса
+//   3. Scale_Update — новое значение веса (кнопка опрашивается и в ожидании DOUT)
 //   4. Battery_Update — проверка заряда
-//   5. Button_Update — опрос кнопки, обработка действий
-//   6. Управление временным сообщением на дисплее
-//   7. Отрисовка главного экрана (пропускается если дисплей затемнён и вес стабилен)
-//   8. Memory_Save — отложенное сохранение веса в EEPROM
-//   9. Auto-dim / Auto-off
-//  10. Light sleep если вес стабилен (Scale_PowerSave) + обработка pending action
+//   5. Memory_Save — отложенное сохранение веса в EEPROM
+//   6. Меню настроек (uiMode == UI_SETTINGS): шаг меню и пауза — дальше не идём
+//   7. Действие кнопки (handleMainAction) — меню, тара, сообщения
+//   8. Управление временным сообщением на дисплее
+//   9. Отрисовка главного экрана (пропускается если дисплей затемнён и вес стабилен)
+//  10. Auto-dim / Auto-off
+//  11. Light sleep если вес стабилен и консоль свободна (Scale_PowerSave) + действие, пойманное во сне
 // -------------------------------------------------------
 void loop() {
   ESP.wdtFeed();
+  LoopStats_Tick();
+  RamStats_Sample();
+  Console_Poll(Serial);
+  if (Console_TakeSettingsChanged()) loadSettings();
   Display_FadeUpdate(); // один шаг неблокирующей анимации яркости
 
+  // ===== Замер калибровки из консоли =====
+  // Конверсии HX711 без ожидания — замеру; взвешивание ждёт его окончания
+  if (Console_IsMeasuring()) {
+    Console_Measure(Serial);
+    idleDelay(CAL_LOOP_DELAY_MS);
+    return;
+  }
+
+  // ===== Режим калибровки =====
+  // Свой автомат кнопки и опрос HX711 без ожидания; главный экран не работает
+  if (Calibration_IsActive()) {
+    Calibration_Update();
+    idleDelay(CAL_LOOP_DELAY_MS);
+    return;
+  }
+
   // ===== Ожидание выключения (low battery) =====
   // После установки флага ждём до lowBatteryShutdownAt, затем deepSleep
   if (lowBatteryShutdownPending) {
-    if ((long)(millis() - lowBatteryShutdownAt) >= 0) {
+    if ((long)(Scale_Millis() - lowBatteryShutdownAt) >= 0) {
       Display_Off();
-      ESP.deepSleep(0);
+      Hive_Shutdown();
     }
-    delay(LOOP_DELAY_MS);
+    idleDelay(LOOP_DELAY_MS);
     return;
   }
 
+  // ===== Окно входа в калибровку =====
+  // Проверяется до Button_Update: нажатие в окне не должно стать действием главного экрана
+  if (calEntryOpen) {
+    if (Scale_Millis() - calEntryOpenedAt >= CAL_ENTRY_WINDOW_MS) {
+      calEntryOpen = false;
+    } else if (digitalRead(BUTTON_PIN) == LOW) {
+      delay(DEBOUNCE_MS);
+      if (digitalRead(BUTTON_PIN) == LOW) {
+        calEntryOpen = false;
+        Calibration_Begin(); // дальше loop() работает в режиме калибровки до перезагрузки
+        return;
+      }
+    }
+  }
+
   // ===== Обновление датчиков =====
   Scale_Update();
 
   // Обновляем lastActivityTime при изменении веса (сбрасывает таймеры dim/off)
-  if (current_weight > WEIGHT_ERROR_THRESHOLD &&
-      fabs(current_weight - prevWeight) > WEIGHT_CHANGE_THRESHOLD) {
+  if (Scale_GetWeight() > WEIGHT_ERROR_THRESHOLD &&
+      fabs(Scale_GetWeight() - prevWeight) > WEIGHT_CHANGE_THRESHOLD) {
     lastActivityTime = millis();
-    prevWeight = current_weight;
+    prevWeight = Scale_GetWeight();
   }
 
   Battery_Update();
 
   // ===== Критический заряд батареи =====
   if (!lowBatteryShutdownPending && Battery_IsCritical()) {
+    if (uiMode == UI_SETTINGS) {
+      Settings_Cancel();
+      uiMode = UI_MAIN;
+    }
     Display_Wake();
     Display_ShowMessage(UiText::kLowBattery);
     Memory_ForceSave();
     lowBatteryShutdownPending = true;
-    lowBatteryShutdownAt = millis() + 3000UL;
+    lowBatteryShutdownAt = Scale_Millis() + 3000UL;
     return;
   }
 
-  // ===== Обработка кнопки =====
-  ButtonAction action = Button_Update();
-
-  if (action == BTN_MENU_ENTER) {
-    showingMessage = false;
-    autoOffPending = false;
-    Display_SmoothWake();
-    RunSettingsMode();
-    loadSettings(); // перезагружаем таймеры и единицы после возможных изменений
-    lastActivityTime = millis();
-    return;
+  // ===== Отложенное сохранение веса в EEPROM =====
+  if (Scale_GetWeight() > WEIGHT_ERROR_THRESHOLD) {
+    savedData.last_weight = Scale_GetWeight();
+    Memory_Save(); // троттлинг внутри — не чаще EEPROM_MIN_INTERVAL_MS
   }
 
-  if (action == BTN_MENU_CANCEL) {
-    showingMessage = false;
-    ShowTransientMessage(UiText::kCancelled, SUCCESS_MSG_MS);
-    lastActivityTime = millis();
+  // ===== Меню настроек =====
+  // Взвешивание выше уже прошло; меню только обрабатывает кнопку и рисует себя
+  if (uiMode == UI_SETTINGS) {
+    settingsStep(takeButtonAction());
+    idleDelay(LOOP_DELAY_MS);
     return;
   }
 
+  // ===== Обработка кнопки =====
+  if (handleMainAction(takeButtonAction())) return;
+
   // ===== Управление временным сообщением =====
   if (showingMessage) {
     if (millis() - messageStartTime >= messageDuration) {
       showingMessage = false; // время вышло — возвращаемся к главному экрану
     } else {
       Display_CheckDim(lastActivityTime, activeAutoDimMs);
-      delay(LOOP_DELAY_MS);
+      idleDelay(LOOP_DELAY_MS);
       return;
     }
   }
 
-  if (action == BTN_MENU_PROMPT) {
-    Display_SmoothWake();
-    ShowTransientMessage(UiText::kPressAgain, MENU_CONFIRM_WINDOW_MS);
-    lastActivityTime = millis();
-    return;
-  } else if (action == BTN_TARE) {
-    messageText = Scale_Tare() ? UiText::kTareOk : UiText::kTareFailed;
-    ShowTransientMessage(messageText, SUCCESS_MSG_MS);
-    lastActivityTime = millis();
-    return;
-  } else if (action == BTN_UNDO) {
-    messageText = Scale_UndoTare() ? UiText::kUndoOk : UiText::kNoUndo;
-    ShowTransientMessage(messageText, SUCCESS_MSG_MS);
-    lastActivityTime = millis();
-    return;
-  }
-
-  // Любое другое действие кнопки (BTN_SHOW_HINT) — разбудить дисплей
-  if (action != BTN_NONE) {
-    Display_SmoothWake();
-  }
-
   // ===== Отрисовка главного экрана =====
   // Пропускаем если дисплей затемнён и вес стабилен — экономим CPU/I2C
   if (!(Display_IsDimmed() && Scale_IsStable() && !Button_IsHolding())) {
-    bool stable = Scale_IsStable();
-    bool btnHolding = Button_IsHolding();
-    unsigned long btnElapsed = Button_HoldElapsed();
-
-    Display_ShowMain(display_weight, session_delta,
-                     Battery_GetVoltage(), Battery_GetPercent(),
-                     stable, btnHolding, btnElapsed,
-                     Battery_BlinkPhase(), Scale_IsFrozen(),
-                     Scale_IsOverloaded(), Scale_GetTrend(),
-                     useGrams);
-  }
-
-  // ===== Отложенное сохранение веса в EEPROM =====
-  if (current_weight > WEIGHT_ERROR_THRESHOLD) {
-    savedData.last_weight = current_weight;
-    Memory_Save(); // троттлинг внутри — не чаще EEPROM_MIN_INTERVAL_MS
+    drawMainScreen();
   }
 
   Display_CheckDim(lastActivityTime, activeAutoDimMs);
@@ -304,44 +437,29 @@ void loop() {
 
     if (millis() - autoOffStartedAt >= AUTO_OFF_MSG_MS) {
       Display_Off();
-      ESP.deepSleep(0);
+      Hive_PowerOff();
     }
 
-    delay(LOOP_DELAY_MS);
+    idleDelay(LOOP_DELAY_MS);
     return;
   }
 
   // ===== Light sleep если вес стабилен =====
-  // Scale_PowerSave опрашивает кнопку внутри цикла сна.
-  // Нельзя повторно вызвать Button_Update() для обработки — состояние автомата
-  // уже изменилось внутри PowerSave. Поэтому используем pendingAction.
-  if (Scale_IsIdle() && !Button_IsHolding()) {
-    Scale_PowerSave(LOOP_DELAY_IDLE_MS);
-    ButtonAction sleepAction = Scale_GetPendingAction();
-    if (sleepAction == BTN_MENU_ENTER) {
-      showingMessage = false;
-      autoOffPending = false;
-      Display_SmoothWake();
-      RunSettingsMode();
-      loadSettings();
-      lastActivityTime = millis();
-    } else if (sleepAction == BTN_TARE) {
-      messageText = Scale_Tare() ? UiText::kTareOk : UiText::kTareFailed;
-      ShowTransientMessage(messageText, SUCCESS_MSG_MS);
-      lastActivityTime = millis();
-    } else if (sleepAction == BTN_UNDO) {
-      messageText = Scale_UndoTare() ? UiText::kUndoOk : UiText::kNoUndo;
-      ShowTransientMessage(messageText, SUCCESS_MSG_MS);
-      lastActivityTime = millis();
-    } else if (sleepAction == BTN_MENU_PROMPT) {
-      Display_SmoothWake();
-      ShowTransientMessage(UiText::kPressAgain, MENU_CONFIRM_WINDOW_MS);
-      lastActivityTime = millis();
-    } else if (sleepAction == BTN_MENU_CANCEL) {
-      ShowTransientMessage(UiText::kCancelled, SUCCESS_MSG_MS);
-      lastActivityTime = millis();
-    }
+  // Scale_PowerSave опрашивает кнопку внутри цикла сна. Нельзя повторно вызвать
+  // Button_Update() — состояние автомата уже изменилось внутри PowerSave,
+  // поэтому пойманное действие забирается через Scale_GetPendingAction().
+  // Выгрузка из консоли идёт по шагу за итерацию — сон её бы растянул
+  if (!calEntryOpen && Scale_IsIdle() && !Button_IsHolding() && !Console_IsBusy()) {
+    Log_Drain();
+    Scale_PowerSave(idleSleepMs());
+    // millis() стоит во время forced light sleep — сдвигаем точку отсчёта
+    // таймеров auto-dim/auto-off на неучтённое время сна (интервалы батареи,
+    // EEPROM и auto-zero считаются по Scale_Millis и поправки не требуют)
+    unsigned long lag = Scale_TakeMillisLag();
+    lastActivityTime -= lag;
+    Clock_AddSleptMs(lag);
+    handleMainAction(Scale_GetPendingAction());
   } else {
-    delay(LOOP_DELAY_MS);
+    idleDelay(LOOP_DELAY_MS);
   }
 }
@@ -0,0 +1,127 @@
+#include "PowerStats.h"
+
+#if POWER_STATS_ENABLED
+
+#include <Arduino.h>
+
+// Названия фаз для дампа (порядок = enum PowerPhase)
+static const char* const phaseNames[PH_COUNT] = {
+  "other", "hx_wait", "hx_read", "filter", "render",
+  "i2c", "eeprom", "sleep", "idle"
+};
+
+// Ток системы в каждой фазе, мА — начальные значения из Config.h
+static float phaseMa[PH_COUNT] = {
+  POWER_MA_OTHER, POWER_MA_HX711_WAIT, POWER_MA_HX711_READ, POWER_MA_FILTER,
+  POWER_MA_RENDER, POWER_MA_I2C_FLUSH, POWER_MA_EEPROM, POWER_MA_LIGHT_SLEEP,
+  POWER_MA_IDLE_DELAY
+};
+
+// Накопленное время по фазам, нс (такты пересчитываются по текущей частоте CPU)
+static uint64_t phaseNs[PH_COUNT];
+// Время работы CPU на базовой и повышенной частоте, нс
+static uint64_t baseNs  = 0;
+static uint64_t boostNs = 0;
+
+// Стек открытых фаз: время всегда идёт верхней, при пустом стеке — PH_OTHER
+static PowerPhase phaseStack[POWER_STATS_DEPTH];
+static uint8_t    phaseDepth = 0;
+
+// Значение ESP.getCycleCount() в момент последнего начисления
+static uint32_t lastCycles = 0;
+
+// Начислить такты с lastCycles текущей фазе.
+// Переполнение CCOUNT (~53 с на 80 МГц) — интервалы между начислениями короче.
+// Частота должна быть той, на которой такты набраны — поэтому перед её сменой
+// вызывается PowerStats_OnCpuFreqChange().
+static void charge() {
+  uint32_t now = ESP.getCycleCount();
+  uint32_t elapsed = now - lastCycles;
+  lastCycles = now;
+  PowerPhase top = phaseDepth ? phaseStack[phaseDepth - 1] : PH_OTHER;
+  uint8_t mhz = ESP.getCpuFreqMHz();
+  uint64_t ns = (uint64_t)elapsed * 1000ULL / mhz;
+  phaseNs[top] += ns;
+  if (mhz > 80) boostNs += ns;
+  else          baseNs  += ns;
+}
+
+void PowerStats_Init() {
+  memset(phaseNs, 0, sizeof(phaseNs));
+  baseNs     = 0;
+  boostNs    = 0;
+  phaseDepth = 0;
+  lastCycles = ESP.getCycleCount();
+}
+
+void PowerStats_Begin(PowerPhase phase) {
+  charge();
+  if (phaseDepth < POWER_STATS_DEPTH) {
+    phaseStack[phaseDepth] = phase;
+  }
+  phaseDepth++;
+}
+
+void PowerStats_End() {
+  charge();
+  if (phaseDepth > 0) phaseDepth--;
+}
+
+void PowerStats_AddSleepUs(uint32_t us) {
+  charge();
+  phaseNs[PH_LIGHT_SLEEP] += (uint64_t)us * 1000ULL;
+}
+
+void PowerStats_OnCpuFreqChange() {
+  charge();
+}
+
+void PowerStats_SetCurrentMa(PowerPhase phase, float ma) {
+  if (phase < PH_COUNT && ma >= 0.0f) phaseMa[phase] = ma;
+}
+
+float PowerStats_GetMah() {
+  charge();
+  float mah = 0.0f;
+  for (uint8_t i = 0; i < PH_COUNT; i++) {
+    mah += (float)(phaseNs[i] / 1000000ULL) / 3600000.0f * phaseMa[i];
+  }
+  mah += (float)(boostNs / 1000000ULL) / 3600000.0f * POWER_MA_BOOST_EXTRA;
+  return mah;
+}
+
+void PowerStats_Snapshot(uint64_t* ns) {
+  charge();
+  memcpy(ns, phaseNs, sizeof(phaseNs));
+}
+
+const char* PowerStats_PhaseName(PowerPhase phase) {
+  return phase < PH_COUNT ? phaseNames[phase] : "?";
+}
+
+void PowerStats_Dump() {
+  float mah = PowerStats_GetMah();
+  uint64_t totalNs = 0;
+  for (uint8_t i = 0; i < PH_COUNT; i++) totalNs += phaseNs[i];
+  unsigned long totalMs = (unsigned long)(totalNs / 1000000ULL);
+
+  Serial.println(F("[PWR] phase      time_ms   share    mA      mAh"));
+  for (uint8_t i = 0; i < PH_COUNT; i++) {
+    unsigned long ms = (unsigned long)(phaseNs[i] / 1000000ULL);
+    float share = totalMs ? (100.0f * ms / totalMs) : 0.0f;
+    Serial.printf("[PWR] %-8s %9lu  %5.1f%%  %5.2f  %8.4f\n",
+                  phaseNames[i], ms, share, phaseMa[i],
+                  ms / 3600000.0f * phaseMa[i]);
+  }
+  Serial.printf("[PWR] cpu 80 MHz %lu ms, 160 MHz %lu ms\n",
+                (unsigned long)(baseNs / 1000000ULL), (unsigned long)(boostNs / 1000000ULL));
+  float avgMa = totalMs ? (mah * 3600000.0f / totalMs) : 0.0f;
+  Serial.printf("[PWR] total %lu ms, %.4f mAh, avg %.2f mA", totalMs, mah, avgMa);
+  if (avgMa > 0.0f) {
+    Serial.printf(", %u mAh -> %.1f h", (unsigned)BAT_CAPACITY_MAH,
+                  BAT_CAPACITY_MAH / avgMa);
+  }
+  Serial.println();
+}
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include "Config.h"
+
+// Фазы loop() для учёта времени и расхода энергии.
+// Время «исключающее»: вложенная фаза (I2C внутри отрисовки) вычитается из внешней.
+enum PowerPhase {
+  PH_OTHER,        // Прочая работа CPU вне размеченных фаз
+  PH_HX711_WAIT,   // Ожидание готовности HX711 (DOUT)
+  PH_HX711_READ,   // Побитовое чтение 24 бит (shift-out)
+  PH_FILTER,       // Медиана, EMA, стабильность, тренд, авто-нуль
+  PH_RENDER,       // Отрисовка кадра в буфер
+  PH_I2C_FLUSH,    // Передача кадра на SSD1306
+  PH_EEPROM,       // EEPROM.commit() — стирание и запись сектора
+  PH_LIGHT_SLEEP,  // Forced light sleep (время по RTC)
+  PH_IDLE_DELAY,   // delay() в простое
+  PH_COUNT
+};
+
+#if POWER_STATS_ENABLED
+
+void PowerStats_Init();                             // Обнулить счётчики и начать учёт
+void PowerStats_Begin(PowerPhase phase);            // Вход в фазу
+void PowerStats_End();                              // Выход из текущей фазы
+void PowerStats_AddSleepUs(uint32_t us);            // Учесть сон (счётчик тактов стоит)
+void PowerStats_SetCurrentMa(PowerPhase phase, float ma); // Подстроить ток фазы
+void PowerStats_OnCpuFreqChange();                  // Вызывать перед сменой частоты CPU
+float PowerStats_GetMah();                          // Оценка расхода с момента Init (мА·ч)
+void PowerStats_Dump();                             // Таблица по фазам в Serial
+void PowerStats_Snapshot(uint64_t* ns);             // Накопленное время фаз, нс (PH_COUNT значений)
+const char* PowerStats_PhaseName(PowerPhase phase); // Имя фазы из таблицы дампа
+
+// Фаза на время жизни блока: { POWER_SCOPE(PH_RENDER); ... }
+class PowerScope {
+public:
+  explicit PowerScope(PowerPhase phase) { PowerStats_Begin(phase); }
+  ~PowerScope() { PowerStats_End(); }
+};
+#define POWER_SCOPE(phase) PowerScope _powerScope(phase)
+
+#else
+
+inline void PowerStats_Init() {}
+inline void PowerStats_AddSleepUs(uint32_t) {}
+inline void PowerStats_OnCpuFreqChange() {}
+#define POWER_SCOPE(phase)
+
+#endif
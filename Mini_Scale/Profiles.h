@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+
+// Профили применения: окна и пороги цепочки фильтров веса (ScalePipeline) и
+// темп опроса HX711. Профиль выбирается при сборке (MINI_SCALE_PROFILE, Config.h)
+// и подставляется в шаблоны как тип: значения — константы времени компиляции,
+// в прошивку попадает только выбранный набор. Остальные профили собираются
+// на хосте (host/build/pipeline_bench: время до стабильности и шум каждого).
+//
+// Шум модели HX711 — СКО 4 отсчёта на конверсию, около 1.8 г при
+// DEFAULT_CALIBRATION; пороги стабильности — с запасом к шуму после фильтров.
+
+// Улей: медленно меняющийся вес до 5 кг, энергосбережение важнее отклика;
+// показание с точностью 10 г
+struct HiveProfile {
+  static constexpr const char* name = "hive";
+  static constexpr uint8_t  medianWindow       = 3;
+  static constexpr uint8_t  stabilityWindow    = 8;
+  static constexpr float    emaAlpha           = 0.3f;
+  static constexpr float    stabilityThreshold = 0.03f;   // кг, размах окна
+  static constexpr float    freezeThreshold    = 0.02f;   // кг, выход из заморозки
+  static constexpr float    trendThreshold     = 0.03f;   // кг за отсчёт
+  static constexpr float    overloadKg         = 5.0f;
+  static constexpr float    displayScale       = 100.0f;  // 1/шаг показания, кг
+  static constexpr uint8_t  samplesPerRead     = 3;       // конверсий HX711 на отсчёт
+  static constexpr uint16_t loopDelayMs        = 30;
+};
+
+// Кухня: быстрый отклик на каждую конверсию, показание с точностью 1 г
+struct KitchenProfile {
+  static constexpr const char* name = "kitchen";
+  static constexpr uint8_t  medianWindow       = 3;
+  static constexpr uint8_t  stabilityWindow    = 4;
+  static constexpr float    emaAlpha           = 0.5f;
+  static constexpr float    stabilityThreshold = 0.005f;
+  static constexpr float    freezeThreshold    = 0.004f;
+  static constexpr float    trendThreshold     = 0.003f;
+  static constexpr float    overloadKg         = 5.0f;
+  static constexpr float    displayScale       = 1000.0f;
+  static constexpr uint8_t  samplesPerRead     = 1;
+  static constexpr uint16_t loopDelayMs        = 10;
+};
+
+// Лаборатория: разрешение важнее отклика — длинное усреднение и окна,
+// показание с точностью 0,1 г
+struct LabProfile {
+  static constexpr const char* name = "lab";
+  static constexpr uint8_t  medianWindow       = 5;
+  static constexpr uint8_t  stabilityWindow    = 16;
+  static constexpr float    emaAlpha           = 0.2f;
+  static constexpr float    stabilityThreshold = 0.001f;
+  static constexpr float    freezeThreshold    = 0.0005f;
+  static constexpr float    trendThreshold     = 0.0005f;
+  static constexpr float    overloadKg         = 5.0f;
+  static constexpr float    displayScale       = 10000.0f;
+  static constexpr uint8_t  samplesPerRead     = 8;
+  static constexpr uint16_t loopDelayMs        = 30;
+};
+
+#define PROFILE_HIVE     0
+#define PROFILE_KITCHEN  1
+#define PROFILE_LAB      2
+
+#if !defined(MINI_SCALE_PROFILE) || MINI_SCALE_PROFILE == PROFILE_HIVE
+typedef HiveProfile ScaleProfile;
+#elif MINI_SCALE_PROFILE == PROFILE_KITCHEN
+typedef KitchenProfile ScaleProfile;
+#elif MINI_SCALE_PROFILE == PROFILE_LAB
+typedef LabProfile ScaleProfile;
+#else
+#error "MINI_SCALE_PROFILE: PROFILE_HIVE, PROFILE_KITCHEN or PROFILE_LAB"
+#endif
@@ -0,0 +1,26 @@
+#include "RamStats.h"
+
+static uint32_t minFreeHeap = UINT32_MAX;
+
+void RamStats_Sample() {
+  uint32_t heap = ESP.getFreeHeap();
+  if (heap < minFreeHeap) minFreeHeap = heap;
+}
+
+uint32_t RamStats_MinFreeHeap() {
+  return minFreeHeap;
+}
+
+void RamStats_Report(Print& out) {
+  RamStats_Sample();
+  uint32_t stack = ESP.getFreeContStack();
+  out.printf("ram budget=%u buffers=%u reserve=%u frame=%u\n",
+             (unsigned)RAM_STATIC_BUDGET, (unsigned)RAM_BUFFERS_BYTES,
+             (unsigned)(RAM_RESERVE_HISTORY + RAM_RESERVE_TELEMETRY), (unsigned)RAM_FRAME_BYTES);
+  out.printf("heap free=%lu min=%lu max_block=%lu%s\n",
+             (unsigned long)ESP.getFreeHeap(), (unsigned long)minFreeHeap,
+             (unsigned long)ESP.getMaxFreeBlockSize(),
+             minFreeHeap < RAM_HEAP_LOW_BYTES ? " LOW" : "");
+  out.printf("stack free_min=%lu%s\n", (unsigned long)stack,
+             stack < RAM_STACK_LOW_BYTES ? " LOW" : "");
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Память во время работы: наименьшая свободная куча за всё время с
+// запуска и наименьший свободный стек loop(). Ядро ESP8266 красит стек
+// при старте, ESP.getFreeContStack() — уже минимум. Кучу видно только в
+// точках замера: каждый loop() и сразу после подключения выгрузки по WiFi,
+// когда её занято больше всего. Статический бюджет — раздел RAM в Config.h.
+
+void RamStats_Sample();            // Замер свободной кучи (быстрый, без обхода списка блоков)
+uint32_t RamStats_MinFreeHeap();   // Наименьшая свободная куча с запуска, байт
+void RamStats_Report(Print& out);  // Бюджет, куча и стек — в консоль (mem)
@@ -0,0 +1,195 @@
+#include "Rrd.h"
+#include "Crc16.h"
+#include "HistoryStore.h"
+#include <stddef.h>
+
+// Открытые часовой и суточный интервалы в RTC-памяти
+struct RrdRtc {
+  RrdBucket hour;
+  RrdBucket day;
+  uint16_t  version;
+  uint16_t  crc16;
+};
+
+#define RRD_MINUTE_SECTORS FLASH_RING_SECTORS(RRD_MINUTE_KEEP_HOURS * 60UL, sizeof(RrdBucket))
+#define RRD_HOUR_SECTORS   FLASH_RING_SECTORS(RRD_HOUR_KEEP_DAYS * 24UL, sizeof(RrdBucket))
+#define RRD_DAY_SECTORS    FLASH_RING_SECTORS(RRD_DAY_KEEP_DAYS, sizeof(RrdBucket))
+
+#define RRD_MINUTE_ADDR    HISTORY_END_ADDR
+#define RRD_HOUR_ADDR      (RRD_MINUTE_ADDR + RRD_MINUTE_SECTORS * FLASH_RING_SECTOR_SIZE)
+#define RRD_DAY_ADDR       (RRD_HOUR_ADDR + RRD_HOUR_SECTORS * FLASH_RING_SECTOR_SIZE)
+#define RRD_END_ADDR       (RRD_DAY_ADDR + RRD_DAY_SECTORS * FLASH_RING_SECTOR_SIZE)
+
+static_assert(sizeof(RrdBucket) == 16, "RrdBucket is part of the flash format");
+static_assert(FLASH_RING_HEADER_SIZE % sizeof(RrdBucket) == 0, "buckets must stay aligned");
+static_assert(sizeof(RrdRtc) % 4 == 0, "RTC memory is word-addressed");
+static_assert(RRD_RTC_OFFSET + sizeof(RrdRtc) / 4 <= SCALE_RTC_OFFSET,
+              "RRD block overlaps the filter snapshot");
+
+static const uint32_t periods[RRD_TIERS] = { 60UL, 3600UL, 86400UL };
+
+static FlashRing rings[RRD_TIERS] = {
+  FLASH_RING(RRD_MINUTE_ADDR, RRD_MINUTE_SECTORS, sizeof(RrdBucket), RRD_VERSION, RRD_MINUTE_MAGIC),
+  FLASH_RING(RRD_HOUR_ADDR, RRD_HOUR_SECTORS, sizeof(RrdBucket), RRD_VERSION, RRD_HOUR_MAGIC),
+  FLASH_RING(RRD_DAY_ADDR, RRD_DAY_SECTORS, sizeof(RrdBucket), RRD_VERSION, RRD_DAY_MAGIC),
+};
+
+static RrdBucket openBuckets[RRD_TIERS];
+static_assert(sizeof(rings) + sizeof(openBuckets) <= RAM_RRD_BYTES, "RRD state is over its RAM budget line");
+static bool loaded = false;
+
+static bool regionFits() {
+  return FS_PHYS_SIZE >= RRD_END_ADDR - FS_PHYS_ADDR;
+}
+
+// CRC16 блока без поля crc16
+static uint16_t rtcCRC16(const RrdRtc* rtc) {
+  return Crc16_Update(CRC16_INIT, rtc, offsetof(RrdRtc, crc16));
+}
+
+static void writeRtc() {
+  RrdRtc rtc;
+  rtc.hour = openBuckets[RRD_HOUR];
+  rtc.day = openBuckets[RRD_DAY];
+  rtc.version = RRD_VERSION;
+  rtc.crc16 = rtcCRC16(&rtc);
+  ESP.rtcUserMemoryWrite(RRD_RTC_OFFSET, (uint32_t*)&rtc, sizeof(rtc));
+}
+
+// Закрыть интервал: одна запись в кольцо уровня
+static void closeBucket(uint8_t tier) {
+  if (openBuckets[tier].count == 0) return;
+  if (regionFits()) FlashRing_Append(&rings[tier], &openBuckets[tier]);
+  openBuckets[tier].count = 0;
+}
+
+static void mergeBucket(RrdBucket* dst, const RrdBucket* src) {
+  uint32_t n = dst->count + src->count;
+  if (src->min_g < dst->min_g) dst->min_g = src->min_g;
+  if (src->max_g > dst->max_g) dst->max_g = src->max_g;
+  dst->mean_g = (dst->mean_g * dst->count + src->mean_g * src->count) / n;
+  dst->count = n;
+}
+
+void Rrd_Load() {
+  RrdRtc rtc;
+  ESP.rtcUserMemoryRead(RRD_RTC_OFFSET, (uint32_t*)&rtc, sizeof(rtc));
+  memset(openBuckets, 0, sizeof(openBuckets));
+  if (rtc.version == RRD_VERSION && rtc.crc16 == rtcCRC16(&rtc)) {
+    openBuckets[RRD_HOUR] = rtc.hour;
+    openBuckets[RRD_DAY] = rtc.day;
+  }
+  // Головы колец ищутся при первом обращении — пробуждение по таймеру
+  // обычно не закрывает ни одного интервала
+  for (uint8_t t = 0; t < RRD_TIERS; t++) rings[t].initialized = false;
+  loaded = true;
+}
+
+void Rrd_AddSample(uint32_t ts, float kg) {
+  if (isnan(kg) || isinf(kg) || kg < WEIGHT_ERROR_THRESHOLD) return;
+  if (!loaded) Rrd_Load();
+
+  float g = kg * 1000.0f;
+  long rounded = constrain(lroundf(g), (long)INT16_MIN + 1, (long)INT16_MAX);
+  for (uint8_t t = 0; t < RRD_TIERS; t++) {
+    RrdBucket* b = &openBuckets[t];
+    uint32_t slot = ts / periods[t];
+    if (b->count > 0 && b->slot != slot) closeBucket(t);
+    if (b->count == 0) {
+      b->slot = slot;
+      b->min_g = b->max_g = (int16_t)rounded;
+      b->mean_g = g;
+      b->count = 1;
+      continue;
+    }
+    if (rounded < b->min_g) b->min_g = (int16_t)rounded;
+    if (rounded > b->max_g) b->max_g = (int16_t)rounded;
+    b->count++;
+    b->mean_g += (g - b->mean_g) / b->count;
+  }
+}
+
+void Rrd_Save() {
+  if (!loaded) return;
+  closeBucket(RRD_MINUTE);
+  writeRtc();
+}
+
+void Rrd_Flush() {
+  if (!loaded) Rrd_Load();
+  for (uint8_t t = 0; t < RRD_TIERS; t++) closeBucket(t);
+  writeRtc();
+}
+
+uint32_t Rrd_Period(RrdTier tier) {
+  return periods[tier];
+}
+
+bool Rrd_Open(RrdCursor* c, RrdTier tier, uint32_t fromTs) {
+  if (!loaded) Rrd_Load();
+  c->tier = tier;
+  c->fromSlot = fromTs / periods[tier];
+  c->flashDone = !regionFits() || !FlashRing_Open(&rings[tier], &c->ring, c->fromSlot);
+  c->openDone = false;
+  c->hasAhead = false;
+  return !c->flashDone || openBuckets[tier].count > 0;
+}
+
+// Следующий интервал как записан: сначала кольцо, в конце открытый
+static bool readRaw(RrdCursor* c, RrdBucket* out) {
+  if (!c->flashDone) {
+    if (FlashRing_Next(&rings[c->tier], &c->ring, out)) return true;
+    c->flashDone = true;
+  }
+  if (!c->openDone) {
+    c->openDone = true;
+    const RrdBucket* b = &openBuckets[c->tier];
+    if (b->count > 0 && b->slot >= c->fromSlot) {
+      *out = *b;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Rrd_Next(RrdCursor* c, RrdBucket* out) {
+  if (!c->hasAhead && !readRaw(c, &c->ahead)) return false;
+  *out = c->ahead;
+  c->hasAhead = false;
+  while (readRaw(c, &c->ahead)) {
+    if (c->ahead.slot != out->slot) {
+      c->hasAhead = true;
+      break;
+    }
+    mergeBucket(out, &c->ahead);
+  }
+  return true;
+}
+
+void Rrd_ExportCsv(Print& out, RrdTier tier, uint32_t fromTs) {
+  RrdCursor c;
+  RrdBucket b;
+  float prevMean = 0.0f;
+  uint32_t n = 0;
+  out.println(F("ts,min_kg,max_kg,mean_kg,count,gain_kg"));
+  Rrd_Open(&c, tier, fromTs);
+  while (Rrd_Next(&c, &b)) {
+    out.printf("%lu,%.3f,%.3f,%.3f,%lu,", (unsigned long)(b.slot * periods[tier]),
+               b.min_g / 1000.0f, b.max_g / 1000.0f, b.mean_g / 1000.0f,
+               (unsigned long)b.count);
+    if (n > 0) out.printf("%.3f\n", (b.mean_g - prevMean) / 1000.0f);
+    else out.println();
+    prevMean = b.mean_g;
+    if ((++n & 63) == 0) ESP.wdtFeed();
+  }
+  out.printf("# %lu buckets\n", (unsigned long)n);
+}
+
+void Rrd_Format() {
+  for (uint8_t t = 0; t < RRD_TIERS; t++) {
+    if (regionFits()) FlashRing_Format(&rings[t]);
+  }
+  memset(openBuckets, 0, sizeof(openBuckets));
+  writeRtc();
+  loaded = true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <stdint.h>
+#include <Arduino.h>
+#include "Config.h"
+#include "FlashRing.h"
+
+// Агрегаты веса по уровням (RRD): минута, час, сутки. Каждый образец
+// обновляет открытый интервал всех уровней за O(1): min/max, count и
+// инкрементное среднее. Закрытый интервал дописывается в кольцо своего уровня
+// во flash (FlashRing) и больше не переписывается. Открытые часовой и
+// суточный интервалы переносятся через deep sleep в RTC-памяти, минутный
+// закрывается перед сном — следующее измерение по таймеру всё равно
+// попадёт в другую минуту.
+//
+// Интервал, закрытый раньше времени (Rrd_Flush перед выключением), может
+// продолжиться после включения — при чтении записи с одним номером
+// интервала сливаются.
+//
+//   RrdCursor c;
+//   Rrd_Open(&c, RRD_DAY, fromTs);
+//   while (Rrd_Next(&c, &b)) { ... }
+
+enum RrdTier : uint8_t {
+  RRD_MINUTE,
+  RRD_HOUR,
+  RRD_DAY,
+  RRD_TIERS
+};
+
+// Один интервал — 16 байт. slot = ts / период уровня — ключ кольца.
+struct RrdBucket {
+  uint32_t slot;
+  int16_t  min_g;
+  int16_t  max_g;
+  float    mean_g;
+  uint32_t count;      // 0 — интервал пуст
+};
+
+struct RrdCursor {
+  FlashRingCursor ring;
+  uint8_t  tier;
+  uint32_t fromSlot;
+  bool     flashDone;  // Кольцо прочитано
+  bool     openDone;   // Открытый интервал выдан
+  bool     hasAhead;   // В ahead — прочитанный наперёд интервал
+  RrdBucket ahead;
+};
+
+void Rrd_Load();                                // Открытые интервалы из RTC (в начале setup)
+void Rrd_AddSample(uint32_t ts, float kg);      // Учесть образец (ошибка HX711 — пропуск)
+void Rrd_Save();                                // Перед сном по таймеру: минута во flash, час/сутки в RTC
+void Rrd_Flush();                               // Перед выключением: все открытые интервалы во flash
+uint32_t Rrd_Period(RrdTier tier);              // Период уровня, с
+bool Rrd_Open(RrdCursor* c, RrdTier tier, uint32_t fromTs); // Интервалы, начинающиеся не раньше интервала fromTs
+bool Rrd_Next(RrdCursor* c, RrdBucket* out);    // Следующий (включая открытый); false — конец
+void Rrd_ExportCsv(Print& out, RrdTier tier, uint32_t fromTs); // ts,min,max,mean,count,gain
+void Rrd_Format();                              // Стереть кольца и открытые интервалы
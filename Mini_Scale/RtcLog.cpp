@@ -0,0 +1,121 @@
+#include "RtcLog.h"
+#include "Crc16.h"
+#include "HistoryStore.h"
+#include <Arduino.h>
+#include <math.h>
+
+// Заголовок кольца; CRC покрывает поля выше crc16 и все слоты записей
+struct RtcLogHeader {
+  uint32_t magic;
+  uint8_t  version;
+  uint8_t  start;      // Слот самой старой записи
+  uint8_t  count;      // Записей в кольце
+  uint8_t  reserved;
+  uint16_t crc16;
+  uint16_t pad;
+};
+
+static_assert(sizeof(LogRecord) == 8, "LogRecord must stay 8 bytes");
+static_assert(sizeof(RtcLogHeader) % 4 == 0, "RTC memory is word-addressed");
+static_assert(RTCLOG_CAPACITY <= 255, "count is uint8_t");
+
+#define RTCLOG_RECORDS_OFFSET (RTCLOG_RTC_OFFSET + sizeof(RtcLogHeader) / 4)
+#define RTCLOG_END_OFFSET     (RTCLOG_RECORDS_OFFSET + RTCLOG_CAPACITY * sizeof(LogRecord) / 4)
+static_assert(RTCLOG_END_OFFSET <= RRD_RTC_OFFSET, "RTC log overlaps the RRD block");
+
+static RtcLogHeader hdr;
+static LogRecord slots[RTCLOG_CAPACITY];
+static_assert(sizeof(slots) <= RAM_RTCLOG_BYTES, "RTC log copy is over its RAM budget line");
+
+static uint16_t calcCRC16() {
+  uint16_t crc = Crc16_Update(CRC16_INIT, &hdr, offsetof(RtcLogHeader, crc16));
+  return Crc16_Update(crc, slots, sizeof(slots));
+}
+
+static void writeHeader() {
+  hdr.crc16 = calcCRC16();
+  ESP.rtcUserMemoryWrite(RTCLOG_RTC_OFFSET, (uint32_t*)&hdr, sizeof(hdr));
+}
+
+void RtcLog_Clear() {
+  memset(&hdr, 0, sizeof(hdr));
+  memset(slots, 0, sizeof(slots));
+  hdr.magic = RTCLOG_MAGIC;
+  hdr.version = RTCLOG_VERSION;
+  ESP.rtcUserMemoryWrite(RTCLOG_RECORDS_OFFSET, (uint32_t*)slots, sizeof(slots));
+  writeHeader();
+}
+
+bool RtcLog_Load() {
+  ESP.rtcUserMemoryRead(RTCLOG_RTC_OFFSET, (uint32_t*)&hdr, sizeof(hdr));
+  ESP.rtcUserMemoryRead(RTCLOG_RECORDS_OFFSET, (uint32_t*)slots, sizeof(slots));
+
+  bool ok = hdr.magic == RTCLOG_MAGIC &&
+            hdr.version == RTCLOG_VERSION &&
+            hdr.start < RTCLOG_CAPACITY &&
+            hdr.count <= RTCLOG_CAPACITY &&
+            hdr.crc16 == calcCRC16();
+  if (!ok) {
+    // Холодный старт (RTC-память случайна) или повреждение — начинаем заново
+    if (hdr.magic == RTCLOG_MAGIC) {
+      DEBUG_PRINTLN(F("[RTCLOG] corrupted or old version, cleared"));
+    }
+    RtcLog_Clear();
+  }
+  return ok;
+}
+
+LogRecord RtcLog_MakeRecord(uint32_t ts, float weightKg, int battery, uint8_t flags) {
+  LogRecord rec;
+  rec.ts = (ts == 0xFFFFFFFFUL) ? ts - 1 : ts;
+  if ((flags & LOG_FLAG_ERROR) || isnan(weightKg) || weightKg < WEIGHT_ERROR_THRESHOLD) {
+    rec.weight_g = LOG_WEIGHT_ERROR;
+    flags |= LOG_FLAG_ERROR;
+  } else {
+    long g = lroundf(weightKg * 1000.0f);
+    rec.weight_g = (int16_t)constrain(g, (long)INT16_MIN + 1, (long)INT16_MAX);
+  }
+  rec.battery = (uint8_t)constrain(battery, 0, 100);
+  rec.flags = flags;
+  return rec;
+}
+
+bool RtcLog_Append(const LogRecord& rec) {
+  uint8_t slot;
+  if (hdr.count < RTCLOG_CAPACITY) {
+    slot = (hdr.start + hdr.count) % RTCLOG_CAPACITY;
+    hdr.count++;
+  } else {
+    // Переполнение (flash недоступен) — вытесняем самую старую запись
+    slot = hdr.start;
+    hdr.start = (hdr.start + 1) % RTCLOG_CAPACITY;
+  }
+  slots[slot] = rec;
+  ESP.rtcUserMemoryWrite(RTCLOG_RECORDS_OFFSET + slot * sizeof(LogRecord) / 4,
+                         (uint32_t*)&slots[slot], sizeof(LogRecord));
+  writeHeader();
+  return hdr.count >= RTCLOG_CAPACITY;
+}
+
+uint8_t RtcLog_Count() {
+  return hdr.count;
+}
+
+bool RtcLog_Get(uint8_t i, LogRecord* out) {
+  if (i >= hdr.count) return false;
+  *out = slots[(hdr.start + i) % RTCLOG_CAPACITY];
+  return true;
+}
+
+bool RtcLog_Flush() {
+  if (hdr.count == 0) return true;
+  LogRecord batch[RTCLOG_CAPACITY];
+  for (uint8_t i = 0; i < hdr.count; i++) RtcLog_Get(i, &batch[i]);
+  if (!History_Append(batch, hdr.count)) {
+    DEBUG_PRINTLN(F("[RTCLOG] flush failed, kept in RTC"));
+    return false;
+  }
+  DEBUG_PRINTF("[RTCLOG] flushed %u records\n", hdr.count);
+  RtcLog_Clear();
+  return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include "Config.h"
+
+// Кольцо измерений в RTC user memory: копится между пробуждениями по таймеру
+// и сбрасывается во flash (History) одной пачкой. Заголовок с magic, версией
+// и CRC16 — как у EEPROM_Data: повреждённый блок обнаруживается и кольцо
+// начинается заново.
+
+// Флаги записи
+#define LOG_FLAG_ERROR      0x01   // HX711 не ответил, вес недействителен
+#define LOG_FLAG_CLOCK_LOST 0x02   // Время после RST — ход часов прерывался
+#define LOG_FLAG_LOW_BAT    0x04   // Батарея ниже BAT_LOW_PERCENT
+
+#define LOG_WEIGHT_ERROR    INT16_MIN  // weight_g при LOG_FLAG_ERROR
+
+// Одно измерение — 8 байт. ts = 0xFFFFFFFF зарезервирован (стёртый flash).
+struct LogRecord {
+  uint32_t ts;         // Время, с (Clock_Now)
+  int16_t  weight_g;   // Вес, г (±32 кг)
+  uint8_t  battery;    // Заряд, %
+  uint8_t  flags;      // LOG_FLAG_*
+};
+
+LogRecord RtcLog_MakeRecord(uint32_t ts, float weightKg, int battery, uint8_t flags);
+
+bool RtcLog_Load();                        // Прочитать из RTC; false — пусто/повреждено (очищено)
+bool RtcLog_Append(const LogRecord& rec);  // Добавить; true — кольцо заполнено
+uint8_t RtcLog_Count();                    // Записей в кольце
+bool RtcLog_Get(uint8_t i, LogRecord* out); // i = 0 — самая старая
+bool RtcLog_Flush();                       // Переписать во flash и очистить
+void RtcLog_Clear();                       // Очистить кольцо
@@ -0,0 +1,135 @@
+#include "SampleCodec.h"
+#include "Crc16.h"
+#include <string.h>
+
+static_assert(sizeof(CodecBlockHeader) == 12, "CodecBlockHeader is part of the flash format");
+
+static uint16_t blockCRC16(const uint8_t* block, const CodecBlockHeader* h) {
+  uint16_t crc = Crc16_Update(CRC16_INIT, h, offsetof(CodecBlockHeader, crc16));
+  return Crc16_Update(crc, block + CODEC_HEADER_SIZE, h->length);
+}
+
+static uint64_t zigzag(int64_t v) {
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static size_t putVarint(uint8_t* out, uint64_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)v | 0x80;
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+static bool getVarint(CodecDecoder* d, uint64_t* v) {
+  *v = 0;
+  for (uint8_t shift = 0; shift < 64 && d->pos < d->end; shift += 7) {
+    uint8_t b = d->block[d->pos++];
+    *v |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+// ===== Кодирование =====
+
+void Codec_Begin(CodecEncoder* e, uint8_t* block, size_t size) {
+  e->block = block;
+  e->size = size < CODEC_HEADER_SIZE + 255 ? size : CODEC_HEADER_SIZE + 255;
+  e->pos = CODEC_HEADER_SIZE;
+  e->count = 0;
+  memset(&e->prev, 0, sizeof(e->prev));
+  e->prevDelta = 0;
+}
+
+bool Codec_Append(CodecEncoder* e, const LogRecord& rec) {
+  if (e->count == 255) return false;
+  if (e->count == 0) {                      // первая запись — от времени из заголовка
+    e->firstTs = rec.ts;
+    e->prev.ts = rec.ts;
+  }
+
+  uint8_t buf[CODEC_MAX_RECORD];
+  int32_t delta = (int32_t)(rec.ts - e->prev.ts);
+  int64_t dod = (int64_t)delta - e->prevDelta;
+  bool aux = e->count == 0 || rec.battery != e->prev.battery || rec.flags != e->prev.flags;
+  size_t n = putVarint(buf, zigzag(dod) << 1 | (aux ? 1 : 0));
+  n += putVarint(buf + n, zigzag((int32_t)rec.weight_g - e->prev.weight_g));
+  if (aux) {
+    buf[n++] = rec.battery;
+    buf[n++] = rec.flags;
+  }
+  if (e->pos + n > e->size) return false;
+
+  memcpy(e->block + e->pos, buf, n);
+  e->pos += n;
+  e->count++;
+  e->prev = rec;
+  e->prevDelta = delta;
+  return true;
+}
+
+size_t Codec_Finish(CodecEncoder* e) {
+  if (e->count == 0) return 0;
+  CodecBlockHeader h;
+  h.firstTs = e->firstTs;
+  h.lastTs = e->prev.ts;
+  h.count = e->count;
+  h.length = (uint8_t)(e->pos - CODEC_HEADER_SIZE);
+  h.crc16 = blockCRC16(e->block, &h);
+  memcpy(e->block, &h, sizeof(h));
+  return e->pos;
+}
+
+// ===== Декодирование =====
+
+bool Codec_Open(CodecDecoder* d, const uint8_t* block, size_t size) {
+  CodecBlockHeader h;
+  d->left = 0;
+  if (size < CODEC_HEADER_SIZE) return false;
+  memcpy(&h, block, sizeof(h));
+  if (h.count == 0 || h.firstTs == 0xFFFFFFFFUL ||
+      CODEC_HEADER_SIZE + h.length > size || h.crc16 != blockCRC16(block, &h)) {
+    return false;
+  }
+  d->block = block;
+  d->pos = CODEC_HEADER_SIZE;
+  d->end = CODEC_HEADER_SIZE + h.length;
+  d->left = h.count;
+  memset(&d->prev, 0, sizeof(d->prev));
+  d->prev.ts = h.firstTs;
+  d->prevDelta = 0;
+  return true;
+}
+
+bool Codec_Next(CodecDecoder* d, LogRecord* out) {
+  if (d->left == 0) return false;
+  uint64_t tag, dw;
+  if (!getVarint(d, &tag) || !getVarint(d, &dw)) {
+    d->left = 0;
+    return false;
+  }
+  int32_t delta = (int32_t)(d->prevDelta + unzigzag(tag >> 1));
+  LogRecord rec = d->prev;
+  rec.ts = d->prev.ts + (uint32_t)delta;
+  rec.weight_g = (int16_t)(d->prev.weight_g + unzigzag(dw));
+  if (tag & 1) {
+    if (d->pos + 2 > d->end) {
+      d->left = 0;
+      return false;
+    }
+    rec.battery = d->block[d->pos++];
+    rec.flags = d->block[d->pos++];
+  }
+  d->prev = rec;
+  d->prevDelta = delta;
+  d->left--;
+  *out = rec;
+  return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "RtcLog.h"
+
+// Сжатие записей LogRecord в самостоятельные блоки. Блок — заголовок
+// (время первой и последней записи, число записей, длина, CRC16) и поток
+// varint; декодируется без соседних блоков, повреждённый блок отбрасывается
+// целиком.
+//
+// Запись внутри блока:
+//   varint(zigzag(dod) << 1 | aux)  dod — вторая разность времени (0 при
+//                                   постоянном интервале), aux — изменились
+//                                   заряд или флаги
+//   varint(zigzag(dw))              разность веса, г
+//   [battery, flags]                только при aux
+// Ровный ряд с постоянным интервалом — 2 байта на запись вместо 8.
+
+struct CodecBlockHeader {
+  uint32_t firstTs;    // Ключ блока во flash
+  uint32_t lastTs;
+  uint8_t  count;
+  uint8_t  length;     // Байт данных после заголовка
+  uint16_t crc16;      // Заголовок без crc16 + данные
+};
+
+#define CODEC_HEADER_SIZE  sizeof(CodecBlockHeader)
+#define CODEC_MAX_RECORD   14    // Худший случай: 5 + 3 + 2 байта с запасом
+
+struct CodecEncoder {
+  uint8_t*  block;
+  size_t    size;      // Размер блока вместе с заголовком
+  size_t    pos;
+  uint8_t   count;
+  uint32_t  firstTs;
+  LogRecord prev;
+  int32_t   prevDelta;
+};
+
+struct CodecDecoder {
+  const uint8_t* block;
+  size_t    pos;
+  size_t    end;
+  uint8_t   left;      // Записей ещё не прочитано
+  LogRecord prev;
+  int32_t   prevDelta;
+};
+
+void Codec_Begin(CodecEncoder* e, uint8_t* block, size_t size); // size <= заголовок + 255
+bool Codec_Append(CodecEncoder* e, const LogRecord& rec);       // false — не помещается, блок не изменён
+size_t Codec_Finish(CodecEncoder* e);                           // Заголовок и CRC; байт занято (0 — пусто)
+bool Codec_Open(CodecDecoder* d, const uint8_t* block, size_t size); // false — пусто или повреждён
+bool Codec_Next(CodecDecoder* d, LogRecord* out);               // false — конец блока
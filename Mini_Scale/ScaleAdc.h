@@ -0,0 +1,15 @@
+#pragma once
+#include <Arduino.h>
+
+// АЦП тензодатчика: сырые отсчёты без пересчёта в кг (offset и cal_factor —
+// забота ScaleControl). На устройстве — HX711 (Scale_Adc), на хосте сверх
+// модели Sim — свои источники в бенчмарках (host/sim/PipelineBench.cpp).
+class ScaleAdc {
+public:
+  virtual void begin() = 0;                             // Выводы и питание
+  virtual bool isReady() = 0;                           // Конверсия готова
+  virtual bool waitReady(unsigned long timeoutMs) = 0;  // false — не дождались
+  virtual long read() = 0;                              // Одна конверсия (после готовности)
+  virtual void powerDown() = 0;
+  virtual void powerUp() = 0;                           // Первая конверсия — после установления
+};
@@ -1,75 +1,227 @@
 #include "ScaleControl.h"
 #include "ButtonControl.h"
+#include "PowerStats.h"
+#include "CpuGovernor.h"
+#include "Clock.h"
+#include "Rrd.h"
+#include "Telemetry.h"
+#include "Log.h"
+#include "CalFit.h"
+#include "Crc16.h"
+#include "ScaleAdc.h"
+#include "ScalePipeline.h"
+#include <HX711.h>
 #include <math.h>
 extern "C" {
   #include "user_interface.h"
+  #include "gpio.h"
 }
 
 // Глобальные переменные — доступны из других модулей
-HX711 scale;
 float session_delta  = 0.0f;
-float current_weight = 0.0f;
-float display_weight = 0.0f;
 bool  undoAvailable  = false;
 
-// ===== Кольцевой буфер стабильности =====
-static float    weightHistory[STABILITY_WINDOW];
-static uint8_t  weightHistoryIdx  = 0;
-static bool     weightHistoryFull = false;
-
-// ===== EMA-фильтр веса =====
-static float filteredWeight    = 0.0;
-static bool  filterInitialized = false;
-
-// ===== Заморозка показаний на дисплее =====
-static float frozenWeight = 0.0;
-static bool  isFrozen     = false;
+// ===== Вес: цепочка фильтров и её выход =====
+// Выход отличается от фильтра при ошибке HX711 (WEIGHT_ERROR_FLAG)
+typedef ProfilePipeline<ScaleProfile> WeightPipeline;
+static WeightPipeline pipeline;
+static_assert(sizeof(pipeline) <= RAM_PIPELINE_BYTES, "weight pipeline is over its RAM budget line");
+static float currentWeight = 0.0f;
+static float displayWeight = 0.0f;
 
 // ===== Счётчик ошибок HX711 =====
 static uint8_t errorCount = 0;
 
-// ===== Медианный фильтр (3 значения) =====
-static float   medianBuf[MEDIAN_WINDOW];
-static uint8_t medianIdx   = 0;
-static uint8_t medianCount = 0;
+// ===== Параметры фильтра (меняются из консоли, не сохраняются) =====
+static uint8_t samplesPerRead = HX711_SAMPLES_READ;
+static unsigned long fixedIntervalMs = LOOP_DELAY_IDLE_MS;  // период опроса без адаптивного режима
 
 // ===== Auto-zero tracking =====
 static uint8_t       autoZeroStableCount = 0;
 static unsigned long lastAutoZeroTime    = 0;
 static bool          autoZeroEnabled     = true;
 
-// ===== Отложенное действие кнопки из Scale_PowerSave =====
+// ===== Отложенное действие кнопки: пойманное во сне и в ожидании DOUT =====
 static ButtonAction pendingAction = BTN_NONE;
 
-// ===== Перегрузка =====
-static bool isOverloaded = false;
-
-// ===== Тренд веса =====
-static float  prevTrendWeight = 0.0f;
-static int8_t weightTrend     = 0;
+// ===== Адаптивный опрос HX711 =====
+// Ступени интервала сна при стабильном весе
+static const unsigned long acqIntervals[] = { ACQ_INTERVAL_1_MS, ACQ_INTERVAL_2_MS, ACQ_INTERVAL_3_MS };
+static const uint8_t ACQ_LEVELS = sizeof(acqIntervals) / sizeof(acqIntervals[0]);
+static bool    acqAdaptive     = ACQ_ADAPTIVE_ENABLED;
+static uint8_t acqLevel        = 0;
+static uint8_t acqStableBursts = 0;     // стабильных серий на текущей ступени
+static bool    acqAfterSleep   = false; // следующий Scale_Update — серия после сна
+
+// ===== Снимок фильтров в RTC-памяти =====
+// Переживает deep sleep: после пробуждения весы стабильны с первой конверсии,
+// если вес не изменился. Действителен только при тех же offset и cal_factor.
+struct ScaleSnapshot {
+  uint32_t magic;
+  int32_t  tareOffset;   // 4 байта и на хосте: размер снимка как на устройстве
+  float    calFactor;
+  WeightPipeline::State filter;
+  uint8_t  autoZeroStableCount;
+  uint8_t  acqLevel;
+  uint16_t crc16;
+};
+
+static_assert(sizeof(ScaleSnapshot) % 4 == 0, "RTC memory is word-addressed");
+
+// Окна профиля PROFILE_LAB в 20 блоков не помещаются — он без снимка: после
+// пробуждения фильтры набираются заново (deep sleep для него не основной режим)
+static constexpr bool snapshotEnabled =
+    SCALE_RTC_OFFSET + sizeof(ScaleSnapshot) / 4 <= UPLINK_RTC_OFFSET;
+static_assert(snapshotEnabled || !std::is_same<ScaleProfile, HiveProfile>::value,
+              "hive profile needs the filter snapshot");
 
 // -------------------------------------------------------
 // Вспомогательные функции
 // -------------------------------------------------------
 
-// Добавить новое значение в кольцевой буфер стабильности
-static void stabilityPush(float w) {
-  weightHistory[weightHistoryIdx] = w;
-  weightHistoryIdx = (weightHistoryIdx + 1) % STABILITY_WINDOW;
-  if (!weightHistoryFull && weightHistoryIdx == 0) weightHistoryFull = true;
+// CRC16 снимка без поля crc16
+static uint16_t snapshotCRC16(const ScaleSnapshot* snap) {
+  return Crc16_Update(CRC16_INIT, snap, offsetof(ScaleSnapshot, crc16));
+}
+
+// Прочитать снимок фильтров; false — нет, повреждён или от другой тары/калибровки
+static bool loadSnapshot(ScaleSnapshot* snap) {
+  if (!snapshotEnabled) return false;
+  ESP.rtcUserMemoryRead(SCALE_RTC_OFFSET, (uint32_t*)snap, sizeof(*snap));
+  return snap->magic == SCALE_RTC_MAGIC &&
+         snap->crc16 == snapshotCRC16(snap) &&
+         snap->tareOffset == savedData.tare_offset &&
+         snap->calFactor == savedData.cal_factor &&
+         WeightPipeline::valid(snap->filter);
+}
+
+// Восстановить состояние фильтров из снимка
+static void restoreSnapshot(const ScaleSnapshot* snap) {
+  pipeline.restore(snap->filter);
+  autoZeroStableCount = snap->autoZeroStableCount;
+  acqLevel            = snap->acqLevel < ACQ_LEVELS ? snap->acqLevel : 0;
+  acqStableBursts     = 0;
 }
 
-// Округление до 2 знаков после запятой (для отображения на дисплее)
-static float roundWeight(float w) {
-  return round(w * 100.0f) / 100.0f;
+// ===== АЦП: HX711 =====
+// Только конверсии и питание; offset тары и cal_factor — ниже, в ScaleControl
+class Hx711Adc : public ScaleAdc {
+public:
+  void begin() override                             { hx.begin(DOUT_PIN, SCK_PIN); }
+  bool isReady() override                           { return hx.is_ready(); }
+  bool waitReady(unsigned long timeoutMs) override  { return hx.wait_ready_timeout(timeoutMs); }
+  long read() override                              { return hx.read(); }
+  void powerDown() override                         { hx.power_down(); }
+  void powerUp() override                           { hx.power_up(); }
+private:
+  HX711 hx;
+};
+
+ScaleAdc& Scale_Adc() {
+  static Hx711Adc hx711;
+  return hx711;
 }
 
-// Медиана из трёх значений — убирает одиночные выбросы АЦП
-static float medianOfThree(float a, float b, float c) {
-  if (a > b) { float t = a; a = b; b = t; }
-  if (b > c) { float t = b; b = c; c = t; }
-  if (a > b) { float t = a; a = b; b = t; }
-  return b;
+// Вернуться на первую ступень графика опроса
+static void acqRestart() {
+  acqLevel        = 0;
+  acqStableBursts = 0;
+}
+
+// ===== Пересчёт отсчётов в кг =====
+// Без поправки — прямая по cal_factor. С поправкой (CalFit) таблица задана
+// от отсчётов пустой платформы lin_zero: вес — разность поправленных значений
+// для отсчётов и для offset тары, так что тара с грузом не сдвигает кривую.
+static float linInvStep = 0.0f;   // CAL_LIN_SEGMENTS / lin_span, 0 — поправка выключена
+static long  tareOffset = 0;      // отсчёты пустой платформы (savedData.tare_offset)
+static float calFactor  = 1.0f;   // отсчётов на кг (savedData.cal_factor)
+
+static float countsToKg(float counts) {
+  float offset = (float)tareOffset;
+  float factor = calFactor;
+  if (linInvStep == 0.0f) return (counts - offset) / factor;
+  float zero = (float)savedData.lin_zero;
+  return CalFit_Apply(savedData.lin_knots, linInvStep, (counts - zero) / factor) -
+         CalFit_Apply(savedData.lin_knots, linInvStep, (offset - zero) / factor);
+}
+
+void Scale_ApplyCalibration() {
+  tareOffset = savedData.tare_offset;
+  calFactor = savedData.cal_factor;
+  linInvStep = savedData.lin_span > 0.0f ? CAL_LIN_SEGMENTS / savedData.lin_span : 0.0f;
+}
+
+// Одна конверсия, если готова; без ожидания DOUT (режим калибровки в loop)
+bool Scale_PollCounts(long* counts) {
+  ScaleAdc& adc = Scale_Adc();
+  if (!adc.isReady()) return false;
+  POWER_SCOPE(PH_HX711_READ);
+  *counts = adc.read();
+  return true;
+}
+
+// Сохранить первое значимое действие кнопки — оно будет обработано в loop()
+// (Scale_GetPendingAction). Кнопка опрашивается во сне и в ожидании DOUT.
+static void pollButton() {
+  ButtonAction a = Button_Update();
+  if (pendingAction == BTN_NONE && a != BTN_NONE && a != BTN_SHOW_HINT) {
+    pendingAction = a;
+  }
+}
+
+// Ожидание DOUT отрезками BUTTON_POLL_MS с опросом кнопки: серия из нескольких
+// конверсий занимает сотни мс, и короткое нажатие целиком внутри неё терялось
+static bool waitReadyPolling(ScaleAdc& adc) {
+  unsigned long start = millis();
+  while (!adc.waitReady(BUTTON_POLL_MS)) {
+    pollButton();
+    if (millis() - start >= HX711_TIMEOUT_MS) return false;
+  }
+  return true;
+}
+
+long Scale_GetOffset()     { return tareOffset; }
+float Scale_GetCalFactor() { return calFactor; }
+
+// Чтение times конверсий — эквивалент HX711::get_units(times), но ожидание DOUT
+// и shift-out учитываются раздельно, а каждая конверсия ограничена таймаутом.
+// Ожидание и побитовое чтение — на базовой частоте CPU. counts — среднее
+// сырых отсчётов (для телеметрии), может быть nullptr.
+static bool readUnits(uint8_t times, float* units, long* counts = nullptr) {
+  CPU_BASE_SCOPE();
+  ScaleAdc& adc = Scale_Adc();
+  long sum = 0;
+  for (uint8_t i = 0; i < times; i++) {
+    {
+      POWER_SCOPE(PH_HX711_WAIT);
+      if (!waitReadyPolling(adc)) return false;
+    }
+    POWER_SCOPE(PH_HX711_READ);
+    sum += adc.read();
+  }
+  *units = countsToKg((float)sum / times);
+  if (counts) *counts = sum / times;
+  return true;
+}
+
+// То же для запуска и отмены тары: NAN, если HX711 не ответил
+static float getUnits(uint8_t times) {
+  float units;
+  return readUnits(times, &units) ? units : NAN;
+}
+
+// -------------------------------------------------------
+// Scale_Begin
+// -------------------------------------------------------
+// Подать питание на HX711 как можно раньше: установление АЦП
+// (HX711_INIT_DELAY_MS) идёт параллельно с инициализацией дисплея и EEPROM.
+static bool hxBegun = false;
+static unsigned long hxBeginAt = 0;
+
+void Scale_Begin() {
+  Scale_Adc().begin();
+  hxBeginAt = millis();
+  hxBegun = true;
 }
 
 // -------------------------------------------------------
@@ -77,21 +229,42 @@ static float medianOfThree(float a, float b, float c) {
 // -------------------------------------------------------
 // Инициализация HX711: загружаем сохранённый offset и cal_factor из EEPROM,
 // делаем начальное считывание для инициализации EMA и вычисления session_delta.
+// Ждёт только остаток установления после Scale_Begin().
 void Scale_Init() {
-  scale.begin(DOUT_PIN, SCK_PIN);
-  scale.set_scale(savedData.cal_factor);
-  scale.set_offset(savedData.tare_offset);
-  delay(HX711_INIT_DELAY_MS);
-
-  if (!scale.wait_ready_timeout(HX711_TIMEOUT_MS)) {
-    DEBUG_PRINTLN(F("HX711: не готов при запуске"));
-    current_weight = WEIGHT_ERROR_FLAG;
-    display_weight = WEIGHT_ERROR_FLAG;
+  if (!hxBegun) Scale_Begin();
+  Scale_ApplyCalibration();
+  unsigned long settled = millis() - hxBeginAt;
+  if (settled < HX711_INIT_DELAY_MS) delay(HX711_INIT_DELAY_MS - settled);
+
+  if (!Scale_Adc().waitReady(HX711_TIMEOUT_MS)) {
+    LOG(HX_NOT_READY);
+    currentWeight = WEIGHT_ERROR_FLAG;
+    displayWeight = WEIGHT_ERROR_FLAG;
     return;
   }
 
-  float startup_weight = scale.get_units(HX711_SAMPLES_STARTUP);
-  if (isnan(startup_weight) || isinf(startup_weight)) startup_weight = 0.0f;
+  // Снимок фильтров от прошлого сеанса: первая конверсия согласуется с EMA —
+  // состояние восстанавливается целиком, показания стабильны сразу
+  ScaleSnapshot snap;
+  bool restored = false;
+  float startup_weight;
+  if (loadSnapshot(&snap)) {
+    float first = getUnits(SNAPSHOT_SAMPLES);
+    if (!isnan(first) && !isinf(first) &&
+        fabs(first - snap.filter.filtered) <= ACQ_WAKE_DELTA_KG) {
+      restoreSnapshot(&snap);
+      restored = true;
+      LOG(SNAPSHOT_RESTORED, snap.filter.filtered, first);
+    } else {
+      LOG(SNAPSHOT_CHANGED, snap.filter.filtered, first);
+    }
+  }
+  if (restored) {
+    startup_weight = pipeline.filtered();
+  } else {
+    startup_weight = getUnits(HX711_SAMPLES_STARTUP);
+    if (isnan(startup_weight) || isinf(startup_weight)) startup_weight = 0.0f;
+  }
 
   session_delta = startup_weight - savedData.last_weight;
 
@@ -100,14 +273,31 @@ void Scale_Init() {
     Memory_ForceSave();
   }
 
-  filteredWeight    = startup_weight;
-  filterInitialized = true;
-  current_weight    = startup_weight;
-  display_weight    = roundWeight(startup_weight);
-  prevTrendWeight   = startup_weight;
+  if (!restored) pipeline.seed(startup_weight);
+  currentWeight = startup_weight;
+  displayWeight = pipeline.displayWeight();
 
   autoZeroEnabled  = (savedData.auto_zero_on != 0) && (savedData.tara_lock_on == 0);
-  lastAutoZeroTime = millis();
+  lastAutoZeroTime = Scale_Millis();
+}
+
+// -------------------------------------------------------
+// Scale_SaveSnapshot
+// -------------------------------------------------------
+// Сохранить состояние фильтров в RTC-память перед deep sleep.
+// Без инициализированного фильтра (измерение режима улья) прежний снимок не трогаем.
+void Scale_SaveSnapshot() {
+  if (!snapshotEnabled || !pipeline.isInitialized() || errorCount >= HX711_ERROR_COUNT_MAX) return;
+  ScaleSnapshot snap;
+  memset(&snap, 0, sizeof(snap));
+  snap.magic               = SCALE_RTC_MAGIC;
+  snap.tareOffset          = savedData.tare_offset;
+  snap.calFactor           = savedData.cal_factor;
+  pipeline.save(&snap.filter);
+  snap.autoZeroStableCount = autoZeroStableCount;
+  snap.acqLevel            = acqLevel;
+  snap.crc16 = snapshotCRC16(&snap);
+  ESP.rtcUserMemoryWrite(SCALE_RTC_OFFSET, (uint32_t*)&snap, sizeof(snap));
 }
 
 // -------------------------------------------------------
@@ -116,114 +306,85 @@ void Scale_Init() {
 // Главная функция обновления веса — вызывается каждый loop().
 // Цепочка обработки: raw → медианный фильтр → EMA → заморозка → тренд → авто-нуль.
 void Scale_Update() {
-  if (!scale.wait_ready_timeout(HX711_TIMEOUT_MS)) {
+  float raw;
+  long counts;
+  if (!readUnits(samplesPerRead, &raw, &counts) || isnan(raw) || isinf(raw)) {
     errorCount++;
     if (errorCount >= HX711_ERROR_COUNT_MAX) {
-      current_weight = WEIGHT_ERROR_FLAG;
-      display_weight = WEIGHT_ERROR_FLAG;
+      currentWeight = WEIGHT_ERROR_FLAG;
+      displayWeight = WEIGHT_ERROR_FLAG;
     }
     return;
   }
 
-  float raw = scale.get_units(HX711_SAMPLES_READ);
-  if (isnan(raw) || isinf(raw)) {
-    errorCount++;
-    if (errorCount >= HX711_ERROR_COUNT_MAX) {
-      current_weight = WEIGHT_ERROR_FLAG;
-      display_weight = WEIGHT_ERROR_FLAG;
-    }
-    return;
-  }
+  POWER_SCOPE(PH_FILTER);
+  CPU_BOOST_SCOPE();
 
   // Восстановление из ERROR — сброс буферов
   if (errorCount >= HX711_ERROR_COUNT_MAX) {
-    weightHistoryIdx  = 0;
-    weightHistoryFull = false;
-    medianCount       = 0;
-    medianIdx         = 0;
-    filterInitialized = false;
-    DEBUG_PRINTLN(F("HX711: восстановление из ERROR"));
+    pipeline.restartFilter();
+    LOG(HX_RECOVERED);
   }
   errorCount = 0;
 
-  // -- Медианный фильтр --
-  medianBuf[medianIdx] = raw;
-  medianIdx = (medianIdx + 1) % MEDIAN_WINDOW;
-  if (medianCount < MEDIAN_WINDOW) medianCount++;
-
-  float valueForEMA = raw;
-  if (medianCount >= MEDIAN_WINDOW) {
-    valueForEMA = medianOfThree(medianBuf[0], medianBuf[1], medianBuf[2]);
-    DEBUG_PRINTF("Median: %.3f -> %.3f\n", raw, valueForEMA);
-  }
-
-  // -- EMA-фильтр --
-  if (!filterInitialized) {
-    filteredWeight    = valueForEMA;
-    filterInitialized = true;
-  } else {
-    filteredWeight = (WEIGHT_EMA_ALPHA * valueForEMA) +
-                     ((1.0f - WEIGHT_EMA_ALPHA) * filteredWeight);
-  }
-
-  current_weight = filteredWeight;
-  stabilityPush(filteredWeight);
-
-  // -- Перегрузка --
-  if (fabs(filteredWeight) > WEIGHT_OVERLOAD_KG) {
-    if (!isOverloaded) DEBUG_PRINTLN(F("OVERLOAD!"));
-    isOverloaded = true;
-  } else {
-    isOverloaded = false;
+  // -- Серия после сна: изменение веса или переход на следующую ступень --
+  // Фильтры сохраняются через power_down, поэтому отклонение серии от EMA
+  // сразу видно. Медиана очищается, чтобы старые значения не скрыли скачок.
+  if (acqAfterSleep) {
+    acqAfterSleep = false;
+    if (pipeline.isInitialized() && fabs(raw - pipeline.filtered()) > ACQ_WAKE_DELTA_KG) {
+      acqRestart();
+      pipeline.clearMedian();
+      LOG(ACQ_CONTINUOUS);
+    } else if (++acqStableBursts >= ACQ_BURSTS_PER_STEP && acqLevel + 1 < ACQ_LEVELS) {
+      acqLevel++;
+      acqStableBursts = 0;
+      LOG(ACQ_INTERVAL, acqIntervals[acqLevel]);
+    }
   }
 
-  // -- Тренд --
-  float diff = filteredWeight - prevTrendWeight;
-  if      (diff >  TREND_THRESHOLD) weightTrend =  1;
-  else if (diff < -TREND_THRESHOLD) weightTrend = -1;
-  else                              weightTrend =  0;
-  prevTrendWeight = filteredWeight;
-
-  // -- Авто-заморозка --
-  float rounded = roundWeight(filteredWeight);
-  if (isFrozen) {
-    if (fabs(rounded - frozenWeight) > WEIGHT_FREEZE_THRESHOLD) {
-      isFrozen       = false;
-      display_weight = rounded;
-    }
-  } else {
-    display_weight = rounded;
-    if (Scale_IsStable()) {
-      frozenWeight = rounded;
-      isFrozen     = true;
-    }
+  // -- Медиана → EMA → стабильность → перегрузка → тренд → заморозка --
+  bool wasOverloaded = pipeline.isOverloaded();
+  pipeline.push(raw);
+  currentWeight = pipeline.filtered();
+  displayWeight = pipeline.displayWeight();
+  Rrd_AddSample(Clock_Now(), currentWeight);
+  if (!pipeline.isStable()) acqRestart();
+  if (pipeline.isOverloaded() && !wasOverloaded) LOG(OVERLOAD);
+
+  // -- Телеметрия --
+  if (Telemetry_Active()) {
+    uint8_t flags = (pipeline.isStable() ? TEL_FLAG_STABLE : 0) |
+                    (pipeline.isOverloaded() ? TEL_FLAG_OVERLOAD : 0) |
+                    (pipeline.medianFull() ? TEL_FLAG_MEDIAN_FULL : 0);
+    Telemetry_Sample(counts, pipeline.medianValue(), currentWeight, flags);
   }
 
   // -- Auto-zero tracking --
-  if (autoZeroEnabled && Scale_IsStable() &&
-      fabs(display_weight) < AUTOZERO_THRESHOLD && !isOverloaded) {
+  if (autoZeroEnabled && pipeline.isStable() &&
+      fabs(displayWeight) < AUTOZERO_THRESHOLD && !pipeline.isOverloaded()) {
     autoZeroStableCount++;
-    unsigned long now = millis();
+    unsigned long now = Scale_Millis();
     if (autoZeroStableCount >= AUTOZERO_MIN_STABLE_CYCLES &&
         (now - lastAutoZeroTime >= AUTOZERO_INTERVAL_MS)) {
 
       // BUG-5 fix: сохраняем шаг ДО применения — откат детерминирован
-      long step = (display_weight > 0.001f) ? AUTOZERO_STEP : -AUTOZERO_STEP;
+      long step = (displayWeight > 0.001f) ? AUTOZERO_STEP : -AUTOZERO_STEP;
       savedData.tare_offset += step;
-      scale.set_offset(savedData.tare_offset);
+      tareOffset = savedData.tare_offset;
 
-      float newWeight = scale.get_units(1);
-      if (!isnan(newWeight) && !isinf(newWeight)) {
-        filteredWeight = newWeight;
-        current_weight = filteredWeight;
-        display_weight = roundWeight(filteredWeight);
+      float newWeight;
+      if (readUnits(1, &newWeight) && !isnan(newWeight) && !isinf(newWeight)) {
+        pipeline.setFiltered(newWeight);
+        currentWeight = newWeight;
+        displayWeight = pipeline.displayWeight();
         Memory_MarkDirty();
-        DEBUG_PRINTLN(F("Auto-zero: corrected"));
+        LOG(AUTOZERO_DONE);
       } else {
         // Откат — ровно тот же шаг
         savedData.tare_offset -= step;
-        scale.set_offset(savedData.tare_offset);
-        DEBUG_PRINTLN(F("Auto-zero: read failed, reverted"));
+        tareOffset = savedData.tare_offset;
+        LOG(AUTOZERO_REVERTED);
       }
 
       lastAutoZeroTime    = now;
@@ -237,42 +398,43 @@ void Scale_Update() {
 // -------------------------------------------------------
 // Scale_Tare
 // -------------------------------------------------------
-// Тарирование: сохраняем backup offset/weight для undo,
-// затем вызываем scale.tare() и сбрасываем все внутренние буферы.
+// Тарирование: сохраняем backup offset/weight для undo, новый offset — среднее
+// HX711_SAMPLES_TARE конверсий (readUnits: таймаут, опрос кнопки, фазы питания),
+// затем сбрасываем все внутренние буферы.
 bool Scale_Tare() {
-  if (!scale.wait_ready_timeout(HX711_TIMEOUT_MS)) {
-    current_weight = WEIGHT_ERROR_FLAG;
+  if (!Scale_Adc().waitReady(HX711_TIMEOUT_MS)) {
+    currentWeight = WEIGHT_ERROR_FLAG;
     return false;
   }
-  if (current_weight < WEIGHT_ERROR_THRESHOLD ||
-      fabs(current_weight) > WEIGHT_SANE_MAX) {
+  if (currentWeight < WEIGHT_ERROR_THRESHOLD ||
+      fabs(currentWeight) > WEIGHT_SANE_MAX) {
+    return false;
+  }
+
+  float units;
+  long counts;
+  if (!readUnits(HX711_SAMPLES_TARE, &units, &counts)) {
+    currentWeight = WEIGHT_ERROR_FLAG;
     return false;
   }
 
   savedData.backup_offset      = savedData.tare_offset;
   savedData.backup_last_weight = savedData.last_weight;
-
-  scale.tare(HX711_SAMPLES_TARE);
-  savedData.tare_offset = scale.get_offset();
+  savedData.tare_offset        = counts;
+  tareOffset                   = counts;
 
   session_delta         = 0.0f;
   savedData.last_weight = 0.0f;
   Memory_ForceSave();
 
   undoAvailable     = true;
-  current_weight    = 0.0f;
-  filteredWeight    = 0.0f;
-  isFrozen          = false;
-  display_weight    = 0.0f;
-  weightHistoryIdx  = 0;
-  weightHistoryFull = false;
-  memset(weightHistory, 0, sizeof(weightHistory));
+  pipeline.clearWindows();
+  pipeline.seed(0.0f);
+  currentWeight     = 0.0f;
+  displayWeight     = 0.0f;
   errorCount        = 0;
-  medianCount       = 0;
-  medianIdx         = 0;
   autoZeroStableCount = 0;
-  prevTrendWeight   = 0.0f;
-  weightTrend       = 0;
+  acqRestart();
   return true;
 }
 
@@ -285,59 +447,44 @@ bool Scale_UndoTare() {
   if (!undoAvailable) return false;
 
   savedData.tare_offset = savedData.backup_offset;
-  scale.set_offset(savedData.tare_offset);
+  tareOffset = savedData.tare_offset;
   savedData.last_weight = savedData.backup_last_weight;
 
-  if (!scale.wait_ready_timeout(HX711_TIMEOUT_MS)) {
-    current_weight = WEIGHT_ERROR_FLAG;
+  if (!Scale_Adc().waitReady(HX711_TIMEOUT_MS)) {
+    currentWeight = WEIGHT_ERROR_FLAG;
     Memory_ForceSave();
     return false;
   }
 
   // PI-9: session_delta сбрасываем до чтения как безопасное значение по умолчанию
   session_delta = 0.0f;
-  float w = scale.get_units(HX711_SAMPLES_UNDO);
+  pipeline.clearWindows();
+  float w = getUnits(HX711_SAMPLES_UNDO);
   if (!isnan(w) && !isinf(w)) {
-    session_delta  = w - savedData.last_weight;
-    current_weight = w;
-    filteredWeight = w;
-    display_weight = roundWeight(w);
-    prevTrendWeight = w;
+    session_delta = w - savedData.last_weight;
+    pipeline.seed(w);
+    currentWeight = w;
+    displayWeight = pipeline.displayWeight();
   }
   Memory_ForceSave();
 
   undoAvailable     = false;
-  isFrozen          = false;
-  weightHistoryIdx  = 0;
-  weightHistoryFull = false;
-  memset(weightHistory, 0, sizeof(weightHistory));
   errorCount        = 0;
-  medianCount       = 0;
-  medianIdx         = 0;
   autoZeroStableCount = 0;
-  weightTrend       = 0;
+  acqRestart();
   return true;
 }
 
 // -------------------------------------------------------
 // Вспомогательные геттеры
 // -------------------------------------------------------
-bool Scale_IsStable() {
-  uint8_t count = weightHistoryFull ? STABILITY_WINDOW : weightHistoryIdx;
-  if (count < 2) return false;
-  float minVal = weightHistory[0];
-  float maxVal = weightHistory[0];
-  for (uint8_t i = 1; i < count; i++) {
-    if (weightHistory[i] < minVal) minVal = weightHistory[i];
-    if (weightHistory[i] > maxVal) maxVal = weightHistory[i];
-  }
-  return (maxVal - minVal) < STABILITY_THRESHOLD;
-}
-
+float Scale_GetWeight()        { return currentWeight; }
+float Scale_GetDisplayWeight() { return displayWeight; }
+bool Scale_IsStable()    { return pipeline.isStable(); }
 bool Scale_IsIdle()      { return Scale_IsStable() && (errorCount == 0); }
-bool Scale_IsFrozen()    { return isFrozen; }
-bool Scale_IsOverloaded(){ return isOverloaded; }
-int8_t Scale_GetTrend()  { return weightTrend; }
+bool Scale_IsFrozen()    { return pipeline.isFrozen(); }
+bool Scale_IsOverloaded(){ return pipeline.isOverloaded(); }
+int8_t Scale_GetTrend()  { return pipeline.trend(); }
 
 void Scale_SetAutoZero(bool on) {
   autoZeroEnabled     = on;
@@ -346,6 +493,35 @@ void Scale_SetAutoZero(bool on) {
 
 bool Scale_GetAutoZero() { return autoZeroEnabled; }
 
+void Scale_SetAdaptiveAcquisition(bool on) {
+  acqAdaptive = on;
+  acqRestart();
+}
+
+bool Scale_GetAdaptiveAcquisition() { return acqAdaptive; }
+
+unsigned long Scale_GetIdleIntervalMs() {
+  return acqAdaptive ? acqIntervals[acqLevel] : fixedIntervalMs;
+}
+
+void Scale_SetFixedIntervalMs(unsigned long ms) {
+  fixedIntervalMs = max(ms, (unsigned long)LOOP_DELAY_IDLE_MS);
+}
+
+unsigned long Scale_GetFixedIntervalMs() { return fixedIntervalMs; }
+
+void Scale_SetEmaAlpha(float alpha) {
+  pipeline.setEmaAlpha(constrain(alpha, 0.01f, 1.0f));
+}
+
+float Scale_GetEmaAlpha() { return pipeline.emaAlpha(); }
+
+void Scale_SetSamplesPerRead(uint8_t samples) {
+  samplesPerRead = constrain(samples, 1, HX711_SAMPLES_READ_MAX);
+}
+
+uint8_t Scale_GetSamplesPerRead() { return samplesPerRead; }
+
 void Scale_SetTaraLock(bool on) {
   // При включении Tara Lock отключаем auto-zero независимо от его настройки
   if (on) {
@@ -356,32 +532,201 @@ void Scale_SetTaraLock(bool on) {
   autoZeroStableCount = 0;
 }
 
+// -------------------------------------------------------
+// Forced light sleep
+// -------------------------------------------------------
+// Причина пробуждения из forced light sleep
+enum WakeReason {
+  WAKE_TIMER,    // истёк таймер wifi_fpm_do_sleep
+  WAKE_BUTTON,   // кнопка нажата (BUTTON_PIN = LOW)
+  WAKE_HX711     // конверсия готова (DOUT_PIN = LOW)
+};
+
+// Суммарное время в forced light sleep с момента старта (по RTC, мс)
+static unsigned long sleepTotalMs = 0;
+// Время сна, не учтённое в millis() — накапливается до Scale_TakeMillisLag()
+static unsigned long millisLagMs = 0;
+// То же с момента старта, без сброса — поправка Scale_Millis()
+static unsigned long millisLagTotalMs = 0;
+
+#if POWER_FORCED_LIGHT_SLEEP
+// Колбэк пробуждения обязателен для wifi_fpm — действий не требуется
+static void IRAM_ATTR lightSleepWakeCb() {}
+
+// Усыпить CPU на us микросекунд или до LOW на кнопке / DOUT (если wakeOnDout).
+// Сон начинается внутри delay() после wifi_fpm_do_sleep(). Счётчик millis() во время
+// forced light sleep не идёт, поэтому длительность меряется по RTC-таймеру.
+// Требует WiFi.mode(WIFI_OFF) (NULL_MODE) — выполняется в setup().
+static uint32_t forcedLightSleep(uint32_t us, bool wakeOnDout, WakeReason* reason) {
+  POWER_SCOPE(PH_LIGHT_SLEEP);
+  unsigned long ms0 = millis();
+  uint32_t rtc0 = system_get_rtc_time();
+
+  wifi_set_opmode_current(NULL_MODE);
+  wifi_fpm_set_sleep_type(LIGHT_SLEEP_T);
+  wifi_fpm_open();
+  gpio_pin_wakeup_enable(GPIO_ID_PIN(BUTTON_PIN), GPIO_PIN_INTR_LOLEVEL);
+  if (wakeOnDout) {
+    gpio_pin_wakeup_enable(GPIO_ID_PIN(DOUT_PIN), GPIO_PIN_INTR_LOLEVEL);
+  }
+  wifi_fpm_set_wakeup_cb(lightSleepWakeCb);
+  wifi_fpm_do_sleep(us);
+  delay(us / 1000UL + 1);
+  gpio_pin_wakeup_disable();
+  wifi_fpm_close();
+
+  // Калибровка RTC — период тика в мкс в формате Q12
+  uint32_t sleptUs = (uint32_t)(((uint64_t)(system_get_rtc_time() - rtc0) *
+                                 system_rtc_clock_cali_proc()) >> 12);
+  PowerStats_AddSleepUs(sleptUs);
+  unsigned long sleptMs = sleptUs / 1000UL;
+  unsigned long countedMs = millis() - ms0;
+  sleepTotalMs += sleptMs;
+  if (sleptMs > countedMs) {
+    millisLagMs += sleptMs - countedMs;
+    millisLagTotalMs += sleptMs - countedMs;
+  }
+
+  if      (digitalRead(BUTTON_PIN) == LOW)              *reason = WAKE_BUTTON;
+  else if (wakeOnDout && digitalRead(DOUT_PIN) == LOW) *reason = WAKE_HX711;
+  else                                                 *reason = WAKE_TIMER;
+  return sleptUs;
+}
+#endif
+
 // -------------------------------------------------------
 // Scale_PowerSave
 // PI-2 fix: сон разбит на шаги по LOOP_DELAY_MS с опросом кнопки,
 // иначе нажатия короче 250 мс в режиме ожидания полностью теряются.
+//
+// POWER_FORCED_LIGHT_SLEEP: CPU останавливается целиком.
+//   Фаза 1 — HX711 выключен, сон до нажатия кнопки или конца интервала.
+//   Фаза 2 — HX711 включён, сон до первой готовой конверсии (DOUT=LOW).
+// Пока автомат кнопки не в BTN_IDLE (антидребезг, окно подтверждения) —
+// обычные шаги delay(), иначе уровень LOW на кнопке будил бы CPU сразу.
+//
+// Нажатие кнопки прерывает сон (интервал адаптивного опроса может быть 30 с)
+// и возвращает график опроса на первую ступень. Состояние фильтров сохраняется:
+// первая конверсия после power_up уже установившаяся (ожидание DOUT в фазе 2).
 // -------------------------------------------------------
 void Scale_PowerSave(unsigned long ms) {
-  scale.power_down();
-  wifi_set_sleep_type(LIGHT_SLEEP_T);
+  ScaleAdc& adc = Scale_Adc();
+  adc.powerDown();
   autoZeroStableCount = 0; // сбрасываем счётчик — после сна первые чтения нестабильны
 
   pendingAction = BTN_NONE;
   unsigned long elapsed = 0;
+
+#if POWER_FORCED_LIGHT_SLEEP
+  while (elapsed < ms) {
+    unsigned long left = ms - elapsed;
+    if (Button_IsIdle() && left >= LIGHT_SLEEP_MIN_MS) {
+      // Пробуждение кнопкой переводит автомат в антидребезг — дальше шаги delay()
+      WakeReason reason;
+      elapsed += forcedLightSleep(left * 1000UL, false, &reason) / 1000UL;
+    } else {
+      unsigned long step = min((unsigned long)LOOP_DELAY_MS, left);
+      POWER_SCOPE(PH_IDLE_DELAY);
+      delay(step);
+      elapsed += step;
+    }
+    pollButton();
+    ESP.wdtFeed();
+    if (!Button_IsIdle() || pendingAction != BTN_NONE) {
+      acqRestart();
+      break;
+    }
+  }
+
+  adc.powerUp();
+  if (Button_IsIdle()) {
+    WakeReason reason;
+    forcedLightSleep(HX711_TIMEOUT_MS * 1000UL, true, &reason);
+    if (reason == WAKE_TIMER) LOG(HX_NO_CONVERSION);
+  }
+#else
+  wifi_set_sleep_type(LIGHT_SLEEP_T);
   while (elapsed < ms) {
     unsigned long step = min((unsigned long)LOOP_DELAY_MS, ms - elapsed);
-    delay(step);
-    elapsed += step;
-    ButtonAction a = Button_Update();
-    // Сохраняем первое значимое действие — оно будет обработано в loop()
-    if (pendingAction == BTN_NONE && a != BTN_NONE && a != BTN_SHOW_HINT) {
-      pendingAction = a;
+    {
+      POWER_SCOPE(PH_IDLE_DELAY);
+      delay(step);
     }
+    elapsed += step;
+    pollButton();
     ESP.wdtFeed();
+    if (!Button_IsIdle() || pendingAction != BTN_NONE) {
+      acqRestart();
+      break;
+    }
+  }
+
+  adc.powerUp();
+#endif
+
+  acqAfterSleep = true;
+}
+
+// -------------------------------------------------------
+// Scale_MeasureHeadless
+// Одиночное измерение без UI (режим улья): HX711 включается, CPU спит в forced
+// light sleep на время установления и до каждой конверсии, результат — медиана
+// samples конверсий. После измерения HX711 выключается.
+// -------------------------------------------------------
+bool Scale_MeasureHeadless(uint8_t samples, float* kg) {
+  ScaleAdc& adc = Scale_Adc();
+  long buf[HIVE_SAMPLES];
+  if (samples == 0 || samples > HIVE_SAMPLES) samples = HIVE_SAMPLES;
+
+  adc.begin();
+  Scale_ApplyCalibration();
+
+#if POWER_FORCED_LIGHT_SLEEP
+  WakeReason reason;
+  forcedLightSleep(HIVE_SETTLE_MS * 1000UL, false, &reason);
+#else
+  delay(HIVE_SETTLE_MS);
+#endif
+  // Нажатие кнопки — вызывающий переходит к полному интерфейсу, HX711 остаётся включён
+  if (digitalRead(BUTTON_PIN) == LOW) return false;
+
+  bool ok = true;
+  for (uint8_t i = 0; i < samples && ok; i++) {
+#if POWER_FORCED_LIGHT_SLEEP
+    if (!adc.isReady()) forcedLightSleep(HX711_TIMEOUT_MS * 1000UL, true, &reason);
+#endif
+    {
+      POWER_SCOPE(PH_HX711_WAIT);
+      ok = adc.waitReady(HX711_TIMEOUT_MS);
+    }
+    if (ok) {
+      POWER_SCOPE(PH_HX711_READ);
+      // Вставка в отсортированный буфер — медиана без отдельной сортировки
+      long v = adc.read();
+      uint8_t j = i;
+      while (j > 0 && buf[j - 1] > v) { buf[j] = buf[j - 1]; j--; }
+      buf[j] = v;
+    }
   }
+  adc.powerDown();
+  if (!ok) return false;
+
+  *kg = countsToKg((float)buf[samples / 2]);
+  return !isnan(*kg) && !isinf(*kg);
+}
+
+unsigned long Scale_GetSleepMs() {
+  return sleepTotalMs;
+}
+
+unsigned long Scale_Millis() {
+  return millis() + millisLagTotalMs;
+}
 
-  scale.power_up();
-  filterInitialized = false; // первое чтение после power_up нестабильно
+unsigned long Scale_TakeMillisLag() {
+  unsigned long lag = millisLagMs;
+  millisLagMs = 0;
+  return lag;
 }
 
 ButtonAction Scale_GetPendingAction() {
@@ -2,18 +2,19 @@
 #include "Config.h"
 #include "MemoryControl.h"
 #include "ButtonControl.h"
-#include <HX711.h>
+#include "ScaleAdc.h"
 
-extern HX711 scale;
 extern float session_delta;
-extern float current_weight;
-extern float display_weight;
 extern bool undoAvailable;
 
-void Scale_Init();            // Инициализация датчика
+void Scale_Begin();           // Питание HX711 (начало установления), до Memory_Init
+void Scale_Init();            // Инициализация датчика (со снимком фильтров, если вес тот же)
+void Scale_SaveSnapshot();    // Снимок фильтров в RTC-память перед deep sleep
 void Scale_Update();          // Обновление веса (фильтры, стабильность)
 bool Scale_Tare();            // Тарирование (обнуление)
 bool Scale_UndoTare();        // Отмена тарирования
+float Scale_GetWeight();      // Вес после фильтров (кг) или WEIGHT_ERROR_FLAG
+float Scale_GetDisplayWeight(); // Вес для дисплея: округлённый или замороженный
 bool Scale_IsStable();        // Вес стабилен?
 bool Scale_IsIdle();          // Весы в простое?
 bool Scale_IsFrozen();        // Показания заморожены?
@@ -25,4 +26,22 @@ bool Scale_GetAutoZero();           // Состояние авто-нуля
 void Scale_SetTaraLock(bool on);    // Вкл/выкл блокировку тары
 
 void Scale_PowerSave(unsigned long ms);           // Энергосбережение (сон)
-ButtonAction Scale_GetPendingAction();            // Действие кнопки, пойманное во время сна
+unsigned long Scale_GetIdleIntervalMs();          // Интервал сна по графику адаптивного опроса (мс)
+void Scale_SetAdaptiveAcquisition(bool on);       // Вкл/выкл адаптивный опрос (иначе LOOP_DELAY_IDLE_MS)
+bool Scale_GetAdaptiveAcquisition();              // Адаптивный опрос включён?
+void Scale_SetFixedIntervalMs(unsigned long ms);  // Период опроса без адаптивного режима (не меньше LOOP_DELAY_IDLE_MS)
+unsigned long Scale_GetFixedIntervalMs();
+void Scale_SetEmaAlpha(float alpha);              // Коэффициент EMA (0.01..1), по умолчанию WEIGHT_EMA_ALPHA
+float Scale_GetEmaAlpha();
+void Scale_SetSamplesPerRead(uint8_t samples);    // Конверсий HX711 на одно чтение (1..HX711_SAMPLES_READ_MAX)
+uint8_t Scale_GetSamplesPerRead();
+void Scale_ApplyCalibration();                    // cal_factor, offset тары и поправку линейности из savedData — в пересчёт веса
+long Scale_GetOffset();                           // offset тары, отсчёты АЦП
+float Scale_GetCalFactor();                       // cal_factor пересчёта, отсчётов на кг
+bool Scale_PollCounts(long* counts);              // Готовая конверсия HX711 без ожидания; false — не готова
+bool Scale_MeasureHeadless(uint8_t samples, float* kg); // Измерение без UI (режим улья), HX711 выключается
+ButtonAction Scale_GetPendingAction();            // Действие кнопки, пойманное во сне или чтении HX711 (со сбросом)
+unsigned long Scale_GetSleepMs();                 // Суммарное время в light sleep с момента старта (мс)
+unsigned long Scale_TakeMillisLag();              // Время сна, не учтённое в millis() (мс), со сбросом
+unsigned long Scale_Millis();                     // millis() вместе со временем light sleep — для интервальных таймеров
+ScaleAdc& Scale_Adc();                            // АЦП весов (HX711)
@@ -0,0 +1,218 @@
+#pragma once
+#include <Arduino.h>
+#include <math.h>
+#include <string.h>
+#include <type_traits>
+#include "Config.h"
+
+// Цепочка обработки веса одного канала:
+//   отсчёт (кг) → медиана MedianN → EMA → окно стабильности StabilityN →
+//   перегрузка → тренд → заморозка показаний.
+// Размеры окон — параметры шаблона: индексы окон длиной 2^k заворачиваются
+// маской, остальных — сравнением, без деления. Пороги, шаг показания и
+// начальный коэффициент EMA — из профиля (Profiles.h), по умолчанию выбранного
+// при сборке. Прошивка держит один экземпляр (ScaleControl), хостовые тесты и
+// host/build/pipeline_bench — сколько угодно. Чтение АЦП (ScaleAdc.h), пересчёт
+// в кг, авто-нуль и адаптивный опрос — вне шаблона, в ScaleControl.
+template <uint8_t MedianN, uint8_t StabilityN, typename Sample = float,
+          typename Profile = ScaleProfile>
+class ScalePipeline {
+  static_assert(std::is_floating_point<Sample>::value, "Sample - weight in kg, float or double");
+  static_assert(MedianN % 2 == 1 && MedianN <= 15, "median window must be odd, up to 15");
+  static_assert(StabilityN >= 2 && StabilityN <= 128, "stability window 2..128");
+
+public:
+  // Состояние, которое переживает deep sleep (снимок ScaleControl в RTC-памяти)
+  struct State {
+    Sample  filtered;
+    Sample  history[StabilityN];
+    Sample  median[MedianN];
+    Sample  frozen;
+    Sample  prevTrend;
+    uint8_t historyIdx;
+    uint8_t historyFull;
+    uint8_t medianIdx;
+    uint8_t medianCount;
+    uint8_t isFrozen;
+    int8_t  trend;
+  };
+
+  explicit ScalePipeline(float a = Profile::emaAlpha) : alpha(a) { reset(); }
+
+  // Всё с нуля: EMA инициализируется первым отсчётом
+  void reset() {
+    memset(&s, 0, sizeof(s));
+    initialized = false;
+    overloaded  = false;
+    medianOut   = 0;
+    display     = 0;
+  }
+
+  // Восстановление после ошибок АЦП: окна и EMA заново, заморозка и тренд остаются
+  void restartFilter() {
+    s.historyIdx  = 0;
+    s.historyFull = 0;
+    clearMedian();
+    initialized   = false;
+  }
+
+  // Медиана заново — старые значения не скроют скачок веса
+  void clearMedian() {
+    s.medianIdx   = 0;
+    s.medianCount = 0;
+  }
+
+  // Окна, заморозка и тренд заново; EMA остаётся (тара, отмена тары)
+  void clearWindows() {
+    memset(s.history, 0, sizeof(s.history));
+    s.historyIdx  = 0;
+    s.historyFull = 0;
+    clearMedian();
+    s.isFrozen    = 0;
+    s.trend       = 0;
+  }
+
+  // EMA и показание без сброса окон (шаг авто-нуля)
+  void setFiltered(Sample w) {
+    s.filtered = w;
+    display    = roundWeight(w);
+  }
+
+  // Начальное значение EMA и опора тренда (старт, тара, отмена тары)
+  void seed(Sample w) {
+    setFiltered(w);
+    s.prevTrend = w;
+    initialized = true;
+  }
+
+  void push(Sample raw) {
+    // -- Медианный фильтр --
+    s.median[s.medianIdx] = raw;
+    s.medianIdx = next<MedianN>(s.medianIdx);
+    if (s.medianCount < MedianN) s.medianCount++;
+    medianOut = s.medianCount >= MedianN ? medianOf() : raw;
+
+    // -- EMA-фильтр --
+    if (!initialized) {
+      s.filtered  = medianOut;
+      initialized = true;
+    } else {
+      Sample k = alpha;
+      s.filtered = (k * medianOut) + (((Sample)1 - k) * s.filtered);
+    }
+
+    // -- Окно стабильности --
+    s.history[s.historyIdx] = s.filtered;
+    s.historyIdx = next<StabilityN>(s.historyIdx);
+    if (s.historyIdx == 0) s.historyFull = 1;
+
+    overloaded = fabs(s.filtered) > Profile::overloadKg;
+
+    // -- Тренд --
+    Sample diff = s.filtered - s.prevTrend;
+    if      (diff >  Profile::trendThreshold) s.trend =  1;
+    else if (diff < -Profile::trendThreshold) s.trend = -1;
+    else                              s.trend =  0;
+    s.prevTrend = s.filtered;
+
+    // -- Авто-заморозка --
+    Sample rounded = roundWeight(s.filtered);
+    if (s.isFrozen) {
+      if (fabs(rounded - s.frozen) > Profile::freezeThreshold) {
+        s.isFrozen = 0;
+        display    = rounded;
+      }
+    } else {
+      display = rounded;
+      if (isStable()) {
+        s.frozen   = rounded;
+        s.isFrozen = 1;
+      }
+    }
+  }
+
+  // Размах окна стабильности меньше порога профиля
+  bool isStable() const {
+    uint8_t count = s.historyFull ? StabilityN : s.historyIdx;
+    if (count < 2) return false;
+    Sample minVal = s.history[0];
+    Sample maxVal = s.history[0];
+    for (uint8_t i = 1; i < count; i++) {
+      if (s.history[i] < minVal) minVal = s.history[i];
+      if (s.history[i] > maxVal) maxVal = s.history[i];
+    }
+    return (maxVal - minVal) < Profile::stabilityThreshold;
+  }
+
+  // ===== Снимок состояния =====
+  static bool valid(const State& st) {
+    return st.historyIdx < StabilityN && st.medianIdx < MedianN && st.medianCount <= MedianN;
+  }
+
+  void save(State* out) const { *out = s; }
+
+  // Только для valid(st)
+  void restore(const State& st) {
+    s = st;
+    initialized = true;
+    display = s.isFrozen ? s.frozen : roundWeight(s.filtered);
+  }
+
+  Sample filtered() const      { return s.filtered; }
+  Sample displayWeight() const { return display; }       // Округлённый или замороженный
+  Sample medianValue() const   { return medianOut; }     // Вход EMA последнего отсчёта
+  bool   isInitialized() const { return initialized; }
+  bool   isFrozen() const      { return s.isFrozen != 0; }
+  bool   isOverloaded() const  { return overloaded; }
+  bool   medianFull() const    { return s.medianCount >= MedianN; }
+  int8_t trend() const         { return s.trend; }
+  float  emaAlpha() const      { return alpha; }
+  void   setEmaAlpha(float a)  { alpha = a; }
+
+  // Округление до шага показания профиля (для отображения на дисплее)
+  static Sample roundWeight(Sample w) {
+    return round(w * (Sample)Profile::displayScale) / (Sample)Profile::displayScale;
+  }
+
+private:
+  template <uint8_t N>
+  static uint8_t next(uint8_t i) {
+    if constexpr ((N & (N - 1)) == 0) {
+      return (i + 1) & (N - 1);
+    } else {
+      return i + 1 < N ? i + 1 : 0;
+    }
+  }
+
+  Sample medianOf() const {
+    if constexpr (MedianN == 1) {
+      return s.median[0];
+    } else if constexpr (MedianN == 3) {
+      // Сеть из трёх обменов — убирает одиночные выбросы АЦП
+      Sample a = s.median[0], b = s.median[1], c = s.median[2];
+      if (a > b) { Sample t = a; a = b; b = t; }
+      if (b > c) { Sample t = b; b = c; c = t; }
+      if (a > b) { Sample t = a; a = b; b = t; }
+      return b;
+    } else {
+      Sample v[MedianN];
+      for (uint8_t i = 0; i < MedianN; i++) {
+        uint8_t j = i;
+        while (j > 0 && v[j - 1] > s.median[i]) { v[j] = v[j - 1]; j--; }
+        v[j] = s.median[i];
+      }
+      return v[MedianN / 2];
+    }
+  }
+
+  State  s;
+  bool   initialized;
+  bool   overloaded;
+  float  alpha;
+  Sample medianOut;
+  Sample display;
+};
+
+// Цепочка с окнами и порогами профиля
+template <typename Profile, typename Sample = float>
+using ProfilePipeline = ScalePipeline<Profile::medianWindow, Profile::stabilityWindow, Sample, Profile>;
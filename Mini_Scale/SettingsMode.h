@@ -1,9 +1,20 @@
 #pragma once
 #include <Arduino.h>
+#include "ButtonControl.h"
 
 // Экспортируемые таблицы значений (определены в SettingsMode.cpp)
 extern const unsigned long autoOffValues[];
 extern const unsigned long autoDimValues[];
+extern const unsigned long hiveIntervalValues[];   // секунды, 0 = режим улья выключен
 
-void RunSettingsMode();   // Вход в меню настроек (блокирующая)
+enum SettingsExit : uint8_t {
+  SETTINGS_OPEN,      // Меню ещё открыто
+  SETTINGS_SAVED,     // Сохранено в EEPROM и применено
+  SETTINGS_TIMEOUT,   // Простой SETTINGS_IDLE_TIMEOUT_MS — без сохранения
+};
+
+// Меню настроек — состояние UI, шаг из loop() без ожидания
+void Settings_Begin();                             // Открыть (кнопка входа ещё нажата)
+SettingsExit Settings_Update(ButtonAction action); // Шаг: действие кнопки, таймаут, перерисовка
+void Settings_Cancel();                            // Закрыть без сохранения (критический заряд)
 void ApplySettings();    // Применить яркость и авто-ноль из EEPROM
@@ -0,0 +1,61 @@
+#include "Telemetry.h"
+#include <Arduino.h>
+#include <stddef.h>
+
+static_assert(sizeof(TelemetryRecord) == 24, "TelemetryRecord is part of the wire format");
+
+uint8_t Telemetry_Crc8(const uint8_t* data, uint8_t len) {
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+#if TELEMETRY_ENABLED
+
+static bool active = false;
+static uint8_t seq = 0;
+static uint16_t dropped = 0;
+
+void Telemetry_Toggle() {
+  if (active) {
+    Serial.printf("\n[TEL] off, %u dropped\n", dropped);
+  } else {
+    Serial.println(F("[TEL] on"));
+  }
+  active = !active;
+  seq = 0;
+  dropped = 0;
+}
+
+bool Telemetry_Active() {
+  return active;
+}
+
+// Без ожидания: нет места в TX FIFO — запись пропадает, счётчик растёт
+void Telemetry_Sample(long raw, float medianKg, float emaKg, uint8_t flags) {
+  if (!active) return;
+  TelemetryRecord rec;
+  rec.seq = seq++;
+  if (Serial.availableForWrite() < (int)sizeof(rec)) {
+    if (dropped < 0xFFFF) dropped++;
+    return;
+  }
+  rec.sync0 = TELEMETRY_SYNC0;
+  rec.sync1 = TELEMETRY_SYNC1;
+  rec.flags = flags;
+  rec.ms = millis();
+  rec.raw = raw;
+  rec.medianKg = medianKg;
+  rec.emaKg = emaKg;
+  rec.dropped = dropped;
+  rec.reserved = 0;
+  rec.crc8 = Telemetry_Crc8((const uint8_t*)&rec, offsetof(TelemetryRecord, crc8));
+  Serial.write((const uint8_t*)&rec, sizeof(rec));
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include "Config.h"
+
+// Поток записей фильтра веса для настройки (host/build/telemetry_decode -> CSV).
+// Запись фиксированной длины с синхрословом и CRC8: приёмник находит границы
+// и в потоке, перемешанном с отладочным текстом.
+
+#define TELEMETRY_SYNC0         0xA5
+#define TELEMETRY_SYNC1         0x5A
+
+// Флаги записи
+#define TEL_FLAG_STABLE         0x01   // Scale_IsStable()
+#define TEL_FLAG_OVERLOAD       0x02
+#define TEL_FLAG_MEDIAN_FULL    0x04   // Окно медианы заполнено (иначе median = raw)
+
+struct TelemetryRecord {
+  uint8_t  sync0;
+  uint8_t  sync1;
+  uint8_t  seq;        // Растёт на каждую серию, включая отброшенные
+  uint8_t  flags;      // TEL_FLAG_*
+  uint32_t ms;         // millis()
+  int32_t  raw;        // Среднее отсчётов HX711 за серию
+  float    medianKg;   // Выход медианного фильтра
+  float    emaKg;      // Выход EMA
+  uint16_t dropped;    // Отброшено записей с включения (насыщается)
+  uint8_t  reserved;
+  uint8_t  crc8;       // CRC8 (полином 0x07) всех байт выше
+};
+
+uint8_t Telemetry_Crc8(const uint8_t* data, uint8_t len);
+
+#if TELEMETRY_ENABLED
+
+void Telemetry_Toggle();                 // Вкл/выкл (команда t консоли)
+bool Telemetry_Active();
+void Telemetry_Sample(long raw, float medianKg, float emaKg, uint8_t flags);
+
+#else
+
+inline void Telemetry_Toggle() {}
+inline bool Telemetry_Active() { return false; }
+inline void Telemetry_Sample(long, float, float, uint8_t) {}
+
+#endif
@@ -0,0 +1,17 @@
+#include "UiText.h"
+
+namespace UiText {
+
+const char kLowBattery[] PROGMEM = "LOW BATTERY!";
+const char kPressAgain[] PROGMEM = "Press again";
+const char kCancelled[] PROGMEM = "Cancelled";
+const char kCancelledBang[] PROGMEM = "Cancelled!";
+const char kTareOk[] PROGMEM = "TARE OK!";
+const char kTareFailed[] PROGMEM = "TARE FAILED!";
+const char kUndoOk[] PROGMEM = "UNDO OK!";
+const char kNoUndo[] PROGMEM = "NO UNDO";
+const char kAutoPowerOff[] PROGMEM = "Auto Power Off...";
+const char kSaved[] PROGMEM = "SAVED!";
+const char kTimeout[] PROGMEM = "Timeout...";
+
+} // namespace UiText
@@ -1,17 +1,20 @@
 #pragma once
+#include <Arduino.h>
 
+// Сообщения на весь экран. Строки во flash (PROGMEM): печатать через
+// Display_ShowMessage или FPSTR, читать — функциями *_P
 namespace UiText {
 
-static constexpr const char* kLowBattery = "LOW BATTERY!";
-static constexpr const char* kPressAgain = "Press again";
-static constexpr const char* kCancelled = "Cancelled";
-static constexpr const char* kCancelledBang = "Cancelled!";
-static constexpr const char* kTareOk = "TARE OK!";
-static constexpr const char* kTareFailed = "TARE FAILED!";
-static constexpr const char* kUndoOk = "UNDO OK!";
-static constexpr const char* kNoUndo = "NO UNDO";
-static constexpr const char* kAutoPowerOff = "Auto Power Off...";
-static constexpr const char* kSaved = "SAVED!";
-static constexpr const char* kTimeout = "Timeout...";
+extern const char kLowBattery[];
+extern const char kPressAgain[];
+extern const char kCancelled[];
+extern const char kCancelledBang[];
+extern const char kTareOk[];
+extern const char kTareFailed[];
+extern const char kUndoOk[];
+extern const char kNoUndo[];
+extern const char kAutoPowerOff[];
+extern const char kSaved[];
+extern const char kTimeout[];
 
 } // namespace UiText
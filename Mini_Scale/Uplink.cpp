@@ -0,0 +1,326 @@
+#include "Uplink.h"
+#include "Crc16.h"
+#include "HistoryStore.h"
+#include "RtcLog.h"
+#include "SampleCodec.h"
+#include "RamStats.h"
+#include <ESP8266WiFi.h>
+
+// Состояние в RTC-памяти, 5 блоков; CRC покрывает всё кроме поля crc16
+struct UplinkState {
+  uint8_t  magic;
+  uint8_t  failures : 7;  // Неудач подряд (определяет паузу до повтора)
+  uint8_t  armed    : 1;  // Последний deep sleep — с включённым RF
+  uint16_t crc16;
+  uint32_t sentPos;       // Позиция первого неотправленного блока архива
+  uint32_t nextTs;        // Следующая попытка не раньше
+  uint32_t radioMs;       // Суммарное время с включённым радио
+  uint32_t samples;       // Доставлено записей
+};
+
+static_assert(sizeof(UplinkState) == 20, "UplinkState занимает 5 блоков RTC");
+static_assert(UPLINK_RTC_OFFSET + sizeof(UplinkState) / 4 <= CLOCK_RTC_OFFSET,
+              "Uplink state overlaps the clock block");
+
+static UplinkState state;
+static bool loaded = false;
+static bool enabled = UPLINK_ENABLED;
+
+static uint16_t calcCRC16() {
+  uint16_t crc = Crc16_Update(CRC16_INIT, &state, offsetof(UplinkState, crc16));
+  return Crc16_Update(crc, &state.sentPos, sizeof(state) - offsetof(UplinkState, sentPos));
+}
+
+static void saveState() {
+  state.crc16 = calcCRC16();
+  ESP.rtcUserMemoryWrite(UPLINK_RTC_OFFSET, (uint32_t*)&state, sizeof(state));
+}
+
+// Холодный старт или повреждение — выгрузка с текущего конца архива, сразу
+void Uplink_Reset() {
+  memset(&state, 0, sizeof(state));
+  state.magic = UPLINK_RTC_MAGIC;
+  state.sentPos = History_EndPosition();
+  loaded = true;
+  saveState();
+}
+
+static void loadState() {
+  if (loaded) return;
+  ESP.rtcUserMemoryRead(UPLINK_RTC_OFFSET, (uint32_t*)&state, sizeof(state));
+  loaded = true;
+  if (state.magic != UPLINK_RTC_MAGIC || state.crc16 != calcCRC16()) Uplink_Reset();
+}
+
+bool Uplink_Enabled() {
+  return enabled;
+}
+
+void Uplink_SetEnabled(bool on) {
+  enabled = on;
+}
+
+bool Uplink_Due(uint32_t now) {
+  if (!enabled) return false;
+  loadState();
+  return now >= state.nextTs;
+}
+
+// Проснуться с RF, только если на пробуждении будет попытка: калибровка
+// и питание радио при загрузке стоят заметно дороже самого замера
+RFMode Uplink_PrepareSleep(uint32_t wakeTs) {
+  if (!enabled) return WAKE_RF_DISABLED;
+  loadState();
+  bool arm = wakeTs >= state.nextTs;
+  if (state.armed != arm) {
+    state.armed = arm;
+    saveState();
+  }
+  return arm ? WAKE_RF_DEFAULT : WAKE_RF_DISABLED;
+}
+
+void Uplink_GetStats(UplinkStats* out) {
+  loadState();
+  out->radioMs = state.radioMs;
+  out->samples = state.samples;
+  out->nextTs = state.nextTs;
+  out->failures = state.failures;
+}
+
+// ===== Отправка =====
+
+// Блок в c->block цел? Повреждённые блоки не отправляются
+static bool blockValid(const HistoryCursor& c, CodecBlockHeader* hdr) {
+  CodecDecoder d;
+  if (!Codec_Open(&d, c.block, HISTORY_BLOCK_SIZE)) return false;
+  memcpy(hdr, c.block, sizeof(*hdr));
+  return true;
+}
+
+struct UplinkBatch {
+  uint8_t  blocks;
+  uint32_t bodyLen;
+  uint32_t records;
+  uint32_t endPos;    // Позиция после последнего блока пачки
+  bool     more;      // В архиве осталось неотправленное
+};
+
+// Проход по архиву без отправки: размер тела для Content-Length
+static void planBatch(uint32_t from, UplinkBatch* b) {
+  memset(b, 0, sizeof(*b));
+  b->bodyLen = 4;
+  b->endPos = from;
+  HistoryCursor c;
+  uint32_t pos;
+  CodecBlockHeader hdr;
+  History_OpenBlocks(&c, from);
+  while (History_NextBlock(&c, &pos)) {
+    if (b->blocks >= UPLINK_MAX_BLOCKS) {
+      b->more = true;
+      break;
+    }
+    b->endPos = pos + 1;
+    if (!blockValid(c, &hdr)) continue;
+    b->blocks++;
+    b->bodyLen += CODEC_HEADER_SIZE + hdr.length;
+    b->records += hdr.count;
+  }
+}
+
+static void writeBody(UplinkTransport& t, uint32_t from, const UplinkBatch& b) {
+  const uint8_t preamble[4] = { 'H', 'V', UPLINK_FORMAT_VERSION, b.blocks };
+  t.write(preamble, sizeof(preamble));
+  HistoryCursor c;
+  uint32_t pos;
+  CodecBlockHeader hdr;
+  History_OpenBlocks(&c, from);
+  while (History_NextBlock(&c, &pos) && pos < b.endPos) {
+    if (!blockValid(c, &hdr)) continue;
+    t.write(c.block, CODEC_HEADER_SIZE + hdr.length);
+    ESP.wdtFeed();
+  }
+}
+
+// ===== Сеанс по шагам =====
+// Шаг не ждёт сеть: консоль ведёт сеанс из loop(), не останавливая взвешивание,
+// Uplink_Run прогоняет те же шаги подряд. Тело (до UPLINK_MAX_BLOCKS блоков)
+// уходит одним шагом — долгие ожидания это ассоциация и ответ сервера.
+
+enum UplinkPhase : uint8_t { UP_IDLE, UP_RADIO, UP_SEND, UP_STATUS };
+
+struct UplinkSession {
+  uint8_t       phase;
+  uint8_t       statusLen;
+  char          status[16];  // Начало строки статуса "HTTP/1.1 200"
+  uint32_t      now;
+  unsigned long startedAt;   // Радио включено
+  unsigned long phaseAt;
+  UplinkBatch   batch;
+};
+
+static UplinkSession session;
+static_assert(sizeof(session) <= RAM_UPLINK_BYTES, "uplink session is over its RAM budget line");
+
+// Итог попытки: позиция, счётчики и расписание — в RTC
+static void finish(UplinkResult r) {
+  const UplinkBatch& b = session.batch;
+  uint32_t now = session.now;
+  if (r == UPLINK_OK) {
+    state.sentPos = b.endPos;
+    state.samples += b.records;
+    state.failures = 0;
+    // Остаток сверх UPLINK_MAX_BLOCKS — на следующем пробуждении
+    state.nextTs = b.more ? now : (now / UPLINK_WINDOW_SEC + 1) * UPLINK_WINDOW_SEC;
+  } else {
+    if (state.failures < 127) state.failures++;
+    uint32_t pause = UPLINK_RETRY_MIN_SEC << min<uint8_t>(state.failures - 1, 8);
+    state.nextTs = now + min<uint32_t>(pause, UPLINK_WINDOW_SEC);
+  }
+  saveState();
+  DEBUG_PRINTF("[UPLINK] result %u, %lu records, radio %lu ms total\n",
+               r, (unsigned long)b.records, (unsigned long)state.radioMs);
+}
+
+static UplinkStep endSession(UplinkTransport& t, UplinkResult r, UplinkResult* out) {
+  if (session.phase >= UP_SEND) t.stop();
+  t.radioOff();
+  state.radioMs += millis() - session.startedAt;
+  session.phase = UP_IDLE;
+  finish(r);
+  *out = r;
+  return UPLINK_STEP_DONE;
+}
+
+// Код ответа из строки статуса; 0 — нет ответа
+static int parseStatus() {
+  session.status[session.statusLen] = '\0';
+  const char* sp = strchr(session.status, ' ');
+  if (strncmp(session.status, "HTTP/1.", 7) != 0 || sp == nullptr) return 0;
+  return atoi(sp + 1);
+}
+
+static UplinkStep statusResult(UplinkTransport& t, UplinkResult* out) {
+  int status = parseStatus();
+  return endSession(t, (status >= 200 && status < 300) ? UPLINK_OK : UPLINK_HTTP_ERROR, out);
+}
+
+bool Uplink_Begin(UplinkTransport& t, uint32_t now, bool force, UplinkResult* r) {
+  loadState();
+  if (!force) {
+    if (!Uplink_Due(now)) {
+      *r = UPLINK_NOT_DUE;
+      return false;
+    }
+    if (!state.armed) {
+      *r = UPLINK_NO_RADIO;
+      return false;
+    }
+  }
+
+  // Всё накопленное в RTC — во flash: дальше работаем только с блоками архива
+  RtcLog_Load();
+  RtcLog_Flush();
+  uint32_t first = History_FirstPosition();
+  uint32_t end = History_EndPosition();
+  if (state.sentPos < first || state.sentPos > end) state.sentPos = first;
+
+  session.now = now;
+  planBatch(state.sentPos, &session.batch);
+  if (session.batch.blocks == 0) {
+    finish(UPLINK_OK);
+    *r = UPLINK_OK;
+    return false;
+  }
+  session.startedAt = millis();
+  session.phaseAt = session.startedAt;
+  session.phase = UP_RADIO;
+  t.radioBegin();
+  return true;
+}
+
+UplinkStep Uplink_Step(UplinkTransport& t, UplinkResult* r) {
+  switch (session.phase) {
+    case UP_RADIO: {
+      if (!t.radioReady()) {
+        if (millis() - session.phaseAt >= UPLINK_CONNECT_MS) return endSession(t, UPLINK_NO_WIFI, r);
+        return UPLINK_STEP_WAIT;
+      }
+      if (!t.connect()) return endSession(t, UPLINK_NO_SERVER, r);
+      session.phase = UP_SEND;
+      t.printf("POST %s HTTP/1.1\r\nHost: %s\r\n"
+               "Content-Type: application/octet-stream\r\nContent-Length: %lu\r\n"
+               "X-Device: %06lX\r\nConnection: close\r\n\r\n",
+               UPLINK_PATH, UPLINK_HOST, (unsigned long)session.batch.bodyLen,
+               (unsigned long)ESP.getChipId());
+      return UPLINK_STEP_BUSY;
+    }
+    case UP_SEND:
+      writeBody(t, state.sentPos, session.batch);
+      session.phase = UP_STATUS;
+      session.phaseAt = millis();
+      session.statusLen = 0;
+      return UPLINK_STEP_BUSY;
+    case UP_STATUS: {
+      int c;
+      while ((c = t.read()) >= 0) {
+        if (c == '\n') return statusResult(t, r);
+        if (session.statusLen < sizeof(session.status) - 1) session.status[session.statusLen++] = (char)c;
+      }
+      if (millis() - session.phaseAt >= UPLINK_RESPONSE_MS) return statusResult(t, r);
+      return UPLINK_STEP_WAIT;
+    }
+    default:
+      return UPLINK_STEP_DONE;
+  }
+}
+
+UplinkResult Uplink_Run(UplinkTransport& t, uint32_t now, bool force) {
+  UplinkResult r;
+  if (!Uplink_Begin(t, now, force, &r)) return r;
+  for (;;) {
+    UplinkStep step = Uplink_Step(t, &r);
+    if (step == UPLINK_STEP_DONE) return r;
+    if (step == UPLINK_STEP_WAIT) delay(UPLINK_POLL_MS);
+    ESP.wdtFeed();
+  }
+}
+
+// ===== WiFi =====
+
+class WifiTransport : public UplinkTransport {
+public:
+  void radioBegin() override {
+    WiFi.forceSleepWake();
+    delay(1);
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(UPLINK_SSID, UPLINK_PASS);
+  }
+  bool radioReady() override { return WiFi.status() == WL_CONNECTED; }
+  bool connect() override {
+    bool ok = client.connect(UPLINK_HOST, UPLINK_PORT);
+    RamStats_Sample();   // WiFi и сокет TCP открыты — в куче меньше всего места
+    return ok;
+  }
+  void stop() override { client.stop(); }
+  void radioOff() override {
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    WiFi.forceSleepBegin();
+    delay(1);
+  }
+
+  int available() override { return client.available(); }
+  int read() override { return client.read(); }
+  int peek() override { return client.peek(); }
+  size_t write(uint8_t c) override { return client.write(c); }
+  size_t write(const uint8_t* buf, size_t size) override { return client.write(buf, size); }
+
+private:
+  WiFiClient client;
+};
+
+UplinkTransport& Uplink_WifiTransport() {
+  static WifiTransport wifi;
+  return wifi;
+}
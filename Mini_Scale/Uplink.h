@@ -0,0 +1,64 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Выгрузка архива по WiFi пачкой: одно подключение на окно (Config.h, Uplink).
+//
+// Тело POST (application/octet-stream):
+//   'H' 'V' UPLINK_FORMAT_VERSION n   — 4 байта
+//   n блоков SampleCodec: заголовок + length байт данных (без хвоста блока flash)
+// Перед отправкой RTC-кольцо сбрасывается во flash, так что всё новое — блоки
+// архива начиная с позиции sentPos. Позиция двигается только после ответа 2xx;
+// потерянный ответ даёт повтор той же пачки — сервер отбрасывает записи по ts.
+//
+// Состояние (позиция, расписание, счётчики) — в RTC-памяти. После потери
+// питания выгрузка начинается с конца архива: старое забирается по 'x'.
+
+#define UPLINK_FORMAT_VERSION  1
+
+// Транспорт: радио, TCP к серверу и поток байт. На устройстве — WiFi
+// (Uplink_WifiTransport), на хосте — заглушка с сервером-двойником.
+class UplinkTransport : public Stream {
+public:
+  virtual void radioBegin() = 0;                      // Радио вкл, подключение к точке доступа начато
+  virtual bool radioReady() = 0;                      // Подключено к точке доступа
+  virtual bool connect() = 0;                         // TCP к UPLINK_HOST:UPLINK_PORT
+  virtual void stop() = 0;                            // Закрыть TCP
+  virtual void radioOff() = 0;
+};
+
+enum UplinkResult : uint8_t {
+  UPLINK_OK,
+  UPLINK_NOT_DUE,       // Окно ещё не наступило
+  UPLINK_NO_RADIO,      // Проснулись с выключенным RF — попытка на следующем пробуждении
+  UPLINK_NO_WIFI,
+  UPLINK_NO_SERVER,
+  UPLINK_HTTP_ERROR,    // Нет ответа или не 2xx
+};
+
+enum UplinkStep : uint8_t {
+  UPLINK_STEP_BUSY,     // Шаг сделан, следующий — сразу
+  UPLINK_STEP_WAIT,     // Ждём сеть: следующий шаг можно позже
+  UPLINK_STEP_DONE,     // Сеанс окончен, итог в *r
+};
+
+struct UplinkStats {
+  uint32_t radioMs;     // Суммарное время с включённым радио
+  uint32_t samples;     // Доставлено записей
+  uint32_t nextTs;      // Следующая попытка не раньше
+  uint8_t  failures;    // Неудач подряд
+};
+
+bool Uplink_Enabled();
+void Uplink_SetEnabled(bool on);     // Переопределить UPLINK_ENABLED (симулятор, тесты)
+bool Uplink_Due(uint32_t now);       // Пора выгружать (окно или повтор)
+// Выгрузить всё новое; force — без проверки окна (команда консоли)
+UplinkResult Uplink_Run(UplinkTransport& t, uint32_t now, bool force = false);
+// То же по шагам для loop(): Uplink_Begin, затем Uplink_Step до UPLINK_STEP_DONE.
+// false из Begin — сеанс не начат (не пора, нечего слать), итог уже в *r.
+bool Uplink_Begin(UplinkTransport& t, uint32_t now, bool force, UplinkResult* r);
+UplinkStep Uplink_Step(UplinkTransport& t, UplinkResult* r);
+RFMode Uplink_PrepareSleep(uint32_t wakeTs);  // Режим RF для deep sleep до wakeTs
+void Uplink_GetStats(UplinkStats* out);
+void Uplink_Reset();                 // Забыть состояние: выгрузка с конца архива
+UplinkTransport& Uplink_WifiTransport();
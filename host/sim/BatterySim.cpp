@@ -0,0 +1,272 @@
+// Симулятор автономности: прогоняет настоящую прошивку (setup/loop и все модули)
+// по сценарию на N суток для каждой комбинации AUTO_OFF / AUTO_DIM / яркости
+// и выводит расход и прогноз срока работы от батареи.
+//
+//   battery_sim [--days N] [--scenario файл] [--capacity мАч]
+//               [--combo OFF,DIM,BRIGHT] [--hive M] [--uplink] [--trace]
+//   battery_sim --stable-hour [--trace]   — экономия адаптивного опроса HX711
+
+#include "Sim.h"
+#include "PowerModel.h"
+#include "MemoryControl.h"
+#include "SettingsMode.h"
+#include "ScaleControl.h"
+#include "Uplink.h"
+
+extern "C" {
+  #include "user_interface.h"
+}
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+static const uint64_t US_PER_HOUR = 3600ULL * 1000000ULL;
+static const uint64_t US_PER_DAY = 24ULL * US_PER_HOUR;
+
+// Комбинация настроек для записи в EEPROM перед прогоном
+static uint8_t provOff = DEFAULT_AUTO_OFF_MODE;
+static uint8_t provDim = DEFAULT_AUTO_DIM_MODE;
+static uint8_t provBright = DEFAULT_BRIGHTNESS_LEVEL;
+static uint8_t provHive = DEFAULT_HIVE_INTERVAL_MODE;
+
+// «Прошивка на заводе»: настройки пользователя и тара пустой платформы
+static void provision() {
+  Memory_Init();
+  savedData.auto_off_mode = provOff;
+  savedData.auto_dim_mode = provDim;
+  savedData.brightness_level = provBright;
+  savedData.hive_interval_mode = provHive;
+  savedData.cal_factor = SIM_HX711_COUNTS_PER_KG;
+  savedData.tare_offset = SIM_HX711_ZERO_COUNTS;
+  savedData.backup_offset = SIM_HX711_ZERO_COUNTS;
+  savedData.last_weight = 0.0f;
+  Memory_ForceSave();
+}
+
+struct RunResult {
+  double mah;
+  double chargeMah[Sim::C_COUNT];
+  uint64_t stateUs[Sim::CPU_STATE_COUNT];
+  uint32_t boots;
+  uint32_t timerWakes;     // Пробуждений по таймеру режима улья
+  uint64_t timerAwakeUs;   // Суммарное время работы после таймерных пробуждений
+  uint32_t commits;
+  uint32_t frames;
+  uint32_t i2cWrongClock;
+  uint64_t boostUs;
+  uint64_t radioUs;
+  uint32_t uplinkPosts;
+  uint32_t uplinkRecords;
+  double endSoc;
+  bool crashed;
+};
+
+// Один прогон: питание подано в момент 0, дальше — по сценарию до endUs
+static RunResult runCombo(const Sim::Timeline& tl, uint64_t endUs) {
+  Sim::resetRun(&tl, endUs);
+  Sim::runInChild(provision);
+  Sim::clearStats();
+
+  RunResult r = {};
+  Sim::Outcome outcome = Sim::runBoot(REASON_DEFAULT_RST);
+  for (;;) {
+    if (outcome == Sim::OUT_RESTART) {
+      outcome = Sim::runBoot(Sim::shared->resetReason);
+      continue;
+    }
+    if (outcome == Sim::OUT_DEEP_SLEEP) {
+      if (SIM_HX711_OFF_IN_DEEP_SLEEP) Sim::hxPowerDown();
+      uint64_t now = Sim::nowUs();
+      uint64_t sleepUs = Sim::shared->sleepUs;
+      // RST будит всегда, таймер — только при sleepUs > 0
+      uint64_t rst = Sim::nextPowerEventAfter(now);
+      uint64_t timer = sleepUs > 0 ? now + sleepUs : UINT64_MAX;
+      uint64_t wake = rst < timer ? rst : timer;
+      if (wake >= endUs) {
+        Sim::advanceIn(Sim::CPU_DEEP_SLEEP, endUs - now);
+        break;
+      }
+      Sim::advanceIn(Sim::CPU_DEEP_SLEEP, wake - now);
+      if (wake == timer) r.timerWakes++;
+      uint64_t bootAt = Sim::nowUs();
+      outcome = Sim::runBoot(wake == timer ? REASON_DEEP_SLEEP_AWAKE : REASON_EXT_SYS_RST);
+      if (wake == timer) r.timerAwakeUs += Sim::nowUs() - bootAt;
+      continue;
+    }
+    r.crashed = (outcome != Sim::OUT_END);
+    break;
+  }
+
+  r.mah = Sim::totalMah();
+  for (int i = 0; i < Sim::C_COUNT; i++) r.chargeMah[i] = Sim::shared->chargeMaUs[i] / 3600e6;
+  for (int i = 0; i < Sim::CPU_STATE_COUNT; i++) r.stateUs[i] = Sim::shared->cpuStateUs[i];
+  r.boots = Sim::shared->boots;
+  r.commits = Sim::shared->eepromCommits;
+  r.frames = Sim::shared->frames;
+  r.i2cWrongClock = Sim::shared->i2cWrongClock;
+  r.boostUs = Sim::shared->cpuBoostUs;
+  r.radioUs = Sim::shared->radioUs;
+  r.uplinkPosts = Sim::shared->uplinkPosts;
+  r.uplinkRecords = Sim::shared->uplinkRecords;
+  r.endSoc = Sim::socNow();
+  return r;
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: battery_sim [--days N] [--scenario file] [--capacity mAh]\n"
+          "                   [--combo OFF,DIM,BRIGHT] [--hive M] [--uplink] [--trace]\n"
+          "       battery_sim --stable-hour [--trace]\n");
+}
+
+// Час под неизменной нагрузкой без автовыключения: адаптивный опрос HX711
+// против прежнего сна по LOOP_DELAY_IDLE_MS. Флаг ставится в родителе —
+// дочерние процессы прошивки наследуют его при fork.
+static int runStableHour() {
+  Sim::Timeline tl;
+  std::string error;
+  Sim::BuildTimeline("00:00 load 2.40\n", 1, &tl, &error);
+  provOff = AUTO_OFF_VALUES_COUNT - 1;   // "never"
+
+  printf("Stable load 2.40 kg, 1 h, auto-off disabled\n");
+  printf("%-10s %8s %10s %8s %12s\n",
+         "mode", "mAh/h", "hx711 mAh", "frames", "light sleep");
+  double mah[2] = {};
+  for (int adaptive = 0; adaptive < 2; adaptive++) {
+    Scale_SetAdaptiveAcquisition(adaptive != 0);
+    RunResult r = runCombo(tl, US_PER_HOUR);
+    mah[adaptive] = r.mah;
+    printf("%-10s %8.3f %10.3f %8u %11.1f%%%s\n",
+           adaptive ? "adaptive" : "fixed", r.mah, r.chargeMah[Sim::C_HX711], r.frames,
+           100.0 * r.stateUs[Sim::CPU_LIGHT_SLEEP] / US_PER_HOUR, r.crashed ? "  CRASH" : "");
+    if (r.crashed) return 2;
+  }
+  printf("saved: %.3f mAh/h (%.0f%%)\n", mah[0] - mah[1], 100.0 * (mah[0] - mah[1]) / mah[0]);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  unsigned days = 3;
+  std::string scenarioText = Sim::kDefaultScenario;
+  std::string scenarioName = "default";
+  double capacity = BAT_CAPACITY_MAH;
+  int onlyOff = -1, onlyDim = -1, onlyBright = -1;
+  bool stableHour = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasArg = i + 1 < argc;
+    if (a == "--days" && hasArg) {
+      days = (unsigned)atoi(argv[++i]);
+    } else if (a == "--scenario" && hasArg) {
+      std::ifstream f(argv[++i]);
+      if (!f) {
+        fprintf(stderr, "cannot open %s\n", argv[i]);
+        return 1;
+      }
+      std::stringstream ss;
+      ss << f.rdbuf();
+      scenarioText = ss.str();
+      scenarioName = argv[i];
+    } else if (a == "--capacity" && hasArg) {
+      capacity = atof(argv[++i]);
+    } else if (a == "--combo" && hasArg) {
+      if (sscanf(argv[++i], "%d,%d,%d", &onlyOff, &onlyDim, &onlyBright) != 3) {
+        usage();
+        return 1;
+      }
+    } else if (a == "--hive" && hasArg) {
+      int m = atoi(argv[++i]);
+      if (m < 0 || m >= HIVE_INTERVAL_VALUES_COUNT) {
+        usage();
+        return 1;
+      }
+      provHive = (uint8_t)m;
+    } else if (a == "--uplink") {
+      Uplink_SetEnabled(true);   // наследуется загрузками прошивки через fork
+    } else if (a == "--stable-hour") {
+      stableHour = true;
+    } else if (a == "--trace") {
+      Sim::trace = true;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (days == 0 || capacity <= 0.0) {
+    usage();
+    return 1;
+  }
+
+  Sim::init();
+  Sim::shared->batteryCapacityMah = capacity;
+  Sim::shared->batteryStartSoc = SIM_BAT_START_SOC;
+  if (stableHour) return runStableHour();
+
+  Sim::Timeline tl;
+  std::string error;
+  if (!Sim::BuildTimeline(scenarioText, days, &tl, &error)) {
+    fprintf(stderr, "%s: %s\n", scenarioName.c_str(), error.c_str());
+    return 1;
+  }
+
+  printf("Scenario: %s, %u day(s), battery %.0f mAh\n", scenarioName.c_str(), days, capacity);
+  if (provHive > 0) printf("Hive mode: every %lu min\n", hiveIntervalValues[provHive] / 60UL);
+  if (Uplink_Enabled()) printf("Uplink: every %lu min\n", UPLINK_WINDOW_SEC / 60UL);
+  printf("%-8s %-6s %-6s %9s %8s %8s %7s %6s %7s %8s\n",
+         "auto_off", "dim", "bright", "mAh/day", "avg mA", "life d", "boots",
+         "eeprom", "frames", "end SoC");
+
+  bool anyCrash = false;
+  for (int off = 0; off < AUTO_OFF_VALUES_COUNT; off++) {
+    if (onlyOff >= 0 && off != onlyOff) continue;
+    for (int dim = 0; dim < AUTO_DIM_VALUES_COUNT; dim++) {
+      if (onlyDim >= 0 && dim != onlyDim) continue;
+      for (int bright = 0; bright < 3; bright++) {
+        if (onlyBright >= 0 && bright != onlyBright) continue;
+        provOff = (uint8_t)off;
+        provDim = (uint8_t)dim;
+        provBright = (uint8_t)bright;
+
+        RunResult r = runCombo(tl, (uint64_t)days * US_PER_DAY);
+        double perDay = r.mah / days;
+        double avgMa = r.mah / (days * 24.0);
+        char offStr[24];
+        if (autoOffValues[off] == 0) snprintf(offStr, sizeof(offStr), "never");
+        else snprintf(offStr, sizeof(offStr), "%lus", autoOffValues[off] / 1000UL);
+        printf("%-8s %-6lu %-6d %9.2f %8.3f %8.1f %7u %6u %7u %7.0f%%%s\n",
+               offStr, autoDimValues[dim] / 1000UL, bright,
+               perDay, avgMa, capacity / perDay, r.boots, r.commits, r.frames,
+               r.endSoc * 100.0, r.crashed ? "  CRASH" : r.i2cWrongClock ? "  I2C@160" : "");
+        anyCrash |= r.crashed || r.i2cWrongClock > 0;
+
+        // Для одиночного прогона — разбивка по потребителям и состояниям CPU
+        if (onlyOff >= 0 && onlyDim >= 0 && onlyBright >= 0) {
+          static const char* const consumers[] = { "cpu", "hx711", "oled", "flash", "board", "radio" };
+          static const char* const states[] = { "active", "idle", "light sleep", "deep sleep" };
+          printf("\n  charge by consumer, mAh/day:\n");
+          for (int i = 0; i < Sim::C_COUNT; i++) {
+            printf("    %-12s %9.3f\n", consumers[i], r.chargeMah[i] / days);
+          }
+          printf("  time by CPU state, h/day:\n");
+          for (int i = 0; i < Sim::CPU_STATE_COUNT; i++) {
+            printf("    %-12s %9.3f\n", states[i], r.stateUs[i] / 3600e6 / days);
+          }
+          printf("    %-12s %9.3f\n", "of which 160", r.boostUs / 3600e6 / days);
+          if (r.timerWakes) {
+            printf("  hive wakes: %u, avg awake %.0f ms\n",
+                   r.timerWakes, r.timerAwakeUs / 1000.0 / r.timerWakes);
+          }
+          if (r.uplinkPosts) {
+            printf("  uplink: %u posts, %u records, radio %.1f s/day, %.1f ms/record\n",
+                   r.uplinkPosts, r.uplinkRecords, r.radioUs / 1e6 / days,
+                   r.uplinkRecords ? r.radioUs / 1000.0 / r.uplinkRecords : 0.0);
+          }
+          if (r.i2cWrongClock) printf("  I2C frames sent at boosted clock: %u\n", r.i2cWrongClock);
+        }
+      }
+    }
+  }
+  return anyCrash ? 2 : 0;
+}
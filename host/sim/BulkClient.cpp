@@ -0,0 +1,75 @@
+#include "BulkClient.h"
+#include "SampleCodec.h"
+#include <string.h>
+
+namespace BulkHost {
+
+static std::vector<uint8_t> frame(uint8_t type, const void* body, size_t len) {
+  std::vector<uint8_t> wire(BULK_WIRE_MAX + 1);
+  wire[0] = 0;
+  wire.resize(Bulk_EncodeFrame(type, body, len, wire.data() + 1) + 1);
+  return wire;
+}
+
+Client::Client(uint32_t from) : next(from) {
+  Bulk_InitDecoder(&rx_);
+}
+
+std::vector<uint8_t> Client::readRequest(uint16_t maxBlocks) const {
+  BulkRead req = { next, maxBlocks, 0 };
+  return frame(BULK_READ, &req, sizeof(req));
+}
+
+std::vector<uint8_t> Client::byeRequest() {
+  return frame(BULK_BYE, nullptr, 0);
+}
+
+bool Client::finished() const {
+  return clean_ && helloSeen && next >= hello.end;
+}
+
+void Client::feed(const uint8_t* data, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    uint8_t type;
+    const uint8_t* body;
+    size_t len;
+    if (!Bulk_FeedByte(&rx_, data[i], &type, &body, &len)) {
+      if (rx_.error) {
+        badFrames++;
+        dirty_ = true;
+      }
+      continue;
+    }
+
+    if (type == BULK_HELLO && len == sizeof(BulkHello)) {
+      memcpy(&hello, body, sizeof(hello));
+      helloSeen = true;
+      // Продолжение с позиции, которую кольцо уже перезаписало
+      if (next != 0 && next < hello.first) lost += hello.first - next;
+      if (next < hello.first) next = hello.first;
+    } else if (type == BULK_DATA && len == 4 + HISTORY_BLOCK_SIZE) {
+      uint32_t pos;
+      memcpy(&pos, body, 4);
+      if (dirty_ || pos < next) continue;     // после сбоя — повтор с next
+      lost += pos - next;
+      next = pos + 1;
+      blocks++;
+
+      CodecDecoder d;
+      LogRecord rec;
+      if (!Codec_Open(&d, body + 4, HISTORY_BLOCK_SIZE)) {
+        badBlocks++;
+        continue;
+      }
+      while (Codec_Next(&d, &rec)) records.push_back(rec);
+    } else if (type == BULK_END && len == 4) {
+      memcpy(&lastEnd, body, 4);
+      if (!dirty_ && lastEnd > next) next = lastEnd;
+      clean_ = !dirty_;
+      dirty_ = false;
+      roundDone = true;
+    }
+  }
+}
+
+} // namespace BulkHost
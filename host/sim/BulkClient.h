@@ -0,0 +1,39 @@
+#pragma once
+
+// Хостовая сторона двоичной выгрузки архива (Mini_Scale/BulkExport.h):
+// разбор кадров устройства, распаковка блоков, продолжение с позиции.
+// Транспорт — забота вызывающего (порт в bulk_reader, петля в тестах).
+
+#include "BulkExport.h"
+#include "RtcLog.h"
+#include <stdint.h>
+#include <vector>
+
+namespace BulkHost {
+
+struct Client {
+  explicit Client(uint32_t from = 0);
+
+  std::vector<uint8_t> readRequest(uint16_t maxBlocks) const;   // READ с next
+  static std::vector<uint8_t> byeRequest();
+  void feed(const uint8_t* data, size_t n);                     // Байты от устройства
+  bool finished() const;   // Последний раунд без ошибок дошёл до конца архива
+
+  bool      helloSeen = false;
+  BulkHello hello = {};
+  uint32_t  next;               // Позиция продолжения
+  bool      roundDone = false;  // Получен END (сбрасывает вызывающий перед READ)
+  uint32_t  lastEnd = 0;        // Позиция из последнего END
+  uint32_t  blocks = 0;         // Принято блоков
+  uint32_t  badFrames = 0;      // Кадров с ошибкой COBS/CRC
+  uint32_t  badBlocks = 0;      // Блоков с ошибкой CRC во flash устройства
+  uint32_t  lost = 0;           // Блоков, вытесненных из кольца до выгрузки
+  std::vector<LogRecord> records;
+
+private:
+  BulkFrameDecoder rx_;
+  bool dirty_ = false;          // В раунде был битый кадр — дальше только с next
+  bool clean_ = false;          // Последний раунд завершён без ошибок
+};
+
+} // namespace BulkHost
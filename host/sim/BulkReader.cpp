@@ -0,0 +1,188 @@
+// Чтение архива весов по двоичному протоколу выгрузки (команда 'x').
+//
+//   bulk_reader <порт> [--out файл.csv] [--resume файл] [--chunk N]
+//
+// CSV — в том же формате, что выгрузка 'h'. С --resume позиция продолжения
+// читается из файла и записывается обратно: следующий запуск выгрузит только
+// новые блоки, оборванный — продолжит с последнего принятого.
+
+#include "BulkClient.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+
+static speed_t speedFor(uint32_t baud) {
+  switch (baud) {
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default:     return 0;
+  }
+}
+
+static bool setBaud(int fd, uint32_t baud) {
+  speed_t s = speedFor(baud);
+  termios t;
+  if (s == 0 || tcgetattr(fd, &t) != 0) return false;
+  cfmakeraw(&t);
+  t.c_cflag |= CLOCAL | CREAD;
+  cfsetispeed(&t, s);
+  cfsetospeed(&t, s);
+  return tcsetattr(fd, TCSADRAIN, &t) == 0;
+}
+
+static uint64_t nowMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static bool sendAll(int fd, const std::vector<uint8_t>& data) {
+  size_t off = 0;
+  while (off < data.size()) {
+    ssize_t n = write(fd, data.data() + off, data.size() - off);
+    if (n < 0 && errno != EINTR) return false;
+    if (n > 0) off += n;
+  }
+  return true;
+}
+
+// Читать порт в клиент, пока done() не станет true или не выйдет таймаут
+template <typename Done>
+static bool pump(int fd, BulkHost::Client* client, unsigned timeoutMs, Done done) {
+  uint64_t deadline = nowMs() + timeoutMs;
+  uint8_t buf[512];
+  while (!done()) {
+    uint64_t now = nowMs();
+    if (now >= deadline) return false;
+    pollfd p = { fd, POLLIN, 0 };
+    if (poll(&p, 1, (int)(deadline - now)) <= 0) continue;
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n > 0) {
+      client->feed(buf, n);
+      deadline = nowMs() + timeoutMs;   // таймаут — на тишину, не на весь раунд
+    }
+  }
+  return true;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: bulk_reader <port> [--out file.csv] [--resume file] [--chunk N]\n");
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    usage();
+    return 1;
+  }
+  const char* port = argv[1];
+  std::string outPath, resumePath;
+  unsigned chunk = 64;
+  for (int i = 2; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasArg = i + 1 < argc;
+    if (a == "--out" && hasArg) outPath = argv[++i];
+    else if (a == "--resume" && hasArg) resumePath = argv[++i];
+    else if (a == "--chunk" && hasArg) chunk = (unsigned)atoi(argv[++i]);
+    else {
+      usage();
+      return 1;
+    }
+  }
+  if (chunk == 0 || chunk > 0xFFFF) chunk = 64;
+
+  uint32_t from = 0;
+  if (!resumePath.empty()) {
+    FILE* f = fopen(resumePath.c_str(), "r");
+    if (f) {
+      unsigned long v;
+      if (fscanf(f, "%lu", &v) == 1) from = (uint32_t)v;
+      fclose(f);
+    }
+  }
+
+  int fd = open(port, O_RDWR | O_NOCTTY);
+  if (fd < 0 || !setBaud(fd, SERIAL_BAUD)) {
+    fprintf(stderr, "cannot open %s: %s\n", port, strerror(errno));
+    return 1;
+  }
+  tcflush(fd, TCIOFLUSH);
+
+  BulkHost::Client client(from);
+  sendAll(fd, std::vector<uint8_t>{ 'x', '\n' });
+  if (!pump(fd, &client, 2000, [&] { return client.helloSeen; })) {
+    fprintf(stderr, "no HELLO from device\n");
+    return 2;
+  }
+  if (client.hello.version != BULK_PROTOCOL_VERSION ||
+      client.hello.blockSize != HISTORY_BLOCK_SIZE) {
+    fprintf(stderr, "protocol %u / block %u not supported\n",
+            client.hello.version, client.hello.blockSize);
+    return 2;
+  }
+  usleep(20000);   // устройство переключает скорость после HELLO
+  if (!setBaud(fd, client.hello.baud)) {
+    fprintf(stderr, "baud %u not supported\n", client.hello.baud);
+    return 2;
+  }
+  fprintf(stderr, "blocks %u..%u from %u, %u baud\n", client.hello.first,
+          client.hello.end, client.next, client.hello.baud);
+
+  unsigned retries = 0;
+  uint64_t started = nowMs();
+  while (!client.finished()) {
+    client.roundDone = false;
+    sendAll(fd, client.readRequest((uint16_t)chunk));
+    if (!pump(fd, &client, 500, [&] { return client.roundDone; })) {
+      if (++retries > 5) {
+        fprintf(stderr, "device stopped answering at block %u\n", client.next);
+        break;
+      }
+      continue;
+    }
+    retries = 0;
+    fprintf(stderr, "\r%u blocks, %zu records", client.blocks, client.records.size());
+  }
+  sendAll(fd, BulkHost::Client::byeRequest());
+  tcdrain(fd);
+  close(fd);
+
+  double sec = (nowMs() - started) / 1000.0;
+  fprintf(stderr, "\n%u blocks (%u bad frames, %u bad blocks, %u lost) in %.1f s, %.0f B/s\n",
+          client.blocks, client.badFrames, client.badBlocks, client.lost, sec,
+          sec > 0 ? client.blocks * (double)HISTORY_BLOCK_SIZE / sec : 0.0);
+
+  FILE* out = outPath.empty() ? stdout : fopen(outPath.c_str(), "w");
+  if (!out) {
+    fprintf(stderr, "cannot write %s\n", outPath.c_str());
+    return 1;
+  }
+  fprintf(out, "ts,weight_kg,battery,flags\n");
+  for (const LogRecord& r : client.records) {
+    if (r.flags & LOG_FLAG_ERROR) {
+      fprintf(out, "%lu,,%u,%u\n", (unsigned long)r.ts, r.battery, r.flags);
+    } else {
+      fprintf(out, "%lu,%.3f,%u,%u\n", (unsigned long)r.ts, r.weight_g / 1000.0f, r.battery,
+              r.flags);
+    }
+  }
+  if (out != stdout) fclose(out);
+
+  if (!resumePath.empty()) {
+    FILE* f = fopen(resumePath.c_str(), "w");
+    if (f) {
+      fprintf(f, "%lu\n", (unsigned long)client.next);
+      fclose(f);
+    }
+  }
+  return client.finished() ? 0 : 3;
+}
@@ -0,0 +1,139 @@
+// Степень сжатия архива (SampleCodec) на рядах измерений: выгрузки 'h'
+// с устройства (CSV: ts,weight_kg,battery,flags) или, без аргументов, на
+// модельных рядах улья — поминутном и с интервалом режима улья.
+//
+//   codec_bench [export.csv ...]
+//
+// Каждый ряд пакуется в блоки HISTORY_BLOCK_SIZE двумя способами: пачками
+// RtcLog (как пишет режим улья) и потоком до заполнения блока. Все блоки
+// декодируются обратно и сверяются с исходными записями.
+
+#include "RtcLog.h"
+#include "SampleCodec.h"
+#include "HistoryStore.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef std::vector<LogRecord> Trace;
+
+static bool loadCsv(const char* path, Trace* out) {
+  std::ifstream f(path);
+  if (!f) return false;
+  std::string line;
+  while (std::getline(f, line)) {
+    if (line.empty() || line[0] == '#' || line[0] == 't') continue;
+    unsigned long ts;
+    unsigned battery, flags;
+    char weight[32] = "";
+    if (sscanf(line.c_str(), "%lu,%31[^,],%u,%u", &ts, weight, &battery, &flags) == 4) {
+      out->push_back(RtcLog_MakeRecord(ts, (float)atof(weight), battery, flags));
+    } else if (sscanf(line.c_str(), "%lu,,%u,%u", &ts, &battery, &flags) == 3) {
+      out->push_back(RtcLog_MakeRecord(ts, WEIGHT_ERROR_FLAG, battery, flags | LOG_FLAG_ERROR));
+    }
+  }
+  return true;
+}
+
+// Модель нуклеуса: привес от взятка, дневной уход лётных пчёл, шум HX711
+static uint64_t rng = 0x9E3779B97F4A7C15ULL;
+static double gaussian() {
+  auto uniform = []() {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return ((rng >> 11) + 0.5) / 9007199254740992.0;
+  };
+  return sqrt(-2.0 * log(uniform())) * cos(6.283185307179586 * uniform());
+}
+
+static Trace modelTrace(uint32_t days, uint32_t periodSec) {
+  Trace t;
+  for (uint32_t ts = 0; ts < days * 86400; ts += periodSec) {
+    double day = ts / 86400.0;
+    double hour = fmod(ts / 3600.0, 24.0);
+    double kg = 3.80 + 0.030 * day;
+    if (hour > 9.0 && hour < 17.0) kg -= 0.040 * sin((hour - 9.0) / 8.0 * 3.14159);
+    kg += gaussian() * 0.002;
+    int battery = 100 - (int)(day * 0.8);
+    t.push_back(RtcLog_MakeRecord(ts, (float)kg, battery, 0));
+  }
+  return t;
+}
+
+// Упаковать ряд в блоки: пачками по batch записей; 0 — поток без пачек
+static bool pack(const Trace& t, size_t batch, uint32_t* blocks, uint32_t* payload) {
+  uint8_t block[HISTORY_BLOCK_SIZE];
+  size_t i = 0;
+  *blocks = 0;
+  *payload = 0;
+  while (i < t.size()) {
+    size_t end = batch ? std::min(t.size(), (i / batch + 1) * batch) : t.size();
+    CodecEncoder e;
+    Codec_Begin(&e, block, sizeof(block));
+    size_t first = i;
+    while (i < end && Codec_Append(&e, t[i])) i++;
+    size_t used = Codec_Finish(&e);
+    if (used == 0) return false;
+
+    CodecDecoder d;
+    LogRecord rec;
+    if (!Codec_Open(&d, block, used)) return false;
+    for (size_t k = first; k < i; k++) {
+      if (!Codec_Next(&d, &rec) || memcmp(&rec, &t[k], sizeof(rec)) != 0) return false;
+    }
+    (*blocks)++;
+    *payload += used;
+  }
+  return true;
+}
+
+static bool report(const char* name, const Trace& t) {
+  if (t.empty()) {
+    printf("%-26s empty\n", name);
+    return true;
+  }
+  const double perSegment = FLASH_RING_PER_SEGMENT(HISTORY_BLOCK_SIZE);
+  const double raw = 8.0 * t.size();
+  for (int streamed = 0; streamed < 2; streamed++) {
+    uint32_t blocks, payload;
+    if (!pack(t, streamed ? 0 : RTCLOG_CAPACITY, &blocks, &payload)) {
+      printf("%-26s ROUND-TRIP MISMATCH\n", name);
+      return false;
+    }
+    double flash = blocks / perSegment * FLASH_RING_SECTOR_SIZE;   // с заголовками сегментов
+    printf("%-26s %-7s %8zu %9.0f %9u %9.0f %6.2f %6.2fx %6.2fx\n",
+           streamed ? "" : name, streamed ? "stream" : "batch", t.size(), raw,
+           payload, flash, flash / t.size(), raw / payload, raw / flash);
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  printf("block %u B, %u blocks per segment, batch %u records\n",
+         (unsigned)HISTORY_BLOCK_SIZE, (unsigned)FLASH_RING_PER_SEGMENT(HISTORY_BLOCK_SIZE),
+         (unsigned)RTCLOG_CAPACITY);
+  printf("%-26s %-7s %8s %9s %9s %9s %6s %7s %7s\n", "trace", "packing", "records",
+         "raw B", "coded B", "flash B", "B/rec", "coded", "flash");
+
+  bool ok = true;
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      Trace t;
+      if (!loadCsv(argv[i], &t)) {
+        fprintf(stderr, "cannot open %s\n", argv[i]);
+        return 1;
+      }
+      ok &= report(argv[i], t);
+    }
+  } else {
+    ok &= report("model 30 d, 1 min", modelTrace(30, 60));
+    ok &= report("model 90 d, 15 min", modelTrace(90, 900));
+  }
+  return ok ? 0 : 2;
+}
@@ -0,0 +1,3 @@
+// Скетч собирается как обычный C++: Arduino IDE добавляет этот include сама.
+#include <Arduino.h>
+#include "Mini_Scale.ino"
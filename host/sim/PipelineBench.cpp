@@ -0,0 +1,204 @@
+// Цепочка фильтров веса (ScalePipeline) на модельном АЦП: по channels
+// независимых каналов на каждый набор окон, отсчёты — через ScaleAdc.
+//
+//   pipeline_bench [channels] [samples]
+//
+// Модель канала — как HX711 симулятора (PowerModel.h): шум SIM_HX711_NOISE_COUNTS,
+// редкие одиночные выбросы, ступень нагрузки в середине ряда. На каждый набор
+// окон: время на отсчёт, СКО веса до и после фильтров на ровном участке,
+// число отсчётов от ступени до стабильности.
+//
+// Вторая таблица — профили применения (Profiles.h) целиком: отсчёт — среднее
+// samplesPerRead конверсий при 10 SPS, в непрерывном опросе шаг loop() —
+// конверсии плюс loopDelayMs. Время до стабильности — в мс устройства,
+// «flicker» — смен показания на дисплее в минуту на ровном участке.
+
+#include "ScaleAdc.h"
+#include "ScalePipeline.h"
+#include "PowerModel.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+// Модельный АЦП: конверсия готова всегда, вес задаёт бенчмарк
+class ModelAdc : public ScaleAdc {
+public:
+  explicit ModelAdc(uint64_t seed) : rng(seed * 2 + 1) {}
+  float kg = 0.0f;
+
+  void begin() override {}
+  bool isReady() override { return true; }
+  bool waitReady(unsigned long) override { return true; }
+  void powerDown() override {}
+  void powerUp() override {}
+  long read() override {
+    double v = SIM_HX711_ZERO_COUNTS + kg * SIM_HX711_COUNTS_PER_KG +
+               gaussian() * SIM_HX711_NOISE_COUNTS;
+    if (next() % 2000 == 0) v += 500.0;  // одиночный выброс АЦП, ~0.2 кг
+    return lround(v);
+  }
+
+private:
+  uint64_t rng;
+  uint64_t next() {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+  }
+  double gaussian() {
+    double u1 = ((next() >> 11) + 0.5) / 9007199254740992.0;
+    double u2 = ((next() >> 11) + 0.5) / 9007199254740992.0;
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+  }
+};
+
+static float toKg(double counts) {
+  return (float)((counts - SIM_HX711_ZERO_COUNTS) / SIM_HX711_COUNTS_PER_KG);
+}
+
+struct Moments {
+  double sum = 0.0, sum2 = 0.0;
+  uint32_t n = 0;
+  void add(double v) { sum += v; sum2 += v * v; n++; }
+  double var() const { return n > 1 ? (sum2 - sum * sum / n) / (n - 1) : 0.0; }
+};
+
+// СКО внутри каналов: смещение от выбросов у каждого своё и в шум не входит
+struct Pooled {
+  double var = 0.0;
+  uint32_t k = 0;
+  void add(const Moments& m) { var += m.var(); k++; }
+  double sd() const { return k ? sqrt(var / k) : 0.0; }
+};
+
+template <uint8_t MedianN, uint8_t StabilityN, typename Sample>
+static void run(const char* name, uint32_t channels, uint32_t samples) {
+  typedef ScalePipeline<MedianN, StabilityN, Sample> Pipeline;
+  std::vector<Pipeline> pipes(channels);
+  std::vector<ModelAdc> adcs;
+  for (uint32_t c = 0; c < channels; c++) adcs.emplace_back(0x9E3779B97F4A7C15ULL + c);
+
+  // Отсчёты заранее: время — только фильтров
+  std::vector<float> raw((size_t)channels * samples);
+  const uint32_t step = samples / 2;
+  for (uint32_t c = 0; c < channels; c++) {
+    adcs[c].kg = 1.0f + 0.1f * c;
+    for (uint32_t i = 0; i < samples; i++) {
+      if (i == step) adcs[c].kg += 0.5f;
+      raw[(size_t)c * samples + i] = toKg(adcs[c].read());
+    }
+  }
+
+  Pooled in, out;
+  uint64_t settled = 0;
+  uint32_t unsettled = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t c = 0; c < channels; c++) {
+    Pipeline& p = pipes[c];
+    const float* r = &raw[(size_t)c * samples];
+    uint32_t stableAt = 0;
+    double base = 1.0 + 0.1 * c;
+    Moments mi, mo;
+    for (uint32_t i = 0; i < samples; i++) {
+      p.push(r[i]);
+      // Ровный участок до ступени, без разгона фильтров
+      if (i >= 4 * StabilityN && i < step) {
+        mi.add(r[i] - base);
+        mo.add(p.filtered() - base);
+      }
+      if (i >= step && stableAt == 0 && p.isStable() && fabs(p.filtered() - base - 0.5) < 0.01) {
+        stableAt = i - step + 1;
+      }
+    }
+    in.add(mi);
+    out.add(mo);
+    if (stableAt) settled += stableAt;
+    else unsettled++;
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+  uint32_t ok = channels - unsettled;
+  printf("%-22s %8u %9.1f %9.2f %9.2f %9.1f %6u\n", name, channels,
+         ns / ((double)channels * samples), in.sd() * 1000.0, out.sd() * 1000.0,
+         ok ? (double)settled / ok : 0.0, unsettled);
+}
+
+template <typename Profile>
+static void runProfile(uint32_t channels, uint32_t samples) {
+  typedef ProfilePipeline<Profile> Pipeline;
+  const double periodMs = Profile::samplesPerRead * 100.0 + Profile::loopDelayMs;
+  const uint32_t step = samples / 2;
+  Pooled out;
+  uint64_t settled = 0, changes = 0, flat = 0;
+  uint32_t unsettled = 0;
+  double ns = 0.0;
+  for (uint32_t c = 0; c < channels; c++) {
+    ModelAdc adc(0x9E3779B97F4A7C15ULL + c);
+    std::vector<float> raw(samples);
+    adc.kg = 1.0f + 0.1f * c;
+    for (uint32_t i = 0; i < samples; i++) {
+      if (i == step) adc.kg += 0.5f;
+      long sum = 0;
+      for (uint8_t k = 0; k < Profile::samplesPerRead; k++) sum += adc.read();
+      raw[i] = toKg((double)sum / Profile::samplesPerRead);
+    }
+
+    Pipeline p;
+    double base = 1.0 + 0.1 * c;
+    float shown = 0.0f;
+    uint32_t stableAt = 0;
+    Moments mo;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < samples; i++) {
+      p.push(raw[i]);
+      if (i >= 4 * Profile::stabilityWindow && i < step) {
+        mo.add(p.filtered() - base);
+        if (p.displayWeight() != shown) changes++;
+        flat++;
+      }
+      shown = p.displayWeight();
+      if (i >= step && stableAt == 0 && p.isStable() &&
+          fabs(p.filtered() - base - 0.5) < Profile::stabilityThreshold) {
+        stableAt = i - step + 1;
+      }
+    }
+    ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    out.add(mo);
+    if (stableAt) settled += stableAt;
+    else unsettled++;
+  }
+
+  uint32_t ok = channels - unsettled;
+  printf("%-10s %4u/%-3u %6.0f %9.1f %9.3f %9.0f %9.1f %6u\n", Profile::name,
+         Profile::medianWindow, Profile::stabilityWindow, periodMs,
+         ns / ((double)channels * samples), out.sd() * 1000.0,
+         ok ? (double)settled / ok * periodMs : 0.0,
+         flat ? changes * 60000.0 / (flat * periodMs) : 0.0, unsettled);
+}
+
+int main(int argc, char** argv) {
+  uint32_t channels = argc > 1 ? (uint32_t)atoi(argv[1]) : 64;
+  uint32_t samples = argc > 2 ? (uint32_t)atoi(argv[2]) : 20000;
+  if (channels == 0 || samples < 200) {
+    fprintf(stderr, "usage: pipeline_bench [channels] [samples >= 200]\n");
+    return 1;
+  }
+  printf("%u samples per channel, step +0.5 kg at %u\n", samples, samples / 2);
+  printf("%-22s %8s %9s %9s %9s %9s %6s\n", "windows", "channels", "ns/sample",
+         "raw g", "filter g", "settle", "never");
+  run<3, 8, float>("median 3, stab 8", channels, samples);
+  run<3, 6, float>("median 3, stab 6", channels, samples);
+  run<5, 16, float>("median 5, stab 16", channels, samples);
+  run<5, 16, double>("median 5, stab 16, dbl", channels, samples);
+
+  printf("\n%-10s %8s %6s %9s %9s %9s %9s %6s\n", "profile", "windows", "ms/upd",
+         "ns/sample", "filter g", "settle ms", "flicker", "never");
+  runProfile<HiveProfile>(channels, samples);
+  runProfile<KitchenProfile>(channels, samples);
+  runProfile<LabProfile>(channels, samples);
+  return 0;
+}
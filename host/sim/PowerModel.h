@@ -0,0 +1,47 @@
+#pragma once
+
+// Модель потребления платы для симулятора (мА, мкс).
+// Значения — типовые для Wemos D1 mini + HX711 + SSD1306 128x64; подстроить по замерам.
+
+// ===== ESP8266 =====
+#define SIM_MA_CPU_ACTIVE_80    17.0    // CPU занят, радио выключено (modem sleep), 80 МГц
+#define SIM_MA_CPU_ACTIVE_160   24.0    // то же на 160 МГц
+#define SIM_MA_CPU_IDLE         15.0    // delay(): CPU тактируется, modem sleep
+#define SIM_MA_LIGHT_SLEEP      0.9     // forced light sleep
+#define SIM_MA_DEEP_SLEEP       0.02    // deep sleep (только RTC)
+#define SIM_MA_BOARD            0.1     // LDO, делитель батареи — всегда
+
+// ===== Периферия =====
+#define SIM_MA_HX711            1.5     // HX711 в работе
+#define SIM_MA_BRIDGE           2.6     // возбуждение моста 1 кОм от AVDD
+#define SIM_MA_OLED_BASE        0.6     // SSD1306 включён, контраст 0
+#define SIM_MA_OLED_CONTRAST    11.0    // добавка при контрасте 0xFF (~30% пикселей)
+#define SIM_MA_OLED_OFF         0.01    // DISPLAYOFF
+#define SIM_MA_FLASH_WRITE      15.0    // стирание/запись сектора SPI flash
+
+#define SIM_MA_RADIO            56.0    // добавка радио WiFi (STA, приём/передача), к току CPU
+
+// В deep sleep выводы ESP8266 отпущены: считаем, что мост HX711 не запитан
+#define SIM_HX711_OFF_IN_DEEP_SLEEP 1
+
+// ===== Длительности операций =====
+#define SIM_LOOP_US             300     // вычисления одной итерации loop() вне заглушек
+#define SIM_RENDER_US           1500    // отрисовка кадра в буфер (Adafruit GFX)
+#define SIM_I2C_FRAME_US        23000   // 1024 байта кадра на 400 кГц
+#define SIM_FLASH_COMMIT_US     45000   // EEPROM.commit(): стирание + запись 4 КБ
+#define SIM_BOOT_US             120000  // ROM-загрузчик и старт ядра до setup()
+#define SIM_WIFI_CONNECT_US     1500000 // ассоциация с точкой доступа + DHCP
+#define SIM_TCP_CONNECT_US      20000   // TCP-рукопожатие с сервером в локальной сети
+#define SIM_HTTP_RTT_US         40000   // от конца запроса до строки статуса ответа
+#define SIM_WIFI_US_PER_BYTE    10      // передача ~0,8 Мбит/с с учётом подтверждений
+
+// ===== HX711 =====
+#define SIM_HX711_PERIOD_US     100000  // 10 SPS (RATE = 0)
+#define SIM_HX711_SETTLE_US     400000  // установление после power_up
+#define SIM_HX711_SHIFT_US      60      // чтение 24 бит + 1 импульс усиления
+#define SIM_HX711_ZERO_COUNTS   84000L  // показание без нагрузки
+#define SIM_HX711_COUNTS_PER_KG 2280.0  // совпадает с DEFAULT_CALIBRATION
+#define SIM_HX711_NOISE_COUNTS  4.0     // СКО шума АЦП
+
+// ===== Батарея =====
+#define SIM_BAT_START_SOC       0.90    // заряд на старте прогона
@@ -0,0 +1,134 @@
+#include "Scenario.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdio.h>
+
+namespace Sim {
+
+static const uint64_t US_PER_S   = 1000000ULL;
+static const uint64_t US_PER_DAY = 86400ULL * US_PER_S;
+
+const char* kDefaultScenario =
+  "# Улей: утром включили, посмотрели вес, ушли; вечером — тарирование новой рамки\n"
+  "00:00:00 load 2.40\n"
+  "08:00:00 power\n"
+  "08:00:20 press 400\n"
+  "08:01:00 load 2.55\n"
+  "19:30:00 power\n"
+  "19:30:30 load 0.00\n"
+  "19:30:40 press 11000\n"
+  "19:31:30 load 2.60\n"
+  "19:32:00 press 300\n";
+
+// Разбор HH:MM[:SS] в микросекунды от начала суток
+static bool parseClock(const std::string& s, uint64_t* us) {
+  unsigned h = 0, m = 0, sec = 0;
+  int n = sscanf(s.c_str(), "%u:%u:%u", &h, &m, &sec);
+  if (n < 2 || h > 23 || m > 59 || sec > 59) return false;
+  *us = ((uint64_t)h * 3600 + m * 60 + sec) * US_PER_S;
+  return true;
+}
+
+bool BuildTimeline(const std::string& text, unsigned days, Timeline* out, std::string* error) {
+  struct Event {
+    uint64_t atUs;
+    int      kind;   // 0 = load, 1 = press, 2 = power
+    double   arg;
+  };
+  std::vector<Event> events;
+
+  std::istringstream in(text);
+  std::string line;
+  unsigned lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    size_t hash = line.find('#');
+    if (hash != std::string::npos) line.erase(hash);
+    std::istringstream ls(line);
+    std::string when, cmd;
+    if (!(ls >> when)) continue;
+
+    int onlyDay = -1;
+    if (when[0] == 'd') {
+      onlyDay = atoi(when.c_str() + 1);
+      if (!(ls >> when)) {
+        *error = "line " + std::to_string(lineNo) + ": time expected";
+        return false;
+      }
+    }
+    uint64_t clockUs;
+    if (!parseClock(when, &clockUs) || !(ls >> cmd)) {
+      *error = "line " + std::to_string(lineNo) + ": bad time or command";
+      return false;
+    }
+
+    int kind;
+    double arg = 0.0;
+    if (cmd == "load")       kind = 0;
+    else if (cmd == "press") kind = 1;
+    else if (cmd == "power") kind = 2;
+    else {
+      *error = "line " + std::to_string(lineNo) + ": unknown command '" + cmd + "'";
+      return false;
+    }
+    if (kind != 2 && !(ls >> arg)) {
+      *error = "line " + std::to_string(lineNo) + ": argument expected";
+      return false;
+    }
+
+    for (unsigned d = 0; d < days; d++) {
+      if (onlyDay >= 0 && (unsigned)onlyDay != d) continue;
+      events.push_back({ d * US_PER_DAY + clockUs, kind, arg });
+    }
+  }
+
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event& a, const Event& b) { return a.atUs < b.atUs; });
+
+  out->loads.clear();
+  out->presses.clear();
+  out->powers.clear();
+  for (const Event& e : events) {
+    if (e.kind == 0) {
+      out->loads.push_back({ e.atUs, (float)e.arg });
+    } else if (e.kind == 1) {
+      uint64_t start = e.atUs;
+      if (!out->presses.empty() && start < out->presses.back().endUs) {
+        start = out->presses.back().endUs + 50000;   // не склеивать нажатия
+      }
+      out->presses.push_back({ start, start + (uint64_t)(e.arg * 1000.0) });
+    } else {
+      out->powers.push_back(e.atUs);
+    }
+  }
+  return true;
+}
+
+float Timeline::loadAt(uint64_t t) const {
+  auto it = std::upper_bound(loads.begin(), loads.end(), t,
+                             [](uint64_t v, const LoadStep& s) { return v < s.atUs; });
+  if (it == loads.begin()) return 0.0f;
+  return (it - 1)->kg;
+}
+
+bool Timeline::pressedAt(uint64_t t) const {
+  auto it = std::upper_bound(presses.begin(), presses.end(), t,
+                             [](uint64_t v, const Press& p) { return v < p.startUs; });
+  if (it == presses.begin()) return false;
+  return t < (it - 1)->endUs;
+}
+
+uint64_t Timeline::nextPressAfter(uint64_t t) const {
+  if (pressedAt(t)) return t;
+  auto it = std::upper_bound(presses.begin(), presses.end(), t,
+                             [](uint64_t v, const Press& p) { return v < p.startUs; });
+  return it == presses.end() ? UINT64_MAX : it->startUs;
+}
+
+uint64_t Timeline::nextPowerAfter(uint64_t t) const {
+  auto it = std::upper_bound(powers.begin(), powers.end(), t);
+  return it == powers.end() ? UINT64_MAX : *it;
+}
+
+} // namespace Sim
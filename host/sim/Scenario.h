@@ -0,0 +1,48 @@
+#pragma once
+
+// Сценарий симуляции: нагрузка на платформе, нажатия кнопки, включения питания.
+//
+// Формат (по строке на событие, '#' — комментарий):
+//   <когда> <команда> [аргумент]
+//   когда:   HH:MM[:SS]       — каждый день
+//            dN HH:MM[:SS]    — только в день N (0 — первый)
+//   команды: load <кг>        — вес на платформе с этого момента
+//            press <мс>       — нажатие кнопки D3 заданной длительности
+//            power            — кнопка RST / включение питания (будит из deepSleep(0))
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Sim {
+
+struct LoadStep {
+  uint64_t atUs;
+  float    kg;
+};
+
+struct Press {
+  uint64_t startUs;
+  uint64_t endUs;
+};
+
+// Сценарий, развёрнутый на заданное число суток
+struct Timeline {
+  std::vector<LoadStep> loads;   // по возрастанию времени
+  std::vector<Press>    presses; // по возрастанию startUs, без перекрытий
+  std::vector<uint64_t> powers;  // по возрастанию
+
+  float    loadAt(uint64_t t) const;
+  bool     pressedAt(uint64_t t) const;
+  uint64_t nextPressAfter(uint64_t t) const;   // UINT64_MAX — больше нет
+  uint64_t nextPowerAfter(uint64_t t) const;
+};
+
+// Разобрать текст сценария и развернуть на days суток.
+// false + error — синтаксическая ошибка (с номером строки).
+bool BuildTimeline(const std::string& text, unsigned days, Timeline* out, std::string* error);
+
+// Сценарий по умолчанию: улей, утренний и вечерний осмотр
+extern const char* kDefaultScenario;
+
+} // namespace Sim
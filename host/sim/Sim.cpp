@@ -0,0 +1,320 @@
+#include "Sim.h"
+#include "PowerModel.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Точки входа скетча (Mini_Scale.ino)
+void setup();
+void loop();
+
+namespace Sim {
+
+Shared* shared = nullptr;
+bool trace = false;
+
+static const Timeline* timeline = nullptr;
+static CpuState cpuState = CPU_ACTIVE;
+static bool inFirmware = false;     // true — в дочернем процессе прошивки
+static uint64_t nextPowerUs = UINT64_MAX;
+
+// Гауссов шум АЦП — детерминированный генератор, одинаковый для всех прогонов
+static uint64_t rngState = 0x9E3779B97F4A7C15ULL;
+static double uniform() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 7;
+  rngState ^= rngState << 17;
+  return ((rngState >> 11) + 0.5) / 9007199254740992.0;
+}
+static double gaussian() {
+  return sqrt(-2.0 * log(uniform())) * cos(6.283185307179586 * uniform());
+}
+
+void init() {
+  void* mem = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    perror("mmap");
+    exit(1);
+  }
+  shared = (Shared*)mem;
+}
+
+void resetRun(const Timeline* tl, uint64_t endUs) {
+  double capacity = shared->batteryCapacityMah;
+  double soc = shared->batteryStartSoc;
+  memset(shared, 0, offsetof(Shared, eeprom));
+  memset(shared->eeprom, 0xFF, sizeof(shared->eeprom));
+  memset(shared->rtcUser, 0, sizeof(shared->rtcUser));
+  memset(shared->flash, 0xFF, sizeof(shared->flash));
+  shared->endUs = endUs;
+  shared->cpuFreqMHz = 80;
+  shared->oledOn = false;
+  shared->hxPowered = false;
+  shared->batteryCapacityMah = capacity;
+  shared->batteryStartSoc = soc;
+  timeline = tl;
+  rngState = 0x9E3779B97F4A7C15ULL;
+}
+
+void clearStats() {
+  shared->nowUs = 0;
+  shared->millisBiasUs = 0;
+  memset(shared->chargeMaUs, 0, sizeof(shared->chargeMaUs));
+  memset(shared->cpuStateUs, 0, sizeof(shared->cpuStateUs));
+  shared->boots = 0;
+  shared->eepromCommits = 0;
+  shared->flashErases = 0;
+  shared->frames = 0;
+  shared->i2cWrongClock = 0;
+  shared->cpuBoostUs = 0;
+  shared->radioUs = 0;
+  shared->uplinkPosts = 0;
+  shared->uplinkRecords = 0;
+}
+
+// ----- Время и энергия -----
+
+uint64_t nowUs() { return shared->nowUs; }
+void setCpu(CpuState state) { cpuState = state; }
+CpuState cpu() { return cpuState; }
+
+// Ток каждого потребителя в текущем состоянии, мА
+static void currents(double ma[C_COUNT]) {
+  switch (cpuState) {
+    case CPU_ACTIVE:
+      ma[C_CPU] = shared->cpuFreqMHz > 80 ? SIM_MA_CPU_ACTIVE_160 : SIM_MA_CPU_ACTIVE_80;
+      break;
+    case CPU_IDLE:        ma[C_CPU] = SIM_MA_CPU_IDLE;    break;
+    case CPU_LIGHT_SLEEP: ma[C_CPU] = SIM_MA_LIGHT_SLEEP; break;
+    default:              ma[C_CPU] = SIM_MA_DEEP_SLEEP;  break;
+  }
+  bool hxOn = shared->hxPowered &&
+              !(SIM_HX711_OFF_IN_DEEP_SLEEP && cpuState == CPU_DEEP_SLEEP);
+  ma[C_HX711] = hxOn ? SIM_MA_HX711 + SIM_MA_BRIDGE : 0.0;
+  ma[C_OLED] = shared->oledOn
+             ? SIM_MA_OLED_BASE + SIM_MA_OLED_CONTRAST * shared->oledContrast / 255.0
+             : SIM_MA_OLED_OFF;
+  ma[C_FLASH] = 0.0;
+  ma[C_BOARD] = SIM_MA_BOARD;
+  ma[C_RADIO] = shared->radioOn ? SIM_MA_RADIO : 0.0;
+}
+
+static void integrate(uint64_t us) {
+  double ma[C_COUNT];
+  currents(ma);
+  for (int i = 0; i < C_COUNT; i++) shared->chargeMaUs[i] += ma[i] * (double)us;
+  shared->cpuStateUs[cpuState] += us;
+  if (cpuState == CPU_ACTIVE && shared->cpuFreqMHz > 80) shared->cpuBoostUs += us;
+  if (shared->radioOn) shared->radioUs += us;
+  if (cpuState == CPU_ACTIVE || cpuState == CPU_IDLE) {
+    shared->cpuCycles += us * shared->cpuFreqMHz;
+  }
+  shared->nowUs += us;
+}
+
+void advance(uint64_t us) {
+  uint64_t target = shared->nowUs + us;
+  if (inFirmware) {
+    // Нажатие RST во время работы — внешний сброс
+    if (nextPowerUs <= target) {
+      if (nextPowerUs > shared->nowUs) integrate(nextPowerUs - shared->nowUs);
+      shared->resetReason = 6;   // REASON_EXT_SYS_RST
+      throw RestartRequest();
+    }
+    if (target >= shared->endUs) {
+      integrate(shared->endUs - shared->nowUs);
+      throw EndOfRun();
+    }
+  }
+  integrate(us);
+}
+
+void advanceIn(CpuState state, uint64_t us) {
+  CpuState saved = cpuState;
+  cpuState = state;
+  try {
+    advance(us);
+  } catch (...) {
+    cpuState = saved;
+    throw;
+  }
+  cpuState = saved;
+}
+
+void addFlashCharge(uint64_t us) {
+  shared->chargeMaUs[C_FLASH] += SIM_MA_FLASH_WRITE * (double)us;
+}
+
+double totalMah() {
+  double sum = 0.0;
+  for (int i = 0; i < C_COUNT; i++) sum += shared->chargeMaUs[i];
+  return sum / 3600e6;
+}
+
+double socNow() {
+  double soc = shared->batteryStartSoc - totalMah() / shared->batteryCapacityMah;
+  return soc < 0.0 ? 0.0 : soc;
+}
+
+// Напряжение LiPo без нагрузки по степени заряда (обратная к кривой прошивки)
+double batteryVoltage() {
+  static const double socPts[] = { 0.00, 0.05, 0.15, 0.40, 0.70, 0.90, 1.00 };
+  static const double vPts[]   = { 3.20, 3.40, 3.60, 3.73, 3.85, 4.00, 4.15 };
+  double soc = socNow();
+  for (int i = 1; i < 7; i++) {
+    if (soc <= socPts[i]) {
+      double k = (soc - socPts[i - 1]) / (socPts[i] - socPts[i - 1]);
+      return vPts[i - 1] + k * (vPts[i] - vPts[i - 1]);
+    }
+  }
+  return 4.15;
+}
+
+// ----- Внешний мир -----
+
+bool buttonPressed() { return timeline && timeline->pressedAt(shared->nowUs); }
+float loadKg() { return timeline ? timeline->loadAt(shared->nowUs) : 0.0f; }
+
+uint64_t nextButtonPressAfter(uint64_t t) {
+  return timeline ? timeline->nextPressAfter(t) : UINT64_MAX;
+}
+
+uint64_t nextPowerEventAfter(uint64_t t) {
+  return timeline ? timeline->nextPowerAfter(t) : UINT64_MAX;
+}
+
+// ----- HX711 -----
+// Конверсии идут непрерывно с периодом SIM_HX711_PERIOD_US начиная с hxReadyFromUs.
+
+void hxPowerUp() {
+  if (shared->hxPowered) return;
+  shared->hxPowered = true;
+  shared->hxReadyFromUs = shared->nowUs + SIM_HX711_SETTLE_US;
+  shared->hxConsumed = 0;
+}
+
+void hxPowerDown() {
+  shared->hxPowered = false;
+}
+
+// Номер последней готовой конверсии + 1 (0 — ещё ни одной)
+static uint64_t hxAvailable() {
+  if (!shared->hxPowered || shared->nowUs < shared->hxReadyFromUs) return 0;
+  return (shared->nowUs - shared->hxReadyFromUs) / SIM_HX711_PERIOD_US + 1;
+}
+
+bool hxReady() {
+  return hxAvailable() > shared->hxConsumed;
+}
+
+uint64_t hxNextReadyUs() {
+  if (!shared->hxPowered) return UINT64_MAX;
+  if (hxReady()) return shared->nowUs;
+  uint64_t n = shared->hxConsumed > hxAvailable() ? shared->hxConsumed : hxAvailable();
+  return shared->hxReadyFromUs + n * SIM_HX711_PERIOD_US;
+}
+
+long hxTakeSample() {
+  shared->hxConsumed = hxAvailable();
+  double counts = SIM_HX711_ZERO_COUNTS + loadKg() * SIM_HX711_COUNTS_PER_KG +
+                  gaussian() * SIM_HX711_NOISE_COUNTS;
+  advanceIn(CPU_ACTIVE, SIM_HX711_SHIFT_US);
+  return lround(counts);
+}
+
+// ----- Forced light sleep -----
+// millis() во время сна не идёт — время уходит в millisBiasUs.
+
+void lightSleep(uint64_t maxUs, bool wakeOnButton, bool wakeOnDout) {
+  uint64_t wake = shared->nowUs + maxUs;
+  if (wakeOnButton) {
+    uint64_t p = nextButtonPressAfter(shared->nowUs);
+    if (p < wake) wake = p;
+  }
+  if (wakeOnDout) {
+    uint64_t r = hxNextReadyUs();
+    if (r < wake) wake = r;
+  }
+  uint64_t us = wake - shared->nowUs;
+  uint64_t before = shared->nowUs;
+  try {
+    advanceIn(CPU_LIGHT_SLEEP, us);
+  } catch (...) {
+    shared->millisBiasUs += shared->nowUs - before;
+    throw;
+  }
+  shared->millisBiasUs += us;
+}
+
+// ----- Запуск прошивки -----
+
+static void firmwareBoot() {
+  setup();
+  for (;;) {
+    loop();
+    advanceIn(CPU_ACTIVE, SIM_LOOP_US);
+  }
+}
+
+// Выполнить fn в дочернем процессе; исход — в shared->outcome
+static void forkAndRun(void (*fn)()) {
+  fflush(stdout);
+  shared->outcome = OUT_CRASH;
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    exit(1);
+  }
+  if (pid == 0) {
+    inFirmware = true;
+    nextPowerUs = nextPowerEventAfter(shared->nowUs);
+    cpuState = CPU_ACTIVE;
+    try {
+      fn();
+      shared->outcome = OUT_NONE;
+    } catch (const DeepSleepRequest& r) {
+      shared->outcome = OUT_DEEP_SLEEP;
+      shared->sleepUs = r.us;
+    } catch (const RestartRequest&) {
+      shared->outcome = OUT_RESTART;
+    } catch (const EndOfRun&) {
+      shared->outcome = OUT_END;
+    }
+    fflush(stdout);
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    shared->outcome = OUT_CRASH;
+  }
+}
+
+Outcome runBoot(uint32_t resetReason) {
+  shared->resetReason = resetReason;
+  shared->boots++;
+  shared->millisBiasUs = shared->nowUs;   // millis() после сброса начинается с 0
+  shared->cpuCycles = 0;
+  shared->cpuFreqMHz = 80;
+  // Пробуждение из deep sleep без WAKE_RF_DISABLED — радио питается уже при загрузке
+  bool timerWake = resetReason == 5;   // REASON_DEEP_SLEEP_AWAKE
+  shared->rfEnabled = !timerWake || shared->sleepRf;
+  shared->radioOn = timerWake && shared->sleepRf;
+  shared->wifiBeginUs = UINT64_MAX;
+  advanceIn(CPU_ACTIVE, SIM_BOOT_US);
+  forkAndRun(firmwareBoot);
+  return shared->outcome;
+}
+
+void runInChild(void (*fn)()) {
+  shared->millisBiasUs = shared->nowUs;
+  forkAndRun(fn);
+}
+
+} // namespace Sim
@@ -0,0 +1,133 @@
+#pragma once
+
+// Ядро симулятора: настенное время, модель потребления, HX711, кнопка, АЦП,
+// EEPROM/RTC/flash. Прошивка работает в дочернем процессе (fork) от setup()
+// до deepSleep/restart — так каждая «перезагрузка» начинается с чистыми static,
+// а всё, что переживает сброс на железе, лежит в общей памяти Shared.
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Scenario.h"
+
+namespace Sim {
+
+enum CpuState {
+  CPU_ACTIVE,       // CPU выполняет код (в т.ч. опрос HX711, I2C)
+  CPU_IDLE,         // delay() — CPU тактируется
+  CPU_LIGHT_SLEEP,  // forced light sleep
+  CPU_DEEP_SLEEP,   // deep sleep / выключено
+  CPU_STATE_COUNT
+};
+
+// Потребители, по которым раскладывается заряд
+enum Consumer {
+  C_CPU,
+  C_HX711,
+  C_OLED,
+  C_FLASH,
+  C_BOARD,
+  C_RADIO,
+  C_COUNT
+};
+
+// Исход работы прошивки в дочернем процессе
+enum Outcome {
+  OUT_NONE,
+  OUT_DEEP_SLEEP,   // ESP.deepSleep(us), us = 0 — до внешнего сброса
+  OUT_RESTART,      // ESP.restart()
+  OUT_END,          // конец прогона
+  OUT_CRASH         // дочерний процесс завершился аварийно
+};
+
+// Исключения, которыми заглушки прерывают прошивку
+struct DeepSleepRequest { uint64_t us; };
+struct RestartRequest {};
+struct EndOfRun {};
+
+static const size_t EEPROM_BYTES = 4096;
+static const size_t RTC_USER_WORDS = 128;
+static const size_t FLASH_BYTES = 4UL * 1024UL * 1024UL;
+
+// Состояние, общее для родителя и всех «загрузок» прошивки
+struct Shared {
+  uint64_t nowUs;                 // настенное время
+  uint64_t endUs;                 // конец прогона
+  uint64_t millisBiasUs;          // сон, которого не видит millis()
+  uint64_t cpuCycles;             // такты CPU (ESP.getCycleCount)
+  uint8_t  cpuFreqMHz;
+
+  double   chargeMaUs[C_COUNT];   // заряд по потребителям, мА·мкс
+  uint64_t cpuStateUs[CPU_STATE_COUNT];
+  uint32_t boots;
+  uint32_t eepromCommits;
+  uint32_t flashErases;
+  uint32_t frames;
+  uint32_t i2cWrongClock;         // кадров передано не на 80 МГц
+  uint64_t cpuBoostUs;            // время CPU_ACTIVE на 160 МГц
+  uint64_t radioUs;               // время с включённым радио
+  uint32_t uplinkPosts;           // запросов принято сервером-двойником
+  uint32_t uplinkRecords;         // новых записей доставлено
+  uint32_t uplinkLastTs;          // последняя принятая запись (отбрасывание повторов)
+
+  uint32_t resetReason;           // REASON_* для следующей загрузки
+  Outcome  outcome;
+  uint64_t sleepUs;
+
+  // Периферия сохраняет состояние через сброс ESP8266
+  bool     hxPowered;
+  uint64_t hxReadyFromUs;         // первая конверсия после power_up
+  uint64_t hxConsumed;            // номер последней прочитанной конверсии + 1
+  bool     oledOn;
+  uint8_t  oledContrast;
+  bool     sleepRf;               // последний deepSleep — с включённым RF
+  bool     rfEnabled;             // радио может включиться в этой загрузке
+  bool     radioOn;
+  uint64_t wifiBeginUs;           // WiFi.begin(), UINT64_MAX — не подключаемся
+
+  double   batteryCapacityMah;
+  double   batteryStartSoc;
+
+  uint8_t  eeprom[EEPROM_BYTES];
+  uint32_t rtcUser[RTC_USER_WORDS];
+  uint8_t  flash[FLASH_BYTES];
+};
+
+extern Shared* shared;
+extern bool trace;                // печатать Serial прошивки и экран
+
+void init();                      // выделить общую память
+void resetRun(const Timeline* timeline, uint64_t endUs);
+void clearStats();                // обнулить время и счётчики, память не трогать
+
+// ----- Время и энергия -----
+uint64_t nowUs();
+void setCpu(CpuState state);
+CpuState cpu();
+void advance(uint64_t us);        // продвинуть время в текущем состоянии CPU
+void advanceIn(CpuState state, uint64_t us);
+void addFlashCharge(uint64_t us); // доп. ток записи flash на время us
+double totalMah();
+double socNow();                  // степень заряда с учётом расхода
+double batteryVoltage();
+
+// ----- Внешний мир -----
+bool  buttonPressed();            // кнопка D3 нажата сейчас
+float loadKg();                   // нагрузка на платформе сейчас
+uint64_t nextButtonPressAfter(uint64_t t);
+uint64_t nextPowerEventAfter(uint64_t t);
+
+// ----- HX711 -----
+void hxPowerUp();
+void hxPowerDown();
+bool hxReady();
+uint64_t hxNextReadyUs();         // момент готовности следующей непрочитанной конверсии
+long hxTakeSample();              // забрать готовую конверсию
+
+// ----- Forced light sleep -----
+void lightSleep(uint64_t maxUs, bool wakeOnButton, bool wakeOnDout);
+
+// ----- Запуск прошивки -----
+Outcome runBoot(uint32_t resetReason);   // один сеанс от setup() до сна/сброса
+void runInChild(void (*fn)());           // произвольный код прошивки в дочернем процессе
+
+} // namespace Sim
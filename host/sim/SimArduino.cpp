@@ -0,0 +1,374 @@
+// Реализация заглушек ядра Arduino, SDK и библиотек поверх модели Sim.
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <HX711.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+#include <ESP8266WiFi.h>
+extern "C" {
+  #include "user_interface.h"
+  #include "gpio.h"
+}
+
+#include "Sim.h"
+#include "PowerModel.h"
+#include "Config.h"
+
+#include <string>
+
+using Sim::shared;
+
+HardwareSerial Serial;
+EspClass ESP;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+// ===== Время =====
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)((shared->nowUs - shared->millisBiasUs) / 1000ULL);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)(shared->nowUs - shared->millisBiasUs);
+}
+
+// Состояние forced light sleep: wifi_fpm_do_sleep() лишь взводит сон,
+// CPU засыпает в следующем delay()
+static bool fpmOpen = false;
+static bool fpmLight = false;
+static uint32_t fpmSleepUs = 0;
+static bool wakeButton = false;
+static bool wakeDout = false;
+static fpm_wakeup_cb fpmCb = nullptr;
+
+void delay(unsigned long ms) {
+  if (fpmOpen && fpmLight && fpmSleepUs > 0) {
+    uint32_t us = fpmSleepUs;
+    fpmSleepUs = 0;
+    Sim::lightSleep(us, wakeButton, wakeDout);
+    if (fpmCb) fpmCb();
+    return;
+  }
+  Sim::advanceIn(Sim::CPU_IDLE, (uint64_t)ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+  Sim::advanceIn(Sim::CPU_ACTIVE, us);
+}
+
+void yield() {}
+
+// ===== Пины =====
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t pin) {
+  if (pin == BUTTON_PIN) return Sim::buttonPressed() ? LOW : HIGH;
+  if (pin == DOUT_PIN) return Sim::hxReady() ? LOW : HIGH;
+  return HIGH;
+}
+
+// Идеальный делитель: прошивка по своей формуле получает истинное напряжение
+int analogRead(uint8_t) {
+  Sim::advanceIn(Sim::CPU_ACTIVE, 100);
+  return (int)lround(Sim::batteryVoltage() * BAT_DIVIDER_RATIO / BAT_VOLTAGE_REF * BAT_ADC_MAX);
+}
+
+char* dtostrf(double number, signed char width, unsigned char prec, char* s) {
+  sprintf(s, "%*.*f", width, prec, number);
+  return s;
+}
+
+// ===== Print / Serial =====
+
+size_t Print::write(const uint8_t* buf, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buf++);
+  return n;
+}
+
+size_t Print::print(long n, int base) {
+  char buf[40];
+  if (base == 16)      snprintf(buf, sizeof(buf), "%lX", n);
+  else if (base == 8)  snprintf(buf, sizeof(buf), "%lo", n);
+  else                 snprintf(buf, sizeof(buf), "%ld", n);
+  return write(buf);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  char buf[40];
+  if (base == 16)      snprintf(buf, sizeof(buf), "%lX", n);
+  else if (base == 8)  snprintf(buf, sizeof(buf), "%lo", n);
+  else                 snprintf(buf, sizeof(buf), "%lu", n);
+  return write(buf);
+}
+
+size_t Print::print(double n, int digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t Print::printf(const char* fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n < 0) return 0;
+  return write((const uint8_t*)buf, strlen(buf));
+}
+
+void HardwareSerial::begin(unsigned long baud) { _baud = baud; }
+void HardwareSerial::updateBaudRate(unsigned long baud) { _baud = baud; }
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+int HardwareSerial::availableForWrite() { return 128; }
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (Sim::trace) fputc(c, stdout);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t size) {
+  if (Sim::trace) fwrite(buf, 1, size, stdout);
+  return size;
+}
+
+// ===== ESP =====
+
+void EspClass::deepSleep(uint64_t timeUs, RFMode mode) {
+  shared->radioOn = false;
+  shared->sleepRf = mode != RF_DISABLED;
+  throw Sim::DeepSleepRequest{ timeUs };
+}
+
+void EspClass::restart() {
+  shared->resetReason = REASON_SOFT_RESTART;
+  throw Sim::RestartRequest();
+}
+
+uint32_t EspClass::getCycleCount() { return (uint32_t)shared->cpuCycles; }
+uint8_t EspClass::getCpuFreqMHz() { return shared->cpuFreqMHz; }
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > Sim::RTC_USER_WORDS * 4 || (size & 3)) return false;
+  memcpy(data, &shared->rtcUser[offset], size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > Sim::RTC_USER_WORDS * 4 || (size & 3)) return false;
+  memcpy(&shared->rtcUser[offset], data, size);
+  return true;
+}
+
+rst_info* EspClass::getResetInfoPtr() { return system_get_rst_info(); }
+
+bool EspClass::flashEraseSector(uint32_t sector) {
+  uint32_t addr = sector * 4096;
+  if (addr + 4096 > Sim::FLASH_BYTES) return false;
+  memset(&shared->flash[addr], 0xFF, 4096);
+  shared->flashErases++;
+  Sim::advanceIn(Sim::CPU_ACTIVE, 30000);
+  Sim::addFlashCharge(30000);
+  return true;
+}
+
+// NOR-flash: запись только сбрасывает биты
+bool EspClass::flashWrite(uint32_t address, const uint32_t* data, size_t size) {
+  if ((address & 3) || (size & 3) || address + size > Sim::FLASH_BYTES) return false;
+  const uint8_t* src = (const uint8_t*)data;
+  for (size_t i = 0; i < size; i++) shared->flash[address + i] &= src[i];
+  uint64_t us = 10 + size / 4;
+  Sim::advanceIn(Sim::CPU_ACTIVE, us);
+  Sim::addFlashCharge(us);
+  return true;
+}
+
+bool EspClass::flashRead(uint32_t address, uint32_t* data, size_t size) {
+  if ((address & 3) || (size & 3) || address + size > Sim::FLASH_BYTES) return false;
+  memcpy(data, &shared->flash[address], size);
+  return true;
+}
+
+// Куча после старта ядра; выделения заглушек (кадр SSD1306 без своего буфера)
+// вычитаются — статические буферы прошивки её не трогают
+static uint32_t heapUsed = 0;
+
+uint32_t EspClass::getFreeHeap() { return 40000 - heapUsed; }
+uint32_t EspClass::getMaxFreeBlockSize() { return 36000 - heapUsed; }
+uint32_t EspClass::getFreeContStack() { return 2000; }
+
+// ===== SDK =====
+
+extern "C" {
+
+bool wifi_set_sleep_type(enum sleep_type) { return true; }
+bool wifi_set_opmode_current(uint8) { return true; }
+void wifi_fpm_set_sleep_type(enum sleep_type type) { fpmLight = (type == LIGHT_SLEEP_T); }
+void wifi_fpm_open(void) { fpmOpen = true; }
+void wifi_fpm_close(void) { fpmOpen = false; fpmSleepUs = 0; }
+sint32 wifi_fpm_do_sleep(uint32 us) { fpmSleepUs = us; return 0; }
+void wifi_fpm_do_wakeup(void) { fpmSleepUs = 0; }
+void wifi_fpm_set_wakeup_cb(fpm_wakeup_cb cb) { fpmCb = cb; }
+
+uint32 system_get_time(void) { return (uint32)micros(); }
+uint32 system_get_rtc_time(void) { return (uint32)shared->nowUs; }
+uint32 system_rtc_clock_cali_proc(void) { return 1U << 12; }   // 1 мкс на тик
+
+bool system_update_cpu_freq(uint8 freq) {
+  if (freq != SYS_CPU_80MHZ && freq != SYS_CPU_160MHZ) return false;
+  shared->cpuFreqMHz = freq;
+  return true;
+}
+
+uint8 system_get_cpu_freq(void) { return shared->cpuFreqMHz; }
+
+struct rst_info* system_get_rst_info(void) {
+  static rst_info info;
+  memset(&info, 0, sizeof(info));
+  info.reason = shared->resetReason;
+  return &info;
+}
+
+void gpio_pin_wakeup_enable(uint32_t pin, GPIO_INT_TYPE) {
+  if (pin == BUTTON_PIN) wakeButton = true;
+  if (pin == DOUT_PIN) wakeDout = true;
+}
+
+void gpio_pin_wakeup_disable(void) {
+  wakeButton = false;
+  wakeDout = false;
+}
+
+} // extern "C"
+
+// ===== HX711 =====
+
+void HX711::begin(uint8_t, uint8_t, uint8_t) { Sim::hxPowerUp(); }
+bool HX711::is_ready() { return Sim::hxReady(); }
+
+void HX711::wait_ready(unsigned long) {
+  uint64_t t = Sim::hxNextReadyUs();
+  if (t != UINT64_MAX && t > Sim::nowUs()) Sim::advanceIn(Sim::CPU_ACTIVE, t - Sim::nowUs());
+}
+
+bool HX711::wait_ready_retry(int retries, unsigned long delay_ms) {
+  for (int i = 0; i < retries; i++) {
+    if (is_ready()) return true;
+    delay(delay_ms);
+  }
+  return is_ready();
+}
+
+// Опрос DOUT в цикле с delay(0) — CPU занят всё время ожидания
+bool HX711::wait_ready_timeout(unsigned long timeout, unsigned long) {
+  uint64_t t = Sim::hxNextReadyUs();
+  uint64_t limit = Sim::nowUs() + (uint64_t)timeout * 1000ULL;
+  if (t > limit) {
+    Sim::advanceIn(Sim::CPU_ACTIVE, limit - Sim::nowUs());
+    return false;
+  }
+  if (t > Sim::nowUs()) Sim::advanceIn(Sim::CPU_ACTIVE, t - Sim::nowUs());
+  return true;
+}
+
+long HX711::read() {
+  wait_ready();
+  if (!Sim::hxReady()) return 0;
+  return Sim::hxTakeSample();
+}
+
+long HX711::read_average(uint8_t times) {
+  long sum = 0;
+  for (uint8_t i = 0; i < times; i++) sum += read();
+  return times ? sum / times : 0;
+}
+
+void HX711::power_down() { Sim::hxPowerDown(); }
+void HX711::power_up() { Sim::hxPowerUp(); }
+
+// ===== EEPROM =====
+
+void EEPROMClass::begin(size_t size) {
+  _size = size < Sim::EEPROM_BYTES ? size : Sim::EEPROM_BYTES;
+}
+
+uint8_t* EEPROMClass::data() { return shared->eeprom; }
+uint8_t EEPROMClass::read(int address) const { return shared->eeprom[address]; }
+
+void EEPROMClass::write(int address, uint8_t value) {
+  shared->eeprom[address] = value;
+  _dirty = true;
+}
+
+bool EEPROMClass::commit() {
+  if (!_dirty) return true;
+  _dirty = false;
+  shared->eepromCommits++;
+  Sim::advanceIn(Sim::CPU_ACTIVE, SIM_FLASH_COMMIT_US);
+  Sim::addFlashCharge(SIM_FLASH_COMMIT_US);
+  return true;
+}
+
+// ===== SSD1306 =====
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  size_t len = strlen(_text);
+  if (c == '\r') return 1;
+  if (len + 1 < sizeof(_text)) {
+    _text[len] = (c == '\n') ? '|' : (char)c;
+    _text[len + 1] = '\0';
+  }
+  return 1;
+}
+
+bool Adafruit_SSD1306::begin(uint8_t, uint8_t, bool, bool) {
+  if (buffer == nullptr) {
+    size_t bytes = (size_t)_width * ((_height + 7) / 8);
+    buffer = (uint8_t*)malloc(bytes);
+    if (buffer == nullptr) return false;
+    heapUsed += bytes;
+  }
+  shared->oledOn = true;
+  shared->oledContrast = 0xCF;
+  Sim::advanceIn(Sim::CPU_ACTIVE, 5000);
+  return true;
+}
+
+// Отрисовка кадра в буфер (Adafruit GFX) — чистые вычисления, время ~ 1/частота
+void Adafruit_SSD1306::clearDisplay() {
+  _text[0] = '\0';
+  Sim::advanceIn(Sim::CPU_ACTIVE, SIM_RENDER_US * 80 / shared->cpuFreqMHz);
+}
+
+void Adafruit_SSD1306::display() {
+  // Программный I2C рассчитан на 80 МГц — на другой частоте кадр был бы испорчен
+  if (shared->cpuFreqMHz != 80) shared->i2cWrongClock++;
+  Sim::advanceIn(Sim::CPU_ACTIVE, SIM_I2C_FRAME_US);
+  shared->frames++;
+  if (Sim::trace) {
+    static std::string last;
+    if (last != _text) {
+      last = _text;
+      ::printf("[%10.3f s] screen: %s\n", Sim::nowUs() / 1e6, _text);
+    }
+  }
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+  Sim::advanceIn(Sim::CPU_ACTIVE, 50);
+  if (_expectContrast) {
+    shared->oledContrast = c;
+    _expectContrast = false;
+    return;
+  }
+  if (c == SSD1306_SETCONTRAST) _expectContrast = true;
+  else if (c == SSD1306_DISPLAYOFF) shared->oledOn = false;
+  else if (c == SSD1306_DISPLAYON) shared->oledOn = true;
+}
@@ -0,0 +1,113 @@
+// Заглушка WiFi поверх модели Sim: радио (ток и время), подключение к точке
+// доступа и TCP к серверу-двойнику выгрузки (UplinkServer).
+//
+// Радио включается, только если загрузка разрешает RF: холодный старт или
+// пробуждение после deepSleep без WAKE_RF_DISABLED.
+
+#include <ESP8266WiFi.h>
+
+#include "Sim.h"
+#include "PowerModel.h"
+#include "UplinkServer.h"
+
+using Sim::shared;
+
+ESP8266WiFiClass WiFi;
+
+static bool forceSleep = false;   // WiFi.forceSleepBegin() до forceSleepWake()
+
+static void updateRadio(WiFiMode_t mode) {
+  shared->radioOn = shared->rfEnabled && !forceSleep && mode != WIFI_OFF;
+  if (!shared->radioOn) shared->wifiBeginUs = UINT64_MAX;
+}
+
+bool ESP8266WiFiClass::mode(WiFiMode_t m) {
+  _mode = m;
+  updateRadio(_mode);
+  return true;
+}
+
+bool ESP8266WiFiClass::forceSleepBegin(uint32_t) {
+  forceSleep = true;
+  updateRadio(_mode);
+  return true;
+}
+
+bool ESP8266WiFiClass::forceSleepWake() {
+  forceSleep = false;
+  updateRadio(_mode);
+  return true;
+}
+
+wl_status_t ESP8266WiFiClass::begin(const char*, const char*) {
+  if (shared->radioOn) shared->wifiBeginUs = shared->nowUs;
+  return WL_DISCONNECTED;
+}
+
+wl_status_t ESP8266WiFiClass::status() {
+  if (!shared->radioOn || shared->wifiBeginUs == UINT64_MAX) return WL_DISCONNECTED;
+  return shared->nowUs - shared->wifiBeginUs >= SIM_WIFI_CONNECT_US ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+bool ESP8266WiFiClass::disconnect(bool wifiOff) {
+  shared->wifiBeginUs = UINT64_MAX;
+  if (wifiOff) mode(WIFI_OFF);
+  return true;
+}
+
+// ===== TCP к серверу-двойнику =====
+
+static UplinkHost::Server server;
+static uint64_t responseAtUs = UINT64_MAX;   // Ответ виден после RTT
+static size_t responsePos = 0;
+
+int WiFiClient::connect(const char*, uint16_t) {
+  if (WiFi.status() != WL_CONNECTED) return 0;
+  Sim::advanceIn(Sim::CPU_IDLE, SIM_TCP_CONNECT_US);
+  server = UplinkHost::Server(shared->uplinkLastTs);
+  responseAtUs = UINT64_MAX;
+  responsePos = 0;
+  _open = true;
+  return 1;
+}
+
+void WiFiClient::stop() {
+  _open = false;
+}
+
+uint8_t WiFiClient::connected() {
+  return _open && shared->radioOn;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if (!connected()) return 0;
+  Sim::advanceIn(Sim::CPU_ACTIVE, (uint64_t)size * SIM_WIFI_US_PER_BYTE);
+  if (responseAtUs == UINT64_MAX && server.feed(buf, size)) {
+    responseAtUs = shared->nowUs + SIM_HTTP_RTT_US;
+    if (server.response.compare(0, 12, "HTTP/1.1 200") == 0) {
+      shared->uplinkPosts++;
+      shared->uplinkRecords += server.records.size();
+      shared->uplinkLastTs = server.lastTs;
+    }
+  }
+  return size;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+int WiFiClient::available() {
+  if (!connected() || shared->nowUs < responseAtUs) return 0;
+  return (int)(server.response.size() - responsePos);
+}
+
+int WiFiClient::read() {
+  if (available() <= 0) return -1;
+  return (uint8_t)server.response[responsePos++];
+}
+
+int WiFiClient::peek() {
+  if (available() <= 0) return -1;
+  return (uint8_t)server.response[responsePos];
+}
@@ -0,0 +1,60 @@
+// Разбор двоичной телеметрии фильтра веса (команда t консоли, debug-сборка)
+// в CSV. Поток — запись порта как есть (например, cat /dev/ttyUSB0 > tel.bin);
+// отладочный текст между записями пропускается по синхрослову и CRC8.
+//
+//   telemetry_decode [tel.bin] > tel.csv      — без файла читается stdin
+//
+// Пропуски видны по seq: gap — записей между соседними принятыми
+// (отброшены устройством при полном TX FIFO или потеряны в линии).
+
+#include "Telemetry.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+int main(int argc, char** argv) {
+  FILE* in = argc > 1 ? fopen(argv[1], "rb") : stdin;
+  if (!in) {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), in)) > 0) data.insert(data.end(), buf, buf + n);
+  if (in != stdin) fclose(in);
+
+  printf("ms,raw,median_kg,ema_kg,stable,overload,median_full,gap,dropped\n");
+  unsigned long records = 0, gaps = 0, skipped = 0;
+  int prevSeq = -1;
+  size_t i = 0;
+  while (i + sizeof(TelemetryRecord) <= data.size()) {
+    TelemetryRecord rec;
+    if (data[i] != TELEMETRY_SYNC0 || data[i + 1] != TELEMETRY_SYNC1) {
+      i++;
+      skipped++;
+      continue;
+    }
+    memcpy(&rec, &data[i], sizeof(rec));
+    if (rec.crc8 != Telemetry_Crc8(&data[i], offsetof(TelemetryRecord, crc8))) {
+      i++;
+      skipped++;
+      continue;
+    }
+    i += sizeof(rec);
+
+    unsigned gap = prevSeq < 0 ? 0 : (uint8_t)(rec.seq - prevSeq - 1);
+    prevSeq = rec.seq;
+    gaps += gap;
+    records++;
+    printf("%lu,%ld,%.4f,%.4f,%d,%d,%d,%u,%u\n", (unsigned long)rec.ms, (long)rec.raw,
+           rec.medianKg, rec.emaKg, (rec.flags & TEL_FLAG_STABLE) != 0,
+           (rec.flags & TEL_FLAG_OVERLOAD) != 0, (rec.flags & TEL_FLAG_MEDIAN_FULL) != 0,
+           gap, rec.dropped);
+  }
+  fprintf(stderr, "%lu records, %lu missing by seq, %lu bytes of other output skipped\n",
+          records, gaps, skipped + (data.size() - i));
+  return 0;
+}
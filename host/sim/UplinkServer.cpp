@@ -0,0 +1,133 @@
+#include "UplinkServer.h"
+#include "SampleCodec.h"
+#include "Uplink.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+namespace UplinkHost {
+
+Server::Server(uint32_t lastTs) : lastTs(lastTs) {}
+
+void Server::reset() {
+  head_.clear();
+  body_.clear();
+  inBody_ = false;
+  done_ = false;
+  length_ = 0;
+  response.clear();
+}
+
+void Server::respond(int status) {
+  const char* reason = status == 200 ? "OK" : status == 400 ? "Bad Request" : "Error";
+  response = "HTTP/1.1 " + std::to_string(status) + " " + reason +
+             "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  done_ = true;
+}
+
+// Значение заголовка name из head_ (без учёта регистра); пусто — нет
+static std::string header(const std::string& head, const char* name) {
+  size_t nameLen = strlen(name);
+  size_t pos = head.find("\r\n");
+  while (pos != std::string::npos) {
+    size_t line = pos + 2;
+    size_t eol = head.find("\r\n", line);
+    if (eol == std::string::npos) eol = head.size();
+    if (eol - line > nameLen && head[line + nameLen] == ':' &&
+        strncasecmp(head.c_str() + line, name, nameLen) == 0) {
+      size_t v = line + nameLen + 1;
+      while (v < eol && head[v] == ' ') v++;
+      return head.substr(v, eol - v);
+    }
+    pos = eol < head.size() ? eol : std::string::npos;
+  }
+  return std::string();
+}
+
+// Тело: 'H' 'V' версия n, затем n блоков (заголовок + length байт)
+void Server::finish() {
+  requests++;
+  const uint8_t* p = body_.data();
+  size_t left = body_.size();
+  if (left < 4 || p[0] != 'H' || p[1] != 'V' || p[2] != UPLINK_FORMAT_VERSION) {
+    respond(400);
+    return;
+  }
+  uint8_t n = p[3];
+  p += 4;
+  left -= 4;
+
+  std::vector<LogRecord> fresh;
+  uint32_t newLast = lastTs;
+  uint32_t got = 0, dup = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    CodecBlockHeader hdr;
+    if (left < CODEC_HEADER_SIZE) break;
+    memcpy(&hdr, p, sizeof(hdr));
+    size_t size = CODEC_HEADER_SIZE + hdr.length;
+    if (left < size) break;
+    CodecDecoder d;
+    if (!Codec_Open(&d, p, size)) {
+      badBlocks++;
+    } else {
+      LogRecord rec;
+      while (Codec_Next(&d, &rec)) {
+        if (rec.ts <= newLast) {
+          dup++;
+          continue;
+        }
+        newLast = rec.ts;
+        fresh.push_back(rec);
+      }
+      got++;
+    }
+    p += size;
+    left -= size;
+  }
+  if (got + badBlocks < n || left != 0) {
+    respond(400);
+    return;
+  }
+  if (failStatus != 0) {
+    respond(failStatus);
+    return;
+  }
+  // Принято только при ответе 200: иначе устройство повторит ту же пачку
+  blocks += got;
+  duplicates += dup;
+  lastTs = newLast;
+  records.insert(records.end(), fresh.begin(), fresh.end());
+  respond(200);
+}
+
+bool Server::feed(const uint8_t* data, size_t n) {
+  for (size_t i = 0; i < n && !done_; i++) {
+    if (inBody_) {
+      body_.push_back(data[i]);
+    } else {
+      head_.push_back((char)data[i]);
+      if (head_.size() < 4 || head_.compare(head_.size() - 4, 4, "\r\n\r\n") != 0) {
+        if (head_.size() > 1024) respond(400);
+        continue;
+      }
+      if (head_.compare(0, 5, "POST ") != 0) {
+        respond(400);
+        break;
+      }
+      size_t sp = head_.find(' ', 5);
+      path = head_.substr(5, sp == std::string::npos ? 0 : sp - 5);
+      device = header(head_, "X-Device");
+      std::string len = header(head_, "Content-Length");
+      if (len.empty()) {
+        respond(400);
+        break;
+      }
+      length_ = strtoul(len.c_str(), nullptr, 10);
+      inBody_ = true;
+    }
+    if (inBody_ && body_.size() >= length_) finish();
+  }
+  return done_;
+}
+
+} // namespace UplinkHost
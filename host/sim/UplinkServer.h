@@ -0,0 +1,43 @@
+#pragma once
+
+// Сервер-двойник выгрузки (Mini_Scale/Uplink.h): разбор HTTP POST с пачкой
+// блоков SampleCodec и ответ. Транспорт — забота вызывающего (заглушка WiFi
+// в симуляторе, подставной транспорт в тестах, TCP в uplink_server).
+
+#include "RtcLog.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace UplinkHost {
+
+struct Server {
+  explicit Server(uint32_t lastTs = 0);
+
+  // Байты запроса; true — запрос принят целиком, ответ готов в response
+  bool feed(const uint8_t* data, size_t n);
+  void reset();                   // К следующему запросу (новое соединение)
+
+  int         failStatus = 0;     // Отвечать этим кодом вместо 200 (проверка повторов)
+  std::string path;
+  std::string device;             // X-Device
+  std::string response;
+  uint32_t    lastTs;             // Последняя принятая запись
+  uint32_t    requests = 0;
+  uint32_t    blocks = 0;         // Принято блоков (в принятых запросах)
+  uint32_t    duplicates = 0;     // Записей с ts <= lastTs — повтор после потерянного ответа
+  uint32_t    badBlocks = 0;
+  std::vector<LogRecord> records; // Новые записи из всех принятых запросов
+
+private:
+  void finish();
+  void respond(int status);
+
+  std::string head_;
+  std::vector<uint8_t> body_;
+  bool   inBody_ = false;
+  bool   done_ = false;
+  size_t length_ = 0;
+};
+
+} // namespace UplinkHost
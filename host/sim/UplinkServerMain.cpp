@@ -0,0 +1,119 @@
+// Локальный сервер-двойник выгрузки по WiFi (Mini_Scale/Uplink.h) для
+// проверки с настоящим устройством: UPLINK_HOST в Config.h — адрес этой машины.
+//
+//   uplink_server [--port N] [--fail CODE]
+//
+// Каждый принятый POST дописывает новые записи в stdout в CSV выгрузки 'h';
+// сводка по запросу — в stderr. --fail отвечает кодом CODE без приёма данных
+// (проверка повторов с паузой на устройстве).
+
+#include "UplinkServer.h"
+#include "Config.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+
+static const int IDLE_TIMEOUT_MS = 10000;   // Соединение молчит — закрыть
+
+static void usage() {
+  fprintf(stderr, "usage: uplink_server [--port N] [--fail CODE]\n");
+}
+
+static void printRecords(const UplinkHost::Server& server, size_t from) {
+  for (size_t i = from; i < server.records.size(); i++) {
+    const LogRecord& r = server.records[i];
+    if (r.flags & LOG_FLAG_ERROR) {
+      printf("%lu,,%u,%u\n", (unsigned long)r.ts, r.battery, r.flags);
+    } else {
+      printf("%lu,%.3f,%u,%u\n", (unsigned long)r.ts, r.weight_g / 1000.0f, r.battery, r.flags);
+    }
+  }
+  fflush(stdout);
+}
+
+// Один запрос: читать до конца тела, ответить, закрыть
+static void serve(int fd, UplinkHost::Server* server) {
+  size_t before = server->records.size();
+  uint32_t dupBefore = server->duplicates;
+  server->reset();
+  uint8_t buf[512];
+  bool done = false;
+  while (!done) {
+    pollfd p = { fd, POLLIN, 0 };
+    if (poll(&p, 1, IDLE_TIMEOUT_MS) <= 0) break;
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    done = server->feed(buf, (size_t)n);
+  }
+  if (!done) {
+    fprintf(stderr, "connection closed before end of request\n");
+    return;
+  }
+  size_t off = 0;
+  while (off < server->response.size()) {
+    ssize_t n = write(fd, server->response.data() + off, server->response.size() - off);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    off += (size_t)n;
+  }
+  fprintf(stderr, "%s %s: %s -> %zu new, %u duplicate\n", server->device.c_str(),
+          server->path.c_str(), server->response.substr(9, 3).c_str(),
+          server->records.size() - before, server->duplicates - dupBefore);
+  printRecords(*server, before);
+}
+
+int main(int argc, char** argv) {
+  int port = UPLINK_PORT;
+  UplinkHost::Server server;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasArg = i + 1 < argc;
+    if (a == "--port" && hasArg) {
+      port = atoi(argv[++i]);
+    } else if (a == "--fail" && hasArg) {
+      server.failStatus = atoi(argv[++i]);
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (port <= 0 || port > 65535) {
+    usage();
+    return 1;
+  }
+
+  int ls = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(ls, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)port);
+  if (ls < 0 || bind(ls, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(ls, 4) != 0) {
+    fprintf(stderr, "cannot listen on port %d: %s\n", port, strerror(errno));
+    return 1;
+  }
+  fprintf(stderr, "listening on port %d\n", port);
+  printf("ts,weight_kg,battery,flags\n");
+  fflush(stdout);
+
+  for (;;) {
+    int fd = accept(ls, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      fprintf(stderr, "accept: %s\n", strerror(errno));
+      return 1;
+    }
+    serve(fd, &server);
+    close(fd);
+  }
+}
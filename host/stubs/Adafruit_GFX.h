@@ -0,0 +1,46 @@
+#pragma once
+
+// Заглушка Adafruit GFX: рисование не выполняется, текст собирается в строку
+// (Sim может вывести «что на экране» в трассировку).
+
+#include <Arduino.h>
+
+#define WHITE 1
+#define BLACK 0
+#define SSD1306_WHITE WHITE
+#define SSD1306_BLACK BLACK
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+  void setTextSize(uint8_t s) { _textSize = s ? s : 1; }
+  void setTextColor(uint16_t c) { (void)c; }
+  void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+  void drawPixel(int16_t, int16_t, uint16_t) {}
+  void drawRect(int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+  void fillRect(int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+  void drawFastHLine(int16_t, int16_t, int16_t, uint16_t) {}
+  void drawFastVLine(int16_t, int16_t, int16_t, uint16_t) {}
+  void fillTriangle(int16_t, int16_t, int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+  void fillScreen(uint16_t) { _text[0] = '\0'; }
+  void getTextBounds(const char* s, int16_t x, int16_t y,
+                     int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+    *x1 = x;
+    *y1 = y;
+    *w = (uint16_t)(strlen(s) * 6 * _textSize);
+    *h = (uint16_t)(8 * _textSize);
+  }
+  int16_t width() const  { return _width; }
+  int16_t height() const { return _height; }
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  const char* text() const { return _text; }  // текст, напечатанный после clearDisplay()
+
+protected:
+  int16_t _width, _height;
+  int16_t _cursorX = 0, _cursorY = 0;
+  uint8_t _textSize = 1;
+  char    _text[128] = {0};
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+// Заглушка Adafruit SSD1306. clearDisplay() стоит времени отрисовки кадра
+// (масштабируется частотой CPU), display() — передачи кадра по I2C;
+// контраст и DISPLAYON/OFF передаются в модель потребления Sim. Как и
+// библиотека, begin() выделяет кадр в куче, если buffer ещё не задан
+// (выделение видно в ESP.getFreeHeap() модели).
+
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_EXTERNALVCC  0x01
+#define SSD1306_SETCONTRAST  0x81
+#define SSD1306_DISPLAYOFF   0xAE
+#define SSD1306_DISPLAYON    0xAF
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1)
+      : Adafruit_GFX(w, h) { (void)twi; (void)rst_pin; }
+  bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0,
+             bool reset = true, bool periphBegin = true);
+  void display();
+  void clearDisplay();
+  void ssd1306_command(uint8_t c);
+  void dim(bool dim) { ssd1306_command(SSD1306_SETCONTRAST); ssd1306_command(dim ? 0 : 0xCF); }
+  uint8_t* getBuffer() { return buffer; }
+
+protected:
+  uint8_t* buffer = nullptr;
+
+private:
+  bool _expectContrast = false;
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+// Заглушка ядра ESP8266 Arduino для хостовой сборки (симулятор, тесты).
+// Реализация — host/sim/SimArduino.cpp: время, пины и АЦП берутся из модели Sim.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x00
+#define OUTPUT       0x01
+#define INPUT_PULLUP 0x02
+
+// Номера пинов Wemos D1 mini = номера GPIO
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+#define A0 17
+#define LED_BUILTIN 2
+
+#define F_CPU 80000000L
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr)   (*(const void* const*)(addr))
+#define strlen_P  strlen
+#define strcmp_P  strcmp
+#define strncmp_P strncmp
+#define strncpy_P strncpy
+#define strcpy_P  strcpy
+#define memcpy_P  memcpy
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+class __FlashStringHelper;
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper*>(p))
+#define F(s)     FPSTR(s)
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+using std::min;
+using std::max;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int  digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  analogRead(uint8_t pin);
+
+char* dtostrf(double number, signed char width, unsigned char prec, char* s);
+
+// ===== Print =====
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t size);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t print(const char* s)                  { return write(s); }
+  size_t print(const __FlashStringHelper* s)   { return write((const char*)s); }
+  size_t print(char c)                         { return write((uint8_t)c); }
+  size_t print(int n, int base = 10)           { return print((long)n, base); }
+  size_t print(unsigned int n, int base = 10)  { return print((unsigned long)n, base); }
+  size_t print(long n, int base = 10);
+  size_t print(unsigned long n, int base = 10);
+  size_t print(double n, int digits = 2);
+
+  template <typename T> size_t println(T v)    { size_t n = print(v); return n + println(); }
+  template <typename T> size_t println(T v, int f) { size_t n = print(v, f); return n + println(); }
+  size_t println()                             { return write("\r\n"); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// ===== Stream =====
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+// ===== Serial =====
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  void updateBaudRate(unsigned long baud);
+  unsigned long baudRate() const { return _baud; }
+  int  available() override;
+  int  read() override;
+  int  peek() override;
+  int  availableForWrite();
+  void flush() {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+  operator bool() const { return true; }
+private:
+  unsigned long _baud = 0;
+};
+
+extern HardwareSerial Serial;
+
+// ===== ESP =====
+struct rst_info;
+
+enum RFMode { RF_DEFAULT = 0, RF_CAL = 1, RF_NO_CAL = 2, RF_DISABLED = 4 };
+#define WAKE_RF_DEFAULT  RF_DEFAULT
+#define WAKE_RF_DISABLED RF_DISABLED
+
+class EspClass {
+public:
+  void wdtFeed() {}
+  void wdtDisable() {}
+  void wdtEnable(uint32_t) {}
+  [[noreturn]] void deepSleep(uint64_t timeUs, RFMode mode = RF_DEFAULT);
+  [[noreturn]] void restart();
+  uint32_t getCycleCount();
+  uint8_t  getCpuFreqMHz();
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+  rst_info* getResetInfoPtr();
+  bool flashEraseSector(uint32_t sector);
+  bool flashWrite(uint32_t address, const uint32_t* data, size_t size);
+  bool flashRead(uint32_t address, uint32_t* data, size_t size);
+  uint32_t getChipId() { return 0x00A1B2C3; }
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize();
+  uint32_t getFreeContStack();
+  void resetFreeContStack() {}
+};
+
+extern EspClass ESP;
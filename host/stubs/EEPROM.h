@@ -0,0 +1,33 @@
+#pragma once
+
+// Заглушка эмуляции EEPROM ESP8266: образ хранится в общей памяти симулятора
+// и переживает «перезагрузки». commit() стоит времени и энергии записи сектора.
+
+#include <Arduino.h>
+
+class EEPROMClass {
+public:
+  void begin(size_t size);
+  bool commit();
+  bool end() { return commit(); }
+  size_t length() const { return _size; }
+  uint8_t read(int address) const;
+  void write(int address, uint8_t value);
+
+  template <typename T> T& get(int address, T& t) {
+    memcpy(&t, data() + address, sizeof(T));
+    return t;
+  }
+  template <typename T> const T& put(int address, const T& t) {
+    memcpy(data() + address, &t, sizeof(T));
+    _dirty = true;
+    return t;
+  }
+
+private:
+  uint8_t* data();
+  size_t _size = 0;
+  bool   _dirty = false;
+};
+
+extern EEPROMClass EEPROM;
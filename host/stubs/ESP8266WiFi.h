@@ -0,0 +1,48 @@
+#pragma once
+
+// Заглушка ESP8266WiFi: радио и TCP поверх модели Sim (sim/SimWiFi.cpp).
+// Точка доступа «видна» только если загрузка была с включённым RF;
+// соединение ведёт к серверу-двойнику выгрузки (UplinkHost::Server).
+
+#include <Arduino.h>
+
+enum WiFiMode_t { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 };
+
+enum wl_status_t {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_DISCONNECTED = 6
+};
+
+class ESP8266WiFiClass {
+public:
+  bool mode(WiFiMode_t m);
+  WiFiMode_t getMode() const { return _mode; }
+  bool forceSleepBegin(uint32_t sleepUs = 0);
+  bool forceSleepWake();
+  void persistent(bool) {}
+  wl_status_t begin(const char* ssid, const char* pass);
+  wl_status_t status();
+  bool disconnect(bool wifiOff = false);
+private:
+  WiFiMode_t _mode = WIFI_STA;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+class WiFiClient : public Stream {
+public:
+  int connect(const char* host, uint16_t port);
+  void stop();
+  uint8_t connected();
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+private:
+  bool _open = false;
+};
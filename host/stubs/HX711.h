@@ -0,0 +1,31 @@
+#pragma once
+
+// Заглушка библиотеки bogde/HX711. Конверсии и вес на платформе моделирует Sim:
+// 10 SPS, установление после power_up, шум, нагрузка из сценария.
+
+#include <Arduino.h>
+
+class HX711 {
+public:
+  void begin(uint8_t dout, uint8_t pd_sck, uint8_t gain = 128);
+  bool is_ready();
+  void wait_ready(unsigned long delay_ms = 0);
+  bool wait_ready_retry(int retries = 3, unsigned long delay_ms = 0);
+  bool wait_ready_timeout(unsigned long timeout = 1000, unsigned long delay_ms = 0);
+  void set_gain(uint8_t gain = 128) { (void)gain; }
+  long read();
+  long read_average(uint8_t times = 10);
+  double get_value(uint8_t times = 1) { return read_average(times) - OFFSET; }
+  float get_units(uint8_t times = 1)  { return get_value(times) / SCALE; }
+  void tare(uint8_t times = 10)       { set_offset(read_average(times)); }
+  void set_scale(float scale = 1.f)   { SCALE = scale; }
+  float get_scale()                   { return SCALE; }
+  void set_offset(long offset = 0)    { OFFSET = offset; }
+  long get_offset()                   { return OFFSET; }
+  void power_down();
+  void power_up();
+
+private:
+  long  OFFSET = 0;
+  float SCALE  = 1.f;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  void begin() {}
+  void begin(int sda, int scl) { (void)sda; (void)scl; }
+  void setClock(uint32_t freq) { _clock = freq; }
+  uint32_t getClock() const { return _clock; }
+private:
+  uint32_t _clock = 100000;
+};
+
+extern TwoWire Wire;
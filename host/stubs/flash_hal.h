@@ -0,0 +1,7 @@
+#pragma once
+
+// Область FS во flash (раскладка 4M, FS:2MB) — как задаёт линкер ядра ESP8266
+#define FS_PHYS_ADDR   0x200000UL
+#define FS_PHYS_SIZE   0x1FA000UL
+#define FS_PHYS_PAGE   0x100
+#define FS_PHYS_BLOCK  0x2000
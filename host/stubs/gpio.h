@@ -0,0 +1,19 @@
+#pragma once
+
+// Заглушка NONOS SDK (gpio.h): только пробуждение из light sleep по уровню.
+
+#include <stdint.h>
+
+typedef enum {
+  GPIO_PIN_INTR_DISABLE = 0,
+  GPIO_PIN_INTR_POSEDGE = 1,
+  GPIO_PIN_INTR_NEGEDGE = 2,
+  GPIO_PIN_INTR_ANYEDGE = 3,
+  GPIO_PIN_INTR_LOLEVEL = 4,
+  GPIO_PIN_INTR_HILEVEL = 5
+} GPIO_INT_TYPE;
+
+#define GPIO_ID_PIN(n) (n)
+
+void gpio_pin_wakeup_enable(uint32_t i, GPIO_INT_TYPE intr_state);
+void gpio_pin_wakeup_disable(void);
@@ -0,0 +1,62 @@
+#pragma once
+
+// Заглушка NONOS SDK (user_interface.h): сон, RTC, частота CPU, причина сброса.
+// Подключается прошивкой внутри extern "C" { }.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint8_t  uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int32_t  sint32;
+
+enum sleep_type {
+  NONE_SLEEP_T = 0,
+  LIGHT_SLEEP_T,
+  MODEM_SLEEP_T
+};
+
+#define NULL_MODE     0x00
+#define STATION_MODE  0x01
+
+#define SYS_CPU_80MHZ  80
+#define SYS_CPU_160MHZ 160
+
+enum rst_reason {
+  REASON_DEFAULT_RST      = 0,
+  REASON_WDT_RST          = 1,
+  REASON_EXCEPTION_RST    = 2,
+  REASON_SOFT_WDT_RST     = 3,
+  REASON_SOFT_RESTART     = 4,
+  REASON_DEEP_SLEEP_AWAKE = 5,
+  REASON_EXT_SYS_RST      = 6
+};
+
+struct rst_info {
+  uint32 reason;
+  uint32 exccause;
+  uint32 epc1;
+  uint32 epc2;
+  uint32 epc3;
+  uint32 excvaddr;
+  uint32 depc;
+};
+
+typedef void (*fpm_wakeup_cb)(void);
+
+bool   wifi_set_sleep_type(enum sleep_type type);
+bool   wifi_set_opmode_current(uint8 opmode);
+void   wifi_fpm_set_sleep_type(enum sleep_type type);
+void   wifi_fpm_open(void);
+void   wifi_fpm_close(void);
+sint32 wifi_fpm_do_sleep(uint32 sleep_time_in_us);
+void   wifi_fpm_do_wakeup(void);
+void   wifi_fpm_set_wakeup_cb(fpm_wakeup_cb cb);
+
+uint32 system_get_time(void);
+uint32 system_get_rtc_time(void);
+uint32 system_rtc_clock_cali_proc(void);
+bool   system_update_cpu_freq(uint8 freq);
+uint8  system_get_cpu_freq(void);
+struct rst_info* system_get_rst_info(void);
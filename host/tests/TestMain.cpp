@@ -0,0 +1,1258 @@
+// Хостовые тесты: чистая логика прошивки, разбор сценариев симулятора,
+// форматирование отложенного лога, консоль, хранилища измерений на моделях RTC-памяти и flash
+// выгрузка по WiFi на сервер-двойник, многоточечная калибровка, режимы калибровки и настроек,
+// цепочка фильтров веса (ScalePipeline), задержка итераций loop() (LoopStats).
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <Arduino.h>
+#include <flash_hal.h>
+#include "CoreLogicTests.h"
+#include "Scenario.h"
+#include "Sim.h"
+#include "PowerModel.h"
+#include "RtcLog.h"
+#include "HistoryStore.h"
+#include "Rrd.h"
+#include "BulkExport.h"
+#include "BulkClient.h"
+#include "Log.h"
+#include "Console.h"
+#include "Uplink.h"
+#include "UplinkServer.h"
+#include "CalFit.h"
+#include "Crc16.h"
+#include "ScalePipeline.h"
+#include <math.h>
+#include "MemoryControl.h"
+#include "ScaleControl.h"
+#include "ButtonControl.h"
+#include "CalibrationMode.h"
+#include "DisplayControl.h"
+#include "BatteryControl.h"
+#include "RamStats.h"
+#include "LoopStats.h"
+#include "PowerStats.h"
+
+extern "C" {
+  #include "user_interface.h"
+}
+
+// Петля устройство <-> хост в памяти вместо UART
+class LoopStream : public Stream {
+public:
+  std::vector<uint8_t> in, out;
+  size_t pos = 0;
+  int available() override { return (int)(in.size() - pos); }
+  int read() override { return pos < in.size() ? in[pos++] : -1; }
+  int peek() override { return pos < in.size() ? in[pos] : -1; }
+  size_t write(uint8_t c) override { out.push_back(c); return 1; }
+  size_t write(const uint8_t* buf, size_t size) override {
+    out.insert(out.end(), buf, buf + size);
+    return size;
+  }
+};
+
+namespace SimTests {
+
+static bool testTimeline() {
+  Sim::Timeline tl;
+  std::string error;
+  const char* text =
+    "00:00 load 1.5\n"
+    "d1 12:00:30 press 400   # только второй день\n"
+    "08:00 power\n";
+  if (!Sim::BuildTimeline(text, 2, &tl, &error)) return false;
+  const uint64_t day = 86400ULL * 1000000ULL;
+  const uint64_t press = day + (12ULL * 3600 + 30) * 1000000ULL;
+  return tl.loads.size() == 2 && tl.powers.size() == 2 && tl.presses.size() == 1 &&
+         tl.loadAt(5) == 1.5f &&
+         !tl.pressedAt(press - 1) && tl.pressedAt(press) && !tl.pressedAt(press + 400000) &&
+         tl.nextPressAfter(0) == press &&
+         tl.nextPowerAfter(8ULL * 3600 * 1000000ULL) == day + 8ULL * 3600 * 1000000ULL;
+}
+
+static bool testTimelineErrors() {
+  Sim::Timeline tl;
+  std::string error;
+  return !Sim::BuildTimeline("25:00 load 1\n", 1, &tl, &error) &&
+         !Sim::BuildTimeline("10:00 jump\n", 1, &tl, &error) &&
+         !Sim::BuildTimeline("10:00 press\n", 1, &tl, &error) &&
+         error.find("line 1") != std::string::npos;
+}
+
+bool RunAll() {
+  return testTimeline() && testTimelineErrors();
+}
+
+}
+
+namespace StoreTests {
+
+// Чистые RTC-память и flash, как после подачи питания
+static void powerOn() {
+  Sim::resetRun(nullptr, UINT64_MAX);
+}
+
+static LogRecord sample(uint32_t i) {
+  return RtcLog_MakeRecord(3600 * i, 2.4f + 0.001f * i, 90, 0);
+}
+
+// Контрольное значение CRC-16/CCITT-FALSE; продолжение по частям — то же, что целиком
+static bool testCrc16() {
+  const char check[] = "123456789";
+  uint16_t part = Crc16_Update(CRC16_INIT, check, 4);
+  return Crc16_Update(CRC16_INIT, check, 9) == 0x29B1 &&
+         Crc16_Update(part, check + 4, 5) == 0x29B1 &&
+         Crc16_Update(CRC16_INIT, check, 0) == CRC16_INIT;
+}
+
+// Пробуждения копятся в RTC, во flash — одной пачкой при заполнении
+static bool testRtcLogBatching() {
+  powerOn();
+  if (RtcLog_Load()) return false;                 // RTC пуста — кольцо создаётся
+  for (uint32_t i = 0; i + 1 < RTCLOG_CAPACITY; i++) {
+    if (!RtcLog_Load()) return false;              // каждое пробуждение — заново из RTC
+    if (RtcLog_Append(sample(i))) return false;
+  }
+  if (Sim::shared->flashErases != 0) return false;
+  if (!RtcLog_Load() || RtcLog_Count() != RTCLOG_CAPACITY - 1) return false;
+  if (!RtcLog_Append(sample(RTCLOG_CAPACITY - 1))) return false;   // заполнено
+  History_Init();
+  if (!RtcLog_Flush() || RtcLog_Count() != 0) return false;
+
+  HistoryCursor c;
+  LogRecord rec;
+  uint32_t i = 0;
+  History_Open(&c, 0);
+  while (History_Next(&c, &rec)) {
+    if (rec.ts != 3600 * i || rec.weight_g != (int16_t)(2400 + i) || rec.battery != 90) {
+      return false;
+    }
+    i++;
+  }
+  return i == RTCLOG_CAPACITY && RtcLog_Load() && RtcLog_Count() == 0;
+}
+
+// Повреждённый блок RTC или другая версия формата — кольцо начинается заново
+static bool testRtcLogRecovery() {
+  powerOn();
+  RtcLog_Load();
+  for (uint32_t i = 0; i < 3; i++) RtcLog_Append(sample(i));
+  if (!RtcLog_Load() || RtcLog_Count() != 3) return false;
+
+  Sim::shared->rtcUser[RTCLOG_RTC_OFFSET + 4] ^= 0x00010000;   // бит в записи
+  if (RtcLog_Load() || RtcLog_Count() != 0) return false;
+  if (!RtcLog_Load()) return false;                // очищенное кольцо валидно
+
+  RtcLog_Append(sample(0));
+  ((uint8_t*)&Sim::shared->rtcUser[RTCLOG_RTC_OFFSET])[4] = RTCLOG_VERSION + 1;
+  if (RtcLog_Load() || RtcLog_Count() != 0) return false;
+
+  LogRecord err = RtcLog_MakeRecord(0, WEIGHT_ERROR_FLAG, 50, 0);
+  return err.weight_g == LOG_WEIGHT_ERROR && (err.flags & LOG_FLAG_ERROR);
+}
+
+// Кодек: любые записи восстанавливаются точно — скачки и откат времени,
+// ошибки HX711, смена заряда; повреждённый блок не декодируется
+static bool testCodecRoundTrip() {
+  LogRecord recs[200];
+  uint32_t ts = 1000;
+  for (uint32_t i = 0; i < 200; i++) {
+    ts += (i % 50 == 0) ? 77777 : (i % 37 == 0) ? (uint32_t)-5000 : 900 + (i % 3);
+    float kg = (i % 41 == 0) ? WEIGHT_ERROR_FLAG : 30.0f * ((i * 7919) % 2000) / 1000.0f - 3.0f;
+    recs[i] = RtcLog_MakeRecord(ts, kg, 100 - i / 3, (i % 13 == 0) ? LOG_FLAG_CLOCK_LOST : 0);
+  }
+  recs[199].ts = 0xFFFFFFFEUL;
+
+  uint8_t block[CODEC_HEADER_SIZE + 255];
+  uint32_t done = 0, blocks = 0;
+  while (done < 200) {
+    CodecEncoder e;
+    Codec_Begin(&e, block, sizeof(block));
+    uint32_t first = done;
+    while (done < 200 && Codec_Append(&e, recs[done])) done++;
+    size_t used = Codec_Finish(&e);
+    if (used == 0) return false;
+    blocks++;
+
+    CodecDecoder d;
+    LogRecord rec;
+    if (!Codec_Open(&d, block, used)) return false;
+    for (uint32_t i = first; i < done; i++) {
+      if (!Codec_Next(&d, &rec) || memcmp(&rec, &recs[i], sizeof(rec)) != 0) return false;
+    }
+    if (Codec_Next(&d, &rec)) return false;
+    block[used - 1] ^= 0x40;
+    if (Codec_Open(&d, block, used)) return false;
+  }
+
+  // Ровный ряд — 2 байта на запись
+  CodecEncoder e;
+  Codec_Begin(&e, block, sizeof(block));
+  for (uint32_t i = 0; i < 100; i++) Codec_Append(&e, sample(i));
+  return blocks > 1 && Codec_Finish(&e) <= CODEC_HEADER_SIZE + 4 + 2 * 100;
+}
+
+// Переход по кругу: старые сегменты вытесняются целиком, порядок и объём
+// сохраняются, после «перезагрузки» голова находится по заголовкам
+static bool testHistoryWrap() {
+  powerOn();
+  History_Format();
+  const uint32_t total = History_Capacity() * RTCLOG_CAPACITY * 2 + 123;
+  LogRecord batch[RTCLOG_CAPACITY];
+  for (uint32_t i = 0; i < total; i += RTCLOG_CAPACITY) {
+    uint32_t n = 0;
+    for (; n < RTCLOG_CAPACITY && i + n < total; n++) batch[n] = sample(i + n);
+    if (!History_Append(batch, n)) return false;
+  }
+  uint32_t count = History_Count();
+  if (count < (History_Capacity() - 1) * RTCLOG_CAPACITY || count > total) return false;
+
+  History_Init();
+  if (History_Count() != count) return false;
+
+  HistoryCursor c;
+  LogRecord rec;
+  uint32_t n = 0, expect = total - count;
+  History_Open(&c, 0);
+  while (History_Next(&c, &rec)) {
+    if (rec.ts != 3600 * expect++) return false;
+    n++;
+  }
+  if (n != count) return false;
+
+  // Чтение с момента: только новые записи
+  uint32_t from = 3600 * (total - 10);
+  History_Open(&c, from);
+  n = 0;
+  while (History_Next(&c, &rec)) n++;
+  return n == 10;
+}
+
+// Чужие данные в области FS — архив начинается с нуля, мусор не читается
+static bool testHistoryGarbage() {
+  powerOn();
+  for (uint32_t a = 0; a < 64 * 1024; a++) {
+    Sim::shared->flash[FS_PHYS_ADDR + a] = (uint8_t)(a * 37 + 11);
+  }
+  History_Init();
+  if (History_Count() != 0) return false;
+  LogRecord rec = sample(7);
+  if (!History_Append(&rec, 1) || History_Count() != 1) return false;
+  HistoryCursor c;
+  History_Open(&c, 0);
+  return History_Next(&c, &rec) && rec.ts == 3600 * 7 && !History_Next(&c, &rec);
+}
+
+static uint32_t countBuckets(RrdTier tier, uint32_t fromTs, RrdBucket* last) {
+  RrdCursor c;
+  uint32_t n = 0;
+  Rrd_Open(&c, tier, fromTs);
+  while (Rrd_Next(&c, last)) n++;
+  return n;
+}
+
+// Три часа по 10 образцов в минуту: каждый уровень — min/max/mean/count своих
+// интервалов; курсор выдаёт и ещё открытый
+static bool testRrdAggregation() {
+  powerOn();
+  Rrd_Format();
+  for (uint32_t m = 0; m < 180; m++) {
+    for (uint32_t k = 0; k < 10; k++) {
+      Rrd_AddSample(m * 60 + k * 6, 1.0f + 0.001f * m + ((k & 1) ? 0.002f : 0.0f));
+    }
+  }
+  Rrd_AddSample(200, WEIGHT_ERROR_FLAG);   // ошибка HX711 не учитывается
+
+  RrdCursor c;
+  RrdBucket b;
+  uint32_t n = 0;
+  Rrd_Open(&c, RRD_MINUTE, 0);
+  while (Rrd_Next(&c, &b)) {
+    if (b.slot != n || b.count != 10 || b.min_g != (int16_t)(1000 + n) ||
+        b.max_g != (int16_t)(1002 + n) || fabsf(b.mean_g - (1001.0f + n)) > 0.01f) {
+      return false;
+    }
+    n++;
+  }
+  if (n != 180) return false;
+
+  n = 0;
+  Rrd_Open(&c, RRD_HOUR, 0);
+  while (Rrd_Next(&c, &b)) {
+    if (b.slot != n || b.count != 600 || b.min_g != (int16_t)(1000 + 60 * n) ||
+        fabsf(b.mean_g - (1030.5f + 60 * n)) > 0.05f) {
+      return false;
+    }
+    n++;
+  }
+  return n == 3 && countBuckets(RRD_DAY, 0, &b) == 1 && b.count == 1800 &&
+         countBuckets(RRD_MINUTE, 170 * 60, &b) == 10;
+}
+
+// Открытые интервалы переживают deep sleep в RTC; закрытые раньше времени
+// перед выключением сливаются при чтении; повреждённый RTC-блок — с нуля
+static bool testRrdPersistence() {
+  powerOn();
+  Rrd_Format();
+  for (uint32_t t = 0; t < 1800; t += 300) Rrd_AddSample(t, 2.0f);
+  Rrd_Save();                                         // сон по таймеру
+  Rrd_Load();
+  for (uint32_t t = 1800; t < 3000; t += 300) Rrd_AddSample(t, 3.0f);
+  Rrd_Flush();                                        // выключение
+  Rrd_Load();
+  Rrd_AddSample(3300, 4.0f);
+
+  RrdBucket b;
+  if (countBuckets(RRD_HOUR, 0, &b) != 1 || b.count != 11 || b.min_g != 2000 ||
+      b.max_g != 4000 || fabsf(b.mean_g - 28000.0f / 11) > 0.1f) {
+    return false;
+  }
+  if (countBuckets(RRD_MINUTE, 0, &b) != 11) return false;
+
+  Rrd_Save();
+  Sim::shared->rtcUser[RRD_RTC_OFFSET + 1] ^= 0x100;  // бит в открытом часе
+  Rrd_Load();
+  return countBuckets(RRD_HOUR, 0, &b) == 1 && b.count == 10;
+}
+
+// Отчёт за последние 30 суток читает только свои интервалы суточного уровня
+static bool testRrdDailyQuery() {
+  powerOn();
+  Rrd_Format();
+  const uint32_t days = 400;
+  for (uint32_t h = 0; h < days * 24; h++) {
+    Rrd_AddSample(h * 3600, 1.0f + 0.01f * (h / 24));
+  }
+  RrdBucket b;
+  uint32_t now = days * 86400 - 1;
+  if (countBuckets(RRD_DAY, now - 29 * 86400, &b) != 30) return false;
+  if (b.slot != days - 1 || b.count != 24 || b.min_g != 4990) return false;
+  uint32_t hours = countBuckets(RRD_HOUR, 0, &b);   // старые часы вытеснены
+  return countBuckets(RRD_DAY, 0, &b) == days &&
+         hours >= RRD_HOUR_KEEP_DAYS * 24 && hours < days * 24;
+}
+
+// Раунд READ -> DATA... END; corruptAt >= 0 — испортить байт ответа в линии
+static bool bulkRound(BulkHost::Client* client, LoopStream* dev, uint16_t chunk, long corruptAt) {
+  client->roundDone = false;
+  dev->in = client->readRequest(chunk);
+  dev->pos = 0;
+  dev->out.clear();
+  if (BulkExport_Process(*dev) != 1) return false;
+  if (corruptAt >= 0 && corruptAt < (long)dev->out.size()) dev->out[corruptAt] ^= 0x5A;
+  client->feed(dev->out.data(), dev->out.size());
+  return client->roundDone;
+}
+
+static bool bulkSession(BulkHost::Client* client, LoopStream* dev, long corruptRound) {
+  dev->out.clear();
+  BulkExport_Hello(*dev);
+  client->feed(dev->out.data(), dev->out.size());
+  for (long round = 0; round < 100 && !client->finished(); round++) {
+    if (!bulkRound(client, dev, 37, round == corruptRound ? 1500 : -1)) return false;
+  }
+  return client->finished();
+}
+
+static void appendSamples(uint32_t from, uint32_t batches) {
+  LogRecord batch[RTCLOG_CAPACITY];
+  for (uint32_t b = 0; b < batches; b++) {
+    for (uint32_t n = 0; n < RTCLOG_CAPACITY; n++) {
+      batch[n] = sample(from + b * RTCLOG_CAPACITY + n);
+    }
+    History_Append(batch, RTCLOG_CAPACITY);
+  }
+}
+
+// Двоичная выгрузка: кадр, испорченный в линии, перезапрашивается с последней
+// принятой позиции; повторный сеанс с сохранённой позиции получает только новое
+static bool testBulkExportLoopback() {
+  powerOn();
+  History_Format();
+  appendSamples(0, 300);
+
+  LoopStream dev;
+  BulkHost::Client client;
+  if (!bulkSession(&client, &dev, 3)) return false;
+  if (client.badFrames == 0 || client.lost != 0 || client.blocks != 300) return false;
+
+  HistoryCursor c;
+  LogRecord rec;
+  size_t i = 0;
+  History_Open(&c, 0);
+  while (History_Next(&c, &rec)) {
+    if (i >= client.records.size() || memcmp(&rec, &client.records[i++], sizeof(rec)) != 0) {
+      return false;
+    }
+  }
+  if (i != client.records.size()) return false;
+
+  appendSamples(300 * RTCLOG_CAPACITY, 50);
+  BulkHost::Client resumed(client.next);
+  if (!bulkSession(&resumed, &dev, -1) || resumed.blocks != 50 ||
+      resumed.records.size() != 50 * RTCLOG_CAPACITY ||
+      resumed.records[0].ts != sample(300 * RTCLOG_CAPACITY).ts) {
+    return false;
+  }
+
+  dev.in = BulkHost::Client::byeRequest();
+  dev.pos = 0;
+  return BulkExport_Process(dev) == -1;
+}
+
+bool RunAll() {
+  if (!Sim::shared) Sim::init();
+  return testCrc16() && testRtcLogBatching() && testRtcLogRecovery() && testCodecRoundTrip() &&
+         testHistoryWrap() && testHistoryGarbage() &&
+         testRrdAggregation() && testRrdPersistence() && testRrdDailyQuery() &&
+         testBulkExportLoopback();
+}
+
+}
+
+namespace LogTests {
+
+static LogEntry entry(uint16_t id, uint8_t argc, uint32_t a0 = 0, uint32_t a1 = 0) {
+  LogEntry e = {};
+  e.id = id;
+  e.argc = argc;
+  e.args[0] = a0;
+  e.args[1] = a1;
+  return e;
+}
+
+static bool formatsAs(const LogEntry& e, const char* expected) {
+  char buf[LOG_LINE_MAX];
+  size_t len = Log_Format(e, buf, sizeof(buf));
+  if (strcmp(buf, expected) == 0 && len == strlen(expected)) return true;
+  printf("  log: \"%s\" != \"%s\"\n", buf, expected);
+  return false;
+}
+
+// Аргументы записи — как их кладёт LOG(): float битами, целые как есть
+static bool testLogFormat() {
+  char small[12];
+  LogEntry snap = entry(LOG_SNAPSHOT_RESTORED, 2, logArg(2.5f), logArg(-0.125));
+  Log_Format(entry(LOG_ACQ_INTERVAL, 1, 30000), small, sizeof(small));
+  return formatsAs(snap, "Snapshot: restored 2.500 kg (first -0.125)") &&
+         formatsAs(entry(LOG_EEPROM_LOADED, 2, logArg((uint8_t)3), logArg((uint8_t)200)),
+                   "EEPROM: loaded slot 3, seq=200") &&
+         formatsAs(entry(LOG_BTN_RELEASED, 1, logArg(12345UL)), "[BTN] released, elapsed=12345ms") &&
+         formatsAs(entry(LOG_EEPROM_LOADED, 1, 1), "EEPROM: loaded slot 1, seq=?") &&
+         formatsAs(entry(LOG_OVERLOAD, 0), "OVERLOAD!") &&
+         formatsAs(entry(0xFFFF, 0), "LOG #65535") &&
+         strncmp(small, "ACQ: ", 5) == 0 && strlen(small) == sizeof(small) - 1;
+}
+
+bool RunAll() {
+  return testLogFormat();
+}
+
+}
+
+namespace ConsoleTests {
+
+// Байты приходят кусками, как из UART: строка собирается за несколько loop()
+static std::string feed(LoopStream* dev, const char* const* chunks, size_t n) {
+  dev->out.clear();
+  for (size_t i = 0; i < n; i++) {
+    dev->in.assign(chunks[i], chunks[i] + strlen(chunks[i]));
+    dev->pos = 0;
+    Console_Poll(*dev);
+  }
+  return std::string(dev->out.begin(), dev->out.end());
+}
+
+static bool expect(LoopStream* dev, const char* input, const char* expected) {
+  std::string out = feed(dev, &input, 1);
+  if (out == expected) return true;
+  printf("  console: \"%s\" -> \"%s\"\n", input, out.c_str());
+  return false;
+}
+
+// Замер калибровки идёт в loop(): шаг раз в CAL_LOOP_DELAY_MS до ответа
+static std::string measure(LoopStream* dev) {
+  dev->out.clear();
+  for (uint32_t i = 0; i < 100000 && Console_IsMeasuring(); i++) {
+    Sim::advanceIn(Sim::CPU_IDLE, CAL_LOOP_DELAY_MS * 1000ULL);
+    Console_Measure(*dev);
+  }
+  return std::string(dev->out.begin(), dev->out.end());
+}
+
+static bool testConsoleSetGet() {
+  LoopStream dev;
+  const char* chunks[] = { "set bright", "ness_level 1\r", "\nget brightness_level\n" };
+  bool ok = feed(&dev, chunks, 3) == "OK brightness_level=1\nbrightness_level=1\n" &&
+            savedData.brightness_level == 1 &&
+            Console_TakeSettingsChanged() && !Console_TakeSettingsChanged();
+  ok = ok && expect(&dev, "set cal_factor 1234.5\n", "OK cal_factor=1234.5000\n") &&
+       Scale_GetCalFactor() == 1234.5f &&
+       expect(&dev, "set tare_offset -0x100\n", "OK tare_offset=-256\n") &&
+       Scale_GetOffset() == -256 &&
+       expect(&dev, "set ema 0.5\nset samples 5\n", "OK ema=0.500\nOK samples=5\n") &&
+       Scale_GetEmaAlpha() == 0.5f && Scale_GetSamplesPerRead() == 5 &&
+       expect(&dev, "set rate 1000\n", "OK rate=1000\n") &&
+       !Scale_GetAdaptiveAcquisition() && Scale_GetIdleIntervalMs() == 1000 &&
+       expect(&dev, "set rate auto\n", "OK rate=auto\n") && Scale_GetAdaptiveAcquisition();
+  Scale_SetEmaAlpha(WEIGHT_EMA_ALPHA);
+  Scale_SetSamplesPerRead(HX711_SAMPLES_READ);
+  return ok;
+}
+
+static bool testConsoleErrors() {
+  LoopStream dev;
+  char longLine[CONSOLE_LINE_MAX + 10];
+  memset(longLine, 'a', sizeof(longLine) - 2);
+  longLine[sizeof(longLine) - 2] = '\n';
+  longLine[sizeof(longLine) - 1] = '\0';
+  uint8_t before = savedData.brightness_level;
+  return expect(&dev, "set brightness_level 7\n", "ERR bad value\n") &&
+         savedData.brightness_level == before &&
+         expect(&dev, "set cal_factor 12x\n", "ERR bad value\n") &&
+         expect(&dev, "set crc16 1\n", "ERR read-only\n") &&
+         expect(&dev, "set nothing 1\n", "ERR unknown field\n") &&
+         expect(&dev, "set auto_zero_on\n", "ERR usage: set <field> <value>\n") &&
+         expect(&dev, "frob\n\r\n", "ERR unknown command\n") &&
+         expect(&dev, longLine, "ERR line too long\n") &&
+         expect(&dev, "gex\b\bet units_mode\n", "units_mode=0\n") &&
+         expect(&dev, "undo\n", "ERR no undo\n");
+}
+
+// Калибровка по трём массам на модели HX711: коэффициент модели и таблица
+// поправки в EEPROM; ручной cal_factor поправку отключает
+static bool testConsoleCal() {
+  Sim::Timeline tl;
+  std::string error;
+  if (!Sim::BuildTimeline("00:00 load 0\n00:01 load 1.0\n00:02 load 2.5\n00:03 load 4.0\n",
+                          1, &tl, &error)) {
+    return false;
+  }
+  Sim::resetRun(&tl, UINT64_MAX);
+  Memory_Init();
+  Scale_Begin();
+  Scale_Init();
+  LoopStream dev;
+  if (!expect(&dev, "tare\n", "OK\n")) return false;
+  const char* adds[] = { "cal add 1\n", "cal add 2.5\n", "cal add 4\n" };
+  for (uint8_t i = 0; i < 3; i++) {
+    Sim::advanceIn(Sim::CPU_IDLE, 60000000ULL * (i + 1) + 5000000ULL - Sim::nowUs());
+    if (!expect(&dev, adds[i], "")) return false;
+    std::string out = measure(&dev);
+    if (out.compare(0, 7, "OK cal ") != 0) {
+      printf("  console: %s", out.c_str());
+      return false;
+    }
+  }
+  const char* fit = "cal fit\n";
+  std::string out = feed(&dev, &fit, 1);
+  bool ok = out.compare(0, 15, "OK cal_factor=2") == 0 &&
+            fabsf(savedData.cal_factor - SIM_HX711_COUNTS_PER_KG) < 5.0f &&
+            savedData.lin_span > 3.9f && savedData.lin_zero == Scale_GetOffset();
+  if (!ok) printf("  console: %s", out.c_str());
+  ok = ok && expect(&dev, "set cal_factor 2280\n", "OK cal_factor=2280.0000\n") &&
+       savedData.lin_span == 0.0f &&
+       expect(&dev, "cal clear\ncal fit\n", "OK\nERR fit\n");
+  return ok;
+}
+
+// cal auto запущен за 2 с до установки груза: скачок сбрасывает накопление,
+// в среднее попадают только отсчёты с грузом
+static bool testConsoleCalAuto() {
+  Sim::Timeline tl;
+  std::string error;
+  if (!Sim::BuildTimeline("00:00 load 0\n00:01 load 1.0\n", 1, &tl, &error)) return false;
+  Sim::resetRun(&tl, UINT64_MAX);
+  Memory_Init();
+  Scale_Begin();
+  Scale_Init();
+  LoopStream dev;
+  if (!expect(&dev, "tare\n", "OK\n")) return false;
+  Sim::advanceIn(Sim::CPU_IDLE, 58000000ULL - Sim::nowUs());
+  if (!expect(&dev, "cal auto 1\n", "") || !Console_IsMeasuring() ||
+      !expect(&dev, "get units_mode\n", "ERR busy\n")) {
+    return false;
+  }
+  std::string out = measure(&dev);
+  unsigned n = 0;
+  const char* np = strstr(out.c_str(), " n=");
+  if (np != nullptr) n = (unsigned)atoi(np + 3);
+  bool ok = out.compare(0, 15, "OK cal_factor=2") == 0 &&
+            fabsf(savedData.cal_factor - SIM_HX711_COUNTS_PER_KG) < 2.0f &&
+            savedData.lin_span == 0.0f && n >= CAL_AUTO_MIN_SAMPLES && n < CAL_AUTO_MAX_SAMPLES &&
+            !Console_IsMeasuring();
+  if (!ok) printf("  console: %s", out.c_str());
+  return ok && expect(&dev, "cal auto 0\n", "ERR usage: cal auto <kg>\n");
+}
+
+// Выгрузка h идёт по CONSOLE_CSV_RECORDS строк за Console_Poll: груз меняется
+// на 15-й секунде посреди выгрузки, и к последней десятой архива вес уже
+// новый; команды до конца выгрузки — ERR busy. Идёт в дочернем процессе, как
+// загрузки прошивки: фильтры и журнал этого взвешивания не переходят в следующие тесты.
+static void exportWhileWeighing() {
+  Memory_Init();
+  savedData.cal_factor = SIM_HX711_COUNTS_PER_KG;
+  History_Format();
+  RtcLog_Load();
+  const uint32_t records = 2000;
+  for (uint32_t i = 0; i < records; i++) {
+    if (RtcLog_Append(RtcLog_MakeRecord(60 * (i + 1), 1.0f, 80, 0))) RtcLog_Flush();
+  }
+  Scale_Begin();
+  Scale_Init();
+  Scale_ApplyCalibration();
+  LoopStream dev;
+  if (!expect(&dev, "tare\n", "OK\n")) _exit(1);
+  const char* h = "h\n";
+  std::string out = feed(&dev, &h, 1);
+  uint64_t startedUs = Sim::nowUs();
+  size_t rows = std::count(out.begin(), out.end(), '\n');
+  bool checked = false, busy = false;
+  float during = 0.0f;
+  for (uint32_t i = 0; i < 100000 && Console_IsBusy(); i++) {
+    Sim::advanceIn(Sim::CPU_IDLE, CAL_LOOP_DELAY_MS * 1000ULL);
+    Scale_Update();
+    // На 9/10 архива: груз давно сменился, выгрузка ещё идёт
+    const char* input = "";
+    if (!checked && rows >= records * 9 / 10) {
+      input = "get units_mode\n";
+      during = Scale_GetWeight();
+      checked = true;
+    }
+    std::string step = feed(&dev, &input, 1);
+    if (*input != '\0') busy = step.find("ERR busy\n") != std::string::npos;
+    rows += std::count(step.begin(), step.end(), '\n');
+    out += step;
+  }
+  char footer[32];
+  snprintf(footer, sizeof(footer), "# %lu records\n", (unsigned long)records);
+  bool ok = startedUs < 15000000ULL && busy && fabsf(during - 2.0f) < 0.05f && !Console_IsBusy() &&
+            out.compare(0, 26, "ts,weight_kg,battery,flags") == 0 &&
+            out.size() > strlen(footer) &&
+            out.compare(out.size() - strlen(footer), strlen(footer), footer) == 0 &&
+            rows == records + 3;
+  const char* get = "get units_mode\n";
+  if (!ok || feed(&dev, &get, 1).compare(0, 11, "units_mode=") != 0) {
+    printf("  export: busy %d, weight %.3f, %zu lines\n", busy, during, rows);
+    fflush(stdout);
+    _exit(1);
+  }
+}
+
+static bool testConsoleExportKeepsWeighing() {
+  Sim::Timeline tl;
+  std::string error;
+  if (!Sim::BuildTimeline("00:00 load 0\n00:00:15 load 2.0\n", 1, &tl, &error)) return false;
+  Sim::resetRun(&tl, UINT64_MAX);
+  Sim::runInChild(exportWhileWeighing);
+  return Sim::shared->outcome == Sim::OUT_NONE;
+}
+
+// Кадр SSD1306 статический: Display_Init не берёт кучу (заглушка begin()
+// выделяет его там, как библиотека, только без заданного буфера)
+static bool testConsoleMem() {
+  uint32_t heap = ESP.getFreeHeap();
+  Display_Init();
+  if (display.getBuffer() == nullptr || ESP.getFreeHeap() != heap) {
+    printf("  mem: frame on heap, free %u -> %u\n", heap, ESP.getFreeHeap());
+    return false;
+  }
+  char expected[200];
+  snprintf(expected, sizeof(expected),
+           "ram budget=%u buffers=%u reserve=%u frame=%u\n"
+           "heap free=%u min=%u max_block=%u\nstack free_min=%u\n",
+           RAM_STATIC_BUDGET, RAM_BUFFERS_BYTES, RAM_RESERVE_HISTORY + RAM_RESERVE_TELEMETRY,
+           RAM_FRAME_BYTES, heap, heap, ESP.getMaxFreeBlockSize(), ESP.getFreeContStack());
+  LoopStream dev;
+  return expect(&dev, "mem\n", expected) && RamStats_MinFreeHeap() == heap;
+}
+
+bool RunAll() {
+  if (!Sim::shared) Sim::init();
+  Sim::resetRun(nullptr, UINT64_MAX);
+  Memory_Init();
+  return testConsoleSetGet() && testConsoleErrors() && testConsoleCal() &&
+         testConsoleCalAuto() && testConsoleExportKeepsWeighing() && testConsoleMem();
+}
+
+}
+
+namespace CalFitTests {
+
+// Модельный датчик: прогиб к краю диапазона, отсчёты на кг как DEFAULT_CALIBRATION
+static float sensorCounts(float kg) {
+  return DEFAULT_CALIBRATION * (kg + 0.015f * kg * kg - 0.004f * kg * kg * kg);
+}
+
+// Наибольшая ошибка по диапазону 0..maxKg с поправкой и без (только cal_factor)
+static void sweep(const CalFitResult& fit, float maxKg, float* corrected, float* linear) {
+  *corrected = 0.0f;
+  *linear = 0.0f;
+  for (int g = 0; g <= (int)(maxKg * 1000.0f); g += 10) {
+    float kg = g / 1000.0f;
+    float u = sensorCounts(kg) / fit.calFactor;
+    float w = CalFit_Apply(fit.knots, CAL_LIN_SEGMENTS / fit.span, u);
+    *corrected = fmaxf(*corrected, fabsf(w - kg));
+    *linear = fmaxf(*linear, fabsf(u - kg));
+  }
+}
+
+// Шесть эталонных масс с шумом ±1,5 отсчёта: кубическая поправка снимает
+// нелинейность на порядок
+static bool testCalFitNonlinear() {
+  const float masses[] = { 0.5f, 1.0f, 2.0f, 3.0f, 4.0f, WEIGHT_OVERLOAD_KG };
+  CalPoint pts[6];
+  for (uint8_t i = 0; i < 6; i++) {
+    pts[i].kg = masses[i];
+    pts[i].counts = sensorCounts(masses[i]) + ((i & 1) ? 1.5f : -1.5f);
+  }
+  CalFitResult fit;
+  if (!CalFit_Solve(pts, 6, &fit) || fit.degree != CAL_FIT_DEGREE) return false;
+  float corrected, linear;
+  sweep(fit, WEIGHT_OVERLOAD_KG, &corrected, &linear);
+  if (corrected > 0.005f || linear < 0.05f || fit.maxErrorKg > 0.003f) {
+    printf("  calfit: %.1f g corrected, %.1f g linear\n", corrected * 1000.0f, linear * 1000.0f);
+    return false;
+  }
+
+  // Одна масса — только cal_factor: точное попадание в эталон
+  if (!CalFit_Solve(pts + 3, 1, &fit) || fit.degree != 1 || fit.maxErrorKg > 1e-4f) return false;
+  return fabsf(CalFit_Apply(fit.knots, CAL_LIN_SEGMENTS / fit.span, pts[3].counts / fit.calFactor) -
+               pts[3].kg) < 1e-4f;
+}
+
+static bool testCalFitRejects() {
+  CalFitResult fit;
+  CalPoint zero[] = { { 1000.0f, 0.0f } };
+  CalPoint falling[] = { { -2280.0f, 1.0f }, { -4560.0f, 2.0f } };
+  CalPoint flat[] = { { 0.5f, 1.0f } };   // коэффициент ниже CAL_FACTOR_MIN
+  return !CalFit_Solve(zero, 0, &fit) && !CalFit_Solve(zero, 1, &fit) &&
+         !CalFit_Solve(falling, 2, &fit) && !CalFit_Solve(flat, 1, &fit);
+}
+
+// Онлайн-среднее и СКО на отсчётах порядка 10^5 совпадают с двухпроходным расчётом
+static bool testCalSettle() {
+  CalSettle st;
+  CalSettle_Reset(&st);
+  if (CalSettle_StdDev(&st) != 0.0f || CalSettle_StdErr(&st) != 0.0f) return false;
+  long v[64];
+  double sum = 0.0;
+  for (int i = 0; i < 64; i++) {
+    v[i] = 84000L + 2280L * 4 + ((i * 37) % 11) - 5;
+    sum += v[i];
+    CalSettle_Add(&st, v[i]);
+  }
+  double mean = sum / 64, m2 = 0.0;
+  for (int i = 0; i < 64; i++) m2 += (v[i] - mean) * (v[i] - mean);
+  double sd = sqrt(m2 / 63);
+  return st.n == 64 && fabs(st.mean - mean) < 1e-9 &&
+         fabsf(CalSettle_StdDev(&st) - (float)sd) < 1e-4f &&
+         fabsf(CalSettle_StdErr(&st) - (float)(sd / 8.0)) < 1e-4f;
+}
+
+bool RunAll() {
+  return testCalFitNonlinear() && testCalFitRejects() && testCalSettle();
+}
+
+}
+
+namespace PipelineTests {
+
+// Пороги — улья, явно: тесты не зависят от профиля сборки (MINI_SCALE_PROFILE)
+typedef ScalePipeline<3, 8, float, HiveProfile>   Pipeline38;
+typedef ScalePipeline<3, 6, float, HiveProfile>   Pipeline36;
+typedef ScalePipeline<5, 16, double, HiveProfile> Pipeline516d;
+
+// Одиночный выброс АЦП не доходит до EMA; ровный вес — стабилен и заморожен
+static bool testPipelineSpike() {
+  Pipeline38 p;
+  for (int i = 0; i < 10; i++) p.push(1.0f);
+  if (!p.isStable() || !p.isFrozen() || p.displayWeight() != 1.0f) return false;
+  p.push(3.0f);
+  if (p.filtered() != 1.0f || !p.isStable() || p.isOverloaded()) return false;
+  p.push(1.2f);
+  return !p.isStable() && !p.isFrozen() && p.trend() == 1 && p.displayWeight() > 1.05f;
+}
+
+// Экземпляры не делят состояния; окно не степени двойки заворачивается так же
+static bool testPipelineInstances() {
+  Pipeline38 a;
+  Pipeline36 b;
+  Pipeline516d c(0.1f);
+  for (int i = 0; i < 5; i++) {
+    a.push(0.5f);
+    b.push(2.0f + 0.1f * i);
+    c.push(HiveProfile::overloadKg + 1.0);
+  }
+  if (!a.isStable() || b.isStable() || !c.isOverloaded() || a.isOverloaded()) return false;
+  for (int i = 0; i < 15; i++) {
+    a.push(0.5f);
+    b.push(2.4f);
+  }
+  if (!a.isStable() || !b.isStable() || fabsf(b.filtered() - 2.4f) > 0.01f) return false;
+  // Медиана из пяти: два выброса подряд отсекаются
+  c.reset();
+  for (int i = 0; i < 8; i++) c.push(1.0);
+  c.push(4.0);
+  c.push(4.0);
+  return fabs(c.filtered() - 1.0) < 1e-9 && c.medianFull();
+}
+
+// Снимок состояния: восстановленный экземпляр продолжает ровно так же
+static bool testPipelineState() {
+  Pipeline38 a, b;
+  for (int i = 0; i < 11; i++) a.push(2.0f + 0.01f * (i % 3));
+  Pipeline38::State st;
+  a.save(&st);
+  if (!Pipeline38::valid(st)) return false;
+  b.restore(st);
+  for (int i = 0; i < 5; i++) {
+    float w = 2.0f + 0.07f * i;
+    a.push(w);
+    b.push(w);
+    if (a.filtered() != b.filtered() || a.displayWeight() != b.displayWeight() ||
+        a.isStable() != b.isStable() || a.trend() != b.trend()) {
+      return false;
+    }
+  }
+  st.historyIdx = 8;
+  return !Pipeline38::valid(st);
+}
+
+// Профили в одной сборке: ступень 12 г — улей её не показывает (заморозка
+// 20 г) и остаётся стабильным, кухня и лаборатория выходят из заморозки
+// и показывают её со своим шагом
+static bool testPipelineProfiles() {
+  ProfilePipeline<HiveProfile> hive;
+  ProfilePipeline<KitchenProfile> kitchen;
+  ProfilePipeline<LabProfile> lab;
+  for (int i = 0; i < 40; i++) {
+    hive.push(1.0f);
+    kitchen.push(1.0f);
+    lab.push(1.0f);
+  }
+  if (!hive.isFrozen() || !kitchen.isFrozen() || !lab.isFrozen()) return false;
+  for (int i = 0; i < 2; i++) {
+    hive.push(1.012f);
+    kitchen.push(1.012f);
+    lab.push(1.012f);
+  }
+  if (!hive.isStable() || kitchen.isStable()) return false;
+  for (int i = 0; i < 100; i++) {
+    hive.push(1.012f);
+    kitchen.push(1.012f);
+    lab.push(1.012f);
+  }
+  return hive.displayWeight() == 1.0f && kitchen.isStable() && lab.isStable() &&
+         fabsf(kitchen.displayWeight() - 1.012f) < 1e-5f &&
+         fabsf(lab.displayWeight() - 1.012f) < 1e-5f;
+}
+
+bool RunAll() {
+  return testPipelineSpike() && testPipelineInstances() && testPipelineState() &&
+         testPipelineProfiles();
+}
+
+}
+
+// Калибровка весов в EEPROM как у модели HX711 симулятора
+static void provisionSim() {
+  Memory_Init();
+  savedData.cal_factor = SIM_HX711_COUNTS_PER_KG;
+  savedData.tare_offset = SIM_HX711_ZERO_COUNTS;
+  savedData.backup_offset = SIM_HX711_ZERO_COUNTS;
+  Memory_ForceSave();
+}
+
+// Одна загрузка прошивки от включения питания по сценарию до endUs; результат
+// в EEPROM читается в savedData. frames — кадров дисплея за загрузку.
+static Sim::Outcome runSession(const char* scenario, uint64_t endUs, uint32_t* frames = nullptr) {
+  Sim::Timeline tl;
+  std::string error;
+  if (!Sim::BuildTimeline(scenario, 1, &tl, &error)) return Sim::OUT_NONE;
+  // Батарея заряжена: иначе прошивка сразу уходит в deep sleep по критическому заряду
+  Sim::shared->batteryCapacityMah = BAT_CAPACITY_MAH;
+  Sim::shared->batteryStartSoc = SIM_BAT_START_SOC;
+  Sim::resetRun(&tl, endUs);
+  Sim::runInChild(provisionSim);
+  Sim::clearStats();
+  Sim::Outcome outcome = Sim::runBoot(REASON_DEFAULT_RST);
+  if (frames) *frames = Sim::shared->frames;
+  Memory_Init();
+  return outcome;
+}
+
+namespace CalibrationTests {
+
+// Кнопка входа, +10, шесть удержаний до SAVE, сохранение. Кадры — по
+// конверсиям (10 в с) и нажатиям, а не на каждом шаге loop()
+static bool testCalibrationManual() {
+  const char* scenario =
+    "00:00 load 1.0\n"
+    "00:00:00 press 2000\n"
+    "00:00:03 press 150\n"
+    "00:00:05 press 1000\n00:00:07 press 1000\n00:00:09 press 1000\n"
+    "00:00:11 press 1000\n00:00:13 press 1000\n00:00:15 press 1000\n"
+    "00:00:17 press 150\n";
+  uint32_t frames = 0;
+  if (runSession(scenario, 30000000ULL, &frames) != Sim::OUT_RESTART) return false;
+  bool ok = savedData.cal_factor == SIM_HX711_COUNTS_PER_KG + 10.0f && savedData.lin_span == 0.0f &&
+            frames > 150 && frames < 250;
+  if (!ok) printf("  calibration: factor %.1f, %u frames\n", savedData.cal_factor, frames);
+  return ok;
+}
+
+// AUTO: удержаниями до режима 8, ноль, эталон 1 кг по умолчанию, замер с грузом, SAVE
+static bool testCalibrationAuto() {
+  const char* scenario =
+    "00:00 load 0\n"
+    "00:00:00 press 2000\n"
+    "00:00:03 press 1000\n00:00:05 press 1000\n00:00:07 press 1000\n00:00:09 press 1000\n"
+    "00:00:11 press 1000\n00:00:13 press 1000\n00:00:15 press 1000\n"
+    "00:00:17 press 150\n"
+    "00:00:19 press 150\n"
+    "00:00:35 press 1000\n"
+    "00:00:40 load 1.0\n"
+    "00:00:45 press 150\n"
+    "00:01:00 press 150\n";
+  if (runSession(scenario, 70000000ULL) != Sim::OUT_RESTART) return false;
+  bool ok = fabsf(savedData.cal_factor - SIM_HX711_COUNTS_PER_KG) < 2.0f &&
+            labs(savedData.tare_offset - SIM_HX711_ZERO_COUNTS) < 5;
+  if (!ok) printf("  calibration: factor %.2f offset %ld\n", savedData.cal_factor, savedData.tare_offset);
+  return ok;
+}
+
+bool RunAll() {
+  if (!Sim::shared) Sim::init();
+  return testCalibrationManual() && testCalibrationAuto();
+}
+
+}
+
+namespace DisplayTests {
+
+// Знаки веса — по шагу показания профиля сборки; не влезающая в ширину
+// строка — мелким шрифтом
+static bool showMain(float kg, bool grams, const char* expected) {
+  Display_ShowMain(kg, 0.0f, 3.9f, 80, true, false, 0, false, false, false, 0, grams);
+  if (strncmp(display.text(), expected, strlen(expected)) == 0) return true;
+  printf("  display: %.4f -> \"%s\"\n", kg, display.text());
+  return false;
+}
+
+static bool testDisplayDecimals() {
+  Sim::resetRun(nullptr, UINT64_MAX);
+  Display_Init();
+#if MINI_SCALE_PROFILE == PROFILE_KITCHEN
+  return showMain(1.234f, false, "=1.234 kg") && showMain(1.234f, true, "=1234 g");
+#elif MINI_SCALE_PROFILE == PROFILE_LAB
+  return showMain(1.2345f, false, "=1.2345 kg") && showMain(1.2345f, true, "=1234.5 g");
+#else
+  return showMain(1.23f, false, "=1.23 kg") && showMain(1.23f, true, "=1230 g");
+#endif
+}
+
+bool RunAll() {
+  if (!Sim::shared) Sim::init();
+  return testDisplayDecimals();
+}
+
+}
+
+namespace BatteryTests {
+
+// Автовыключение отключено: сеанс заканчивается только по заряду батареи
+static void provisionNoAutoOff() {
+  provisionSim();
+  savedData.auto_off_mode = AUTO_OFF_VALUES_COUNT - 1;
+  Memory_ForceSave();
+}
+
+// Груз стоит, опрос дошёл до ACQ_INTERVAL_3_MS, батарея садится во время снов.
+// millis() во сне стоит: по нему чтения батареи шли бы раз в несколько минут
+// и батарея села бы до нуля без выключения; по Scale_Millis — выключение
+// deepSleep(0), пока заряд ещё есть.
+static bool testCriticalDuringNaps() {
+  Sim::Timeline tl;
+  std::string error;
+  if (!Sim::BuildTimeline("00:00 load 2.0\n", 1, &tl, &error)) return false;
+  Sim::shared->batteryCapacityMah = 10.0;
+  Sim::shared->batteryStartSoc = 0.15;
+  Sim::resetRun(&tl, 7200ULL * 1000000ULL);
+  Sim::runInChild(provisionNoAutoOff);
+  Sim::clearStats();
+  Sim::Outcome outcome = Sim::runBoot(REASON_DEFAULT_RST);
+  double soc = Sim::socNow();
+  uint64_t sleptUs = Sim::shared->cpuStateUs[Sim::CPU_LIGHT_SLEEP];
+  bool ok = outcome == Sim::OUT_DEEP_SLEEP && Sim::shared->sleepUs == 0 && soc > 0.0 &&
+            sleptUs > Sim::nowUs() / 10 * 9;
+  if (!ok) {
+    printf("  battery: outcome %d at %.1f s, soc %.4f, light sleep %.1f s\n", outcome,
+           Sim::nowUs() / 1e6, soc, sleptUs / 1e6);
+  }
+  return ok;
+}
+
+bool RunAll() {
+  if (!Sim::shared) Sim::init();
+  return testCriticalDuringNaps();
+}
+
+}
+
+namespace SettingsTests {
+
+// Меню открыто с 8-й по 26-ю секунду, груз меняется на 10-й: сохранённый по
+// SAVE last_weight — уже новый, т.е. взвешивание под меню не останавливалось.
+// Удержаниями до Units, щелчок — граммы, удержаниями до последнего пункта и SAVE.
+static bool testSettingsKeepWeighing() {
+  const char* scenario =
+    "00:00 load 2.0\n"
+    "00:00:05 press 2500\n"
+    "00:00:08 press 300\n"
+    "00:00:10 load 3.0\n"
+    "00:00:12 press 1000\n00:00:14 press 1000\n00:00:16 press 1000\n00:00:18 press 1000\n"
+    "00:00:20 press 150\n"
+    "00:00:22 press 1000\n00:00:24 press 1000\n"
+    "00:00:26 press 1000\n";
+  if (runSession(scenario, 35000000ULL) != Sim::OUT_END) return false;
+  bool ok = savedData.units_mode == 1 && savedData.auto_off_mode == 1 &&
+            fabsf(savedData.last_weight - 3.0f) < 0.05f;
+  if (!ok) printf("  settings: units %u, last_weight %.3f\n", savedData.units_mode, savedData.last_weight);
+  return ok;
+}
+
+bool RunAll() {
+  if (!Sim::shared) Sim::init();
+  return testSettingsKeepWeighing();
+}
+
+}
+
+namespace UplinkTests {
+
+// Радио и TCP без модели WiFi: запрос сразу уходит серверу-двойнику
+class FakeTransport : public UplinkTransport {
+public:
+  UplinkHost::Server server;
+  bool wifiOk = true;
+  bool serverOk = true;
+  bool dropResponse = false;   // Сервер принял, ответ потерян
+  uint32_t radioOns = 0;
+  void radioBegin() override { radioOns++; }
+  bool radioReady() override { return wifiOk; }
+  bool connect() override {
+    server.reset();
+    pos_ = 0;
+    return serverOk;
+  }
+  void stop() override {}
+  void radioOff() override {}
+  int available() override {
+    return dropResponse ? 0 : (int)(server.response.size() - pos_);
+  }
+  int read() override { return available() > 0 ? (uint8_t)server.response[pos_++] : -1; }
+  int peek() override { return available() > 0 ? (uint8_t)server.response[pos_] : -1; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size) override {
+    server.feed(buf, size);
+    return size;
+  }
+private:
+  size_t pos_ = 0;
+};
+
+static LogRecord sample(uint32_t i) {
+  return RtcLog_MakeRecord(900 * (i + 1), 2.4f + 0.001f * i, 80, 0);
+}
+
+// Архив пуст, позиция выгрузки — на его конце, RF на пробуждении включён
+static void powerOn() {
+  Sim::resetRun(nullptr, UINT64_MAX);
+  History_Format();
+  RtcLog_Load();
+  Uplink_Reset();
+  Uplink_SetEnabled(true);
+}
+
+static void record(uint32_t i) {
+  RtcLog_Load();
+  if (RtcLog_Append(sample(i))) RtcLog_Flush();
+}
+
+static bool delivered(const FakeTransport& t, uint32_t from, uint32_t to) {
+  if (t.server.records.size() != to - from) return false;
+  for (uint32_t i = from; i < to; i++) {
+    if (t.server.records[i - from].ts != sample(i).ts) return false;
+  }
+  return true;
+}
+
+// Одна пачка на окно: блоки flash и ещё не сброшенное из RTC, без повторов
+static bool testUplinkBatch() {
+  powerOn();
+  FakeTransport t;
+  for (uint32_t i = 0; i < RTCLOG_CAPACITY + 5; i++) record(i);
+  uint32_t now = sample(RTCLOG_CAPACITY + 4).ts;
+  if (Uplink_PrepareSleep(now) != WAKE_RF_DEFAULT) return false;
+  if (Uplink_Run(t, now) != UPLINK_OK || t.radioOns != 1) return false;
+  if (!delivered(t, 0, RTCLOG_CAPACITY + 5) || RtcLog_Count() != 0) return false;
+  if (t.server.path != UPLINK_PATH || t.server.device != "A1B2C3") return false;
+
+  UplinkStats st;
+  Uplink_GetStats(&st);
+  uint32_t window = (now / UPLINK_WINDOW_SEC + 1) * UPLINK_WINDOW_SEC;
+  if (st.samples != RTCLOG_CAPACITY + 5 || st.nextTs != window) return false;
+
+  // До окна радио не включается; RF на пробуждении — только к окну
+  record(RTCLOG_CAPACITY + 5);
+  if (Uplink_Run(t, now + 60) != UPLINK_NOT_DUE || t.radioOns != 1) return false;
+  if (Uplink_PrepareSleep(window - 1) != WAKE_RF_DISABLED) return false;
+  if (Uplink_PrepareSleep(window) != WAKE_RF_DEFAULT) return false;
+  return Uplink_Run(t, window) == UPLINK_OK && t.radioOns == 2 &&
+         delivered(t, 0, RTCLOG_CAPACITY + 6) && t.server.duplicates == 0;
+}
+
+// Неудачи: пауза растёт вдвое до окна, пачка сохраняется; потерянный ответ
+// даёт повтор, который сервер отбрасывает по ts
+static bool testUplinkBackoff() {
+  powerOn();
+  FakeTransport t;
+  record(0);
+  record(1);
+  uint32_t now = 100000;
+  Uplink_PrepareSleep(now);
+  UplinkStats st;
+
+  t.server.failStatus = 500;
+  if (Uplink_Run(t, now) != UPLINK_HTTP_ERROR) return false;
+  Uplink_GetStats(&st);
+  if (st.nextTs != now + UPLINK_RETRY_MIN_SEC || st.failures != 1) return false;
+  now = st.nextTs;
+  t.wifiOk = false;
+  if (Uplink_Run(t, now) != UPLINK_NO_WIFI) return false;
+  Uplink_GetStats(&st);
+  if (st.nextTs != now + 2 * UPLINK_RETRY_MIN_SEC) return false;
+  for (uint8_t i = 0; i < 6; i++) {
+    now = st.nextTs;
+    Uplink_Run(t, now);
+    Uplink_GetStats(&st);
+  }
+  if (st.nextTs != now + UPLINK_WINDOW_SEC || st.samples != 0) return false;
+
+  // Пробуждение без RF: попытка переносится, радио не трогаем
+  if (Uplink_PrepareSleep(st.nextTs - 1) != WAKE_RF_DISABLED) return false;
+  uint32_t ons = t.radioOns;
+  if (Uplink_Run(t, st.nextTs) != UPLINK_NO_RADIO || t.radioOns != ons) return false;
+
+  now = st.nextTs;
+  Uplink_PrepareSleep(now);
+  t.wifiOk = true;
+  t.server.failStatus = 0;
+  t.dropResponse = true;
+  if (Uplink_Run(t, now) != UPLINK_HTTP_ERROR || !delivered(t, 0, 2)) return false;
+  t.dropResponse = false;
+  record(2);
+  Uplink_GetStats(&st);
+  if (Uplink_Run(t, st.nextTs) != UPLINK_OK) return false;
+  Uplink_GetStats(&st);
+  return delivered(t, 0, 3) && t.server.duplicates == 2 && st.samples == 3 && st.failures == 0;
+}
+
+// Больше UPLINK_MAX_BLOCKS блоков — остаток следующим запросом сразу
+static bool testUplinkLimit() {
+  powerOn();
+  FakeTransport t;
+  uint32_t n = RTCLOG_CAPACITY * (UPLINK_MAX_BLOCKS + 3);
+  for (uint32_t i = 0; i < n; i++) record(i);
+  uint32_t now = sample(n).ts;
+  Uplink_PrepareSleep(now);
+  if (Uplink_Run(t, now) != UPLINK_OK || t.server.blocks != UPLINK_MAX_BLOCKS) return false;
+  UplinkStats st;
+  Uplink_GetStats(&st);
+  if (st.nextTs != now || Uplink_PrepareSleep(now) != WAKE_RF_DEFAULT) return false;
+  return Uplink_Run(t, now) == UPLINK_OK && delivered(t, 0, n) && t.radioOns == 2;
+}
+
+bool RunAll() {
+  if (!Sim::shared) Sim::init();
+  bool ok = testUplinkBatch() && testUplinkBackoff() && testUplinkLimit();
+  Uplink_SetEnabled(UPLINK_ENABLED);
+  return ok;
+}
+
+}
+
+#if LOOP_STATS_ENABLED
+namespace LoopStatsTests {
+
+static void runPhase(PowerPhase phase, uint64_t us) {
+  POWER_SCOPE(phase);
+  Sim::advanceIn(Sim::CPU_ACTIVE, us);
+}
+
+// Итерации из фаз PowerStats на модельных тактах: ожидание HX711 и idle в
+// бюджет не входят, перерасход — у итерации с записью EEPROM, она же худшая
+static bool testLoopStats() {
+  Sim::resetRun(nullptr, UINT64_MAX);
+  PowerStats_Init();
+  LoopStats_Init();
+  LoopStats_Tick();                          // первая граница — итерация неполная
+  runPhase(PH_HX711_WAIT, 250000);
+  runPhase(PH_RENDER, 2000);
+  runPhase(PH_I2C_FLUSH, 23000);
+  runPhase(PH_IDLE_DELAY, 30000);
+  LoopStats_Tick();                          // 25 мс
+  runPhase(PH_HX711_WAIT, 300000);
+  runPhase(PH_EEPROM, 45000);
+  runPhase(PH_FILTER, 100);
+  LoopStats_Tick();                          // 45.1 мс
+  runPhase(PH_FILTER, 50);
+  LoopStats_Tick();                          // 50 мкс
+
+  LoopStream dev;
+  LoopStats_Dump(dev);
+  std::string out(dev.out.begin(), dev.out.end());
+  bool ok = LoopStats_Iterations() == 3 && LoopStats_Overruns() == 1 &&
+            LoopStats_MaxHx711WaitUs() == 300000 && LoopStats_Bucket(0) == 1 &&
+            LoopStats_Bucket(9) == 1 && LoopStats_Bucket(10) == 1 &&
+            out.find("[LOOP]    45100  eeprom      45000") != std::string::npos &&
+            out.find("[LOOP]    25000  i2c         23000") != std::string::npos;
+  if (!ok) printf("  loop stats:\n%s", out.c_str());
+  PowerStats_Init();
+  LoopStats_Init();
+  return ok;
+}
+
+bool RunAll() {
+  if (!Sim::shared) Sim::init();
+  return testLoopStats();
+}
+
+}
+#endif
+
+int main() {
+  bool ok = true;
+  if (!CoreLogicTests::RunAll()) { printf("FAIL: CoreLogicTests\n"); ok = false; }
+  if (!SimTests::RunAll())       { printf("FAIL: SimTests\n"); ok = false; }
+  if (!LogTests::RunAll())       { printf("FAIL: LogTests\n"); ok = false; }
+  if (!StoreTests::RunAll())     { printf("FAIL: StoreTests\n"); ok = false; }
+  if (!ConsoleTests::RunAll())   { printf("FAIL: ConsoleTests\n"); ok = false; }
+  if (!CalFitTests::RunAll())    { printf("FAIL: CalFitTests\n"); ok = false; }
+  if (!PipelineTests::RunAll())  { printf("FAIL: PipelineTests\n"); ok = false; }
+  if (!CalibrationTests::RunAll()) { printf("FAIL: CalibrationTests\n"); ok = false; }
+  if (!DisplayTests::RunAll())   { printf("FAIL: DisplayTests\n"); ok = false; }
+  if (!BatteryTests::RunAll())   { printf("FAIL: BatteryTests\n"); ok = false; }
+  if (!SettingsTests::RunAll())  { printf("FAIL: SettingsTests\n"); ok = false; }
+  if (!UplinkTests::RunAll())    { printf("FAIL: UplinkTests\n"); ok = false; }
+#if LOOP_STATS_ENABLED
+  if (!LoopStatsTests::RunAll()) { printf("FAIL: LoopStatsTests\n"); ok = false; }
+#endif
+  if (ok) printf("All host tests passed\n");
+  return ok ? 0 : 1;
+}